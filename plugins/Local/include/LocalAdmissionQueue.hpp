@@ -0,0 +1,120 @@
+/*
+ * LocalAdmissionQueue.hpp
+ *
+ * Copyright (C) 2020 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#ifndef LAUNCHER_PLUGINS_LOCAL_ADMISSION_QUEUE_HPP
+#define LAUNCHER_PLUGINS_LOCAL_ADMISSION_QUEUE_HPP
+
+#include <Noncopyable.hpp>
+
+#include <string>
+
+#include <PImpl.hpp>
+#include <api/Job.hpp>
+
+namespace rstudio {
+namespace launcher_plugins {
+
+class Error;
+
+} // namespace launcher_plugins
+} // namespace rstudio
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace local {
+
+/**
+ * @brief Decides when submitted jobs may start, based on the CPUs and memory they request.
+ *
+ * The resources requested by each started job are reserved until it exits. A job which does not fit in the remaining
+ * capacity waits in its user's queue. Whenever resources are released, the first waiting job of the user who currently
+ * has the fewest CPUs reserved is started next, so one user submitting many jobs can't starve the others. Jobs are not
+ * started out of order to fill gaps, so a large job can't be starved by a stream of smaller ones.
+ *
+ * A job which does not request a number of CPUs is counted as using one CPU. A job which does not request an amount
+ * of memory is not counted against the memory capacity.
+ */
+class LocalAdmissionQueue : public Noncopyable
+{
+public:
+   /**
+    * @brief Constructor.
+    *
+    * @param in_maxCpus         The number of CPUs which may be reserved at once, or 0 for no limit.
+    * @param in_maxMemoryMb     The amount of memory, in MB, which may be reserved at once, or 0 for no limit.
+    */
+   LocalAdmissionQueue(size_t in_maxCpus, size_t in_maxMemoryMb);
+
+   /**
+    * @brief Removes a job which is waiting for resources from the queue.
+    *
+    * Removing a job may allow the jobs queued behind it to start.
+    *
+    * @param in_jobId           The ID of the job to remove.
+    * @param out_admittedJobs   The waiting jobs which may now be started, in order.
+    *
+    * @return True if the job was waiting and has been removed; false if it was not waiting.
+    */
+   bool cancel(const std::string& in_jobId, api::JobList& out_admittedJobs);
+
+   /**
+    * @brief Releases the resources reserved by a job which has exited, and starts as many waiting jobs as now fit.
+    *
+    * @param in_jobId           The ID of the job which exited.
+    * @param out_admittedJobs   The waiting jobs which may now be started, in order.
+    */
+   void release(const std::string& in_jobId, api::JobList& out_admittedJobs);
+
+   /**
+    * @brief Reserves the resources of a job which is already running, such as one which was started before the Local
+    *        Plugin restarted.
+    *
+    * The resources are reserved even if they exceed the remaining capacity, since the job is running regardless. They
+    * must be released by a call to release when the job exits.
+    *
+    * @param in_job             The running job.
+    */
+   void reserve(const api::JobPtr& in_job);
+
+   /**
+    * @brief Submits a job, either reserving its resources right away or adding it to the queue.
+    *
+    * @param in_job             The job to submit. Its resource limits must not change while it is queued.
+    * @param out_isAdmitted     Whether the job may be started right away. If not, it will be returned from a later
+    *                           call to release.
+    *
+    * @return Success if the job's resource requests are valid and could ever be satisfied; Error otherwise.
+    */
+   Error submit(const api::JobPtr& in_job, bool& out_isAdmitted);
+
+private:
+   // The private implementation of LocalAdmissionQueue.
+   PRIVATE_IMPL(m_impl);
+};
+
+} // namespace local
+} // namespace launcher_plugins
+} // namespace rstudio
+
+#endif
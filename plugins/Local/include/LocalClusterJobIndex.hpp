@@ -0,0 +1,125 @@
+/*
+ * LocalClusterJobIndex.hpp
+ *
+ * Copyright (C) 2020 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#ifndef LAUNCHER_PLUGINS_LOCAL_CLUSTER_JOB_INDEX_HPP
+#define LAUNCHER_PLUGINS_LOCAL_CLUSTER_JOB_INDEX_HPP
+
+#include <Noncopyable.hpp>
+
+#include <string>
+#include <vector>
+
+#include <PImpl.hpp>
+#include <api/Job.hpp>
+
+namespace rstudio {
+namespace launcher_plugins {
+
+class Error;
+
+namespace system {
+
+class FilePath;
+
+} // namespace system
+} // namespace launcher_plugins
+} // namespace rstudio
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace local {
+
+/**
+ * @brief The changes to the jobs of another Local Plugin instance since the index was last refreshed.
+ */
+struct PeerJobChanges
+{
+   /** The hostname of the other Local Plugin instance. */
+   std::string Host;
+
+   /** Whether ChangedJobs includes every job of the host. Any other job of the host should be removed. */
+   bool IsComplete = false;
+
+   /** Copies of the jobs of the host which were added or changed. */
+   api::JobList ChangedJobs;
+
+   /** The IDs of the jobs of the host which were removed. */
+   std::vector<std::string> RemovedJobIds;
+};
+
+/**
+ * @brief Convenience typedef.
+ */
+typedef std::vector<PeerJobChanges> PeerJobChangesList;
+
+/**
+ * @brief Read-only view of the jobs of every other Local Plugin instance which shares the same scratch path.
+ *
+ * Each instance journals its own jobs to its own directory beneath the shared jobs directory, so there is never more
+ * than one writer per file. The index follows each of those journals, reading only what was appended since the last
+ * refresh, up to a fixed number of bytes per host, so the cost of a refresh is bounded no matter how busy the other
+ * instances are.
+ */
+class LocalClusterJobIndex : public Noncopyable
+{
+public:
+   /**
+    * @brief Constructor.
+    *
+    * @param in_jobsRootPath    The shared directory which contains the job journal directory of every host.
+    * @param in_hostname        The hostname of this Local Plugin instance, whose own journal should be ignored.
+    */
+   LocalClusterJobIndex(const system::FilePath& in_jobsRootPath, const std::string& in_hostname);
+
+   /**
+    * @brief Gets the IP addresses of another host, as resolved by the most recent refresh which looked the host up.
+    *
+    * @param in_host            The hostname of the other Local Plugin instance.
+    * @param out_addresses      The IP addresses of the host.
+    *
+    * @return Success if the addresses of the host have been resolved; Error otherwise.
+    */
+   Error getHostAddresses(const std::string& in_host, std::vector<std::string>& out_addresses) const;
+
+   /**
+    * @brief Reads the changes to the jobs of the other hosts since the last refresh, and resolves the IP addresses of
+    *        any host which hasn't been resolved recently.
+    *
+    * @param in_maxBytesPerHost     The maximum number of bytes of journal records to read for each host.
+    * @param out_changes            The changes to the jobs of each host which has changed.
+    *
+    * @return Success if the other hosts could be listed; Error otherwise.
+    */
+   Error refresh(size_t in_maxBytesPerHost, PeerJobChangesList& out_changes);
+
+private:
+   // The private implementation of LocalClusterJobIndex.
+   PRIVATE_IMPL(m_impl);
+};
+
+} // namespace local
+} // namespace launcher_plugins
+} // namespace rstudio
+
+#endif
@@ -58,6 +58,12 @@ enum class LocalError
 
    /** The operation is not supported. */
    UNSUPPORTED_OP       = 5,
+
+   /** The job journal could not be read or written. */
+   JOB_JOURNAL_ERROR    = 6,
+
+   /** The IP addresses of another host could not be resolved. */
+   HOST_LOOKUP_ERROR    = 7,
 };
 
 /**
@@ -0,0 +1,119 @@
+/*
+ * LocalExecWatcher.hpp
+ *
+ * Copyright (C) 2020 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#ifndef LAUNCHER_PLUGINS_LOCAL_EXEC_WATCHER_HPP
+#define LAUNCHER_PLUGINS_LOCAL_EXEC_WATCHER_HPP
+
+#include <Noncopyable.hpp>
+
+#include <functional>
+
+#include <sys/types.h>
+
+#include <PImpl.hpp>
+
+namespace rstudio {
+namespace launcher_plugins {
+
+class Error;
+
+} // namespace launcher_plugins
+} // namespace rstudio
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace local {
+
+/**
+ * @brief Callback function which will be invoked when a watched process may have executed a new program.
+ */
+typedef std::function<void(pid_t)> OnProcessExec;
+
+/**
+ * @brief Watches processes for calls to exec, using the kernel's process events connector.
+ *
+ * Subscribing to process events requires the CAP_NET_ADMIN capability, so the watcher must be started while root
+ * privileges can still be restored. If the watcher can't be started, or stops receiving events, it becomes inactive and
+ * callers should fall back to checking the processes they are interested in themselves.
+ */
+class LocalExecWatcher : public Noncopyable
+{
+public:
+   /**
+    * @brief Constructor.
+    *
+    * @param in_onExec      Callback function which will be invoked when a watched process calls exec. It will also be
+    *                       invoked for every watched process if events may have been missed, or if the watcher becomes
+    *                       inactive.
+    */
+   explicit LocalExecWatcher(OnProcessExec in_onExec);
+
+   /**
+    * @brief Destructor. Stops the watcher.
+    */
+   ~LocalExecWatcher();
+
+   /**
+    * @brief Checks whether the watcher is receiving process events.
+    *
+    * @return True if the watcher is receiving process events; false otherwise.
+    */
+   bool isActive() const;
+
+   /**
+    * @brief Subscribes to process events and begins watching for exec calls.
+    *
+    * @return Success if the watcher could subscribe to process events; Error otherwise.
+    */
+   Error start();
+
+   /**
+    * @brief Stops watching for exec calls.
+    */
+   void stop();
+
+   /**
+    * @brief Stops watching the specified process.
+    *
+    * @param in_pid     The ID of the process to stop watching.
+    */
+   void unwatch(pid_t in_pid);
+
+   /**
+    * @brief Begins watching the specified process.
+    *
+    * @param in_pid     The ID of the process to watch.
+    */
+   void watch(pid_t in_pid);
+
+private:
+   // The private implementation of LocalExecWatcher.
+   PRIVATE_IMPL_SHARED(m_impl);
+};
+
+} // namespace local
+} // namespace launcher_plugins
+} // namespace rstudio
+
+#endif
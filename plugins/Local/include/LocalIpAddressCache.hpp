@@ -0,0 +1,91 @@
+/*
+ * LocalIpAddressCache.hpp
+ *
+ * Copyright (C) 2020 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#ifndef LAUNCHER_PLUGINS_LOCAL_IP_ADDRESS_CACHE_HPP
+#define LAUNCHER_PLUGINS_LOCAL_IP_ADDRESS_CACHE_HPP
+
+#include <Noncopyable.hpp>
+
+#include <string>
+#include <vector>
+
+#include <PImpl.hpp>
+
+namespace rstudio {
+namespace launcher_plugins {
+
+class Error;
+
+} // namespace launcher_plugins
+} // namespace rstudio
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace local {
+
+/**
+ * @brief Keeps the externally reachable IP addresses of this machine in memory.
+ *
+ * The addresses are reloaded only after the kernel reports that an address was added or removed. If address change
+ * notifications can't be received, the addresses are reloaded when they are more than a few seconds old instead.
+ */
+class LocalIpAddressCache : public Noncopyable
+{
+public:
+   /**
+    * @brief Constructor.
+    */
+   LocalIpAddressCache();
+
+   /**
+    * @brief Destructor. Stops listening for address changes.
+    */
+   ~LocalIpAddressCache();
+
+   /**
+    * @brief Gets the IP addresses of this machine, excluding loop-back and link local addresses.
+    *
+    * @param out_addresses      The IP addresses of this machine.
+    *
+    * @return Success if the IP addresses could be retrieved; Error otherwise.
+    */
+   Error getIpAddresses(std::vector<std::string>& out_addresses) const;
+
+   /**
+    * @brief Loads the IP addresses of this machine and begins listening for address changes.
+    *
+    * @return Success if the IP addresses could be loaded; Error otherwise.
+    */
+   Error initialize();
+
+private:
+   // The private implementation of LocalIpAddressCache.
+   PRIVATE_IMPL_SHARED(m_impl);
+};
+
+} // namespace local
+} // namespace launcher_plugins
+} // namespace rstudio
+
+#endif
@@ -0,0 +1,205 @@
+/*
+ * LocalJobJournal.hpp
+ *
+ * Copyright (C) 2020 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef LAUNCHER_PLUGINS_LOCAL_JOB_JOURNAL_HPP
+#define LAUNCHER_PLUGINS_LOCAL_JOB_JOURNAL_HPP
+
+#include <Noncopyable.hpp>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <PImpl.hpp>
+#include <api/Job.hpp>
+
+namespace rstudio {
+namespace launcher_plugins {
+
+class Error;
+
+namespace system {
+
+class FilePath;
+
+} // namespace system
+} // namespace launcher_plugins
+} // namespace rstudio
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace local {
+
+/**
+ * @brief Function which returns the jobs that should be written to a snapshot during compaction.
+ */
+typedef std::function<api::JobList()> GetJobsToSnapshot;
+
+/**
+ * @brief Append-only, checksummed record of the jobs owned by a single Local Plugin instance.
+ *
+ * The journal consists of a snapshot file, which holds the full state of every job at the time of the last compaction,
+ * and a journal file to which job records, status transitions, and job removals are appended. Each line of either file
+ * is a CRC-32 checksum followed by a single JSON record, so torn or corrupted writes can be detected and skipped when
+ * the journal is replayed.
+ *
+ * Records are written behind by a dedicated thread so that callers never wait on the disk. Changes to a job which are
+ * queued while an earlier batch is being written are coalesced, so only the latest version of the job is written, and
+ * each batch is written and synced at once.
+ *
+ * Compaction rotates the journal file before the snapshot is taken, so records appended while the snapshot is being
+ * written are never lost. Each file starts with a generation header which allows a rotated journal that has already
+ * been folded into the snapshot to be ignored if the process exits before it could be removed.
+ */
+class LocalJobJournal : public Noncopyable
+{
+public:
+   /**
+    * @brief Constructor.
+    *
+    * @param in_journalDirectory    The directory in which the journal and snapshot files should be stored.
+    */
+   explicit LocalJobJournal(const system::FilePath& in_journalDirectory);
+
+   /**
+    * @brief Compacts the journal into a new snapshot.
+    *
+    * The journal is rotated before in_getJobs is invoked, so any job which is modified after the jobs are retrieved
+    * will be recorded in the new journal file. in_getJobs must not be invoked while holding any job locks.
+    *
+    * @param in_getJobs     Function which returns the jobs that should be written to the snapshot.
+    *
+    * @return Success if the journal could be compacted; Error otherwise.
+    */
+   Error compact(const GetJobsToSnapshot& in_getJobs);
+
+   /**
+    * @brief Writes all queued records to the journal.
+    *
+    * This method must not be invoked while holding any job locks.
+    *
+    * @return Success if all queued records could be written; Error otherwise.
+    */
+   Error flush();
+
+   /**
+    * @brief Loads all the jobs recorded in the snapshot and journal files, opens the journal for appending, and starts
+    *        the writer thread.
+    *
+    * This method should be called once, before any other method of this class.
+    *
+    * @param in_maxThreads  The maximum number of threads to use to parse large snapshot or journal files.
+    * @param out_jobs       The jobs which were recorded in the journal, in order of their IDs.
+    *
+    * @return Success if the journal could be loaded; Error otherwise.
+    */
+   Error load(size_t in_maxThreads, api::JobList& out_jobs);
+
+   /**
+    * @brief Checks whether enough records have been appended since the last compaction to warrant a new one.
+    *
+    * @return True if the journal should be compacted; false otherwise.
+    */
+   bool needsCompaction() const;
+
+   /**
+    * @brief Queues the full details of a job to be written to the journal.
+    *
+    * @param in_job     The job to record.
+    */
+   void recordJob(const api::JobPtr& in_job);
+
+   /**
+    * @brief Queues a job removal to be written to the journal.
+    *
+    * @param in_jobId   The ID of the job that was removed.
+    */
+   void recordRemoval(const std::string& in_jobId);
+
+   /**
+    * @brief Queues a status transition of a job to be written to the journal.
+    *
+    * Only the status, status message, last update time, and exit code of the job are recorded. The job must already
+    * have been recorded via recordJob.
+    *
+    * @param in_job     The job whose status changed.
+    */
+   void recordStatus(const api::JobPtr& in_job);
+
+   /**
+    * @brief Stops the writer thread, after writing all queued records to the journal.
+    *
+    * No records should be queued after this method is invoked.
+    */
+   void stop();
+
+private:
+   // The private implementation of LocalJobJournal.
+   PRIVATE_IMPL(m_impl);
+};
+
+/**
+ * @brief Follows the job journal of another Local Plugin instance, without modifying it.
+ *
+ * After the snapshot has been read once, only the records which were appended since the previous read are parsed. The
+ * snapshot is only read again if the journal was compacted before every record of the journal file being followed had
+ * been read.
+ */
+class LocalJobJournalReader : public Noncopyable
+{
+public:
+   /**
+    * @brief Constructor.
+    *
+    * @param in_journalDirectory    The directory which contains the journal and snapshot files to follow.
+    */
+   explicit LocalJobJournalReader(const system::FilePath& in_journalDirectory);
+
+   /**
+    * @brief Reads the records which have been written since the last read.
+    *
+    * @param in_maxBytes            The maximum number of bytes of journal records to read. Any remaining records will
+    *                               be read next time. The snapshot, if it must be read, is always read in full.
+    * @param out_changedJobs        Copies of the jobs which were added or changed.
+    * @param out_removedJobIds      The IDs of the jobs which were removed.
+    * @param out_isComplete         Whether out_changedJobs includes every job in the journal, in which case any job
+    *                               which was previously read but is not included has been removed.
+    *
+    * @return Success if the journal could be read; Error otherwise.
+    */
+   Error read(
+      size_t in_maxBytes,
+      api::JobList& out_changedJobs,
+      std::vector<std::string>& out_removedJobIds,
+      bool& out_isComplete);
+
+private:
+   // The private implementation of LocalJobJournalReader.
+   PRIVATE_IMPL(m_impl);
+};
+
+} // namespace local
+} // namespace launcher_plugins
+} // namespace rstudio
+
+#endif
@@ -26,7 +26,9 @@
 
 #include <jobs/AbstractJobRepository.hpp>
 
+#include <functional>
 #include <memory>
+#include <vector>
 
 #include <api/Job.hpp>
 #include <jobs/JobStatusNotifier.hpp>
@@ -37,6 +39,18 @@ namespace launcher_plugins {
 
 class Error;
 
+namespace system {
+
+class AsyncTimedEvent;
+
+} // namespace system
+
+namespace local {
+
+class LocalClusterJobIndex;
+class LocalJobJournal;
+
+} // namespace local
 } // namespace launcher_plugins
 } // namespace rstudio
 
@@ -50,6 +64,11 @@ namespace local {
 class LocalJobRepository : public jobs::AbstractJobRepository
 {
 public:
+   /**
+    * @brief Callback which is invoked for each job that is still running when the jobs are loaded from disk.
+    */
+   typedef std::function<void(const api::JobPtr&)> OnRunningJobLoaded;
+
    /**
     * @brief Constructor.
     *
@@ -59,7 +78,18 @@ public:
    LocalJobRepository(const std::string& in_hostname, jobs::JobStatusNotifierPtr in_notifier);
 
    /**
-    * @brief Saves a job to disk.
+    * @brief Gets the IP addresses of another Local Plugin instance which shares the scratch path. The addresses are
+    *        resolved when the jobs of the other instances are refreshed, so this never waits on a name lookup.
+    *
+    * @param in_host            The hostname of the other Local Plugin instance.
+    * @param out_addresses      The IP addresses of the host.
+    *
+    * @return Success if the addresses of the host have been resolved; Error otherwise.
+    */
+   Error getPeerHostAddresses(const std::string& in_host, std::vector<std::string>& out_addresses) const;
+
+   /**
+    * @brief Queues the full details of a job to be written to the job journal.
     *
     * @param in_job     The job to be saved.
     */
@@ -72,7 +102,26 @@ public:
     */
    Error setJobOutputPaths(api::JobPtr io_job) const;
 
+   /**
+    * @brief Sets the callback to invoke for each job that is still running when the jobs are loaded from disk. Must be
+    *        set before this repository is initialized.
+    *
+    * @param in_onRunningJobLoaded      The callback to invoke for each loaded running job.
+    */
+   void setOnRunningJobLoaded(OnRunningJobLoaded in_onRunningJobLoaded);
+
 private:
+   /**
+    * @brief Applies the changes which other Local Plugin instances sharing the same scratch path made to their jobs
+    *        since the last refresh.
+    */
+   void refreshClusterJobs();
+
+   /**
+    * @brief Compacts the job journal, if enough changes have been recorded since the last compaction.
+    */
+   void compactJournal();
+
    /**
     * @brief Loads all jobs from disk.
     *
@@ -96,6 +145,18 @@ private:
     */
    virtual void onJobRemoved(const api::JobPtr& in_job) override;
 
+   /**
+    * @brief Records job status transitions in the job journal.
+    *
+    * @param in_job     The job that was updated.
+    */
+   virtual void onJobUpdated(const api::JobPtr& in_job) override;
+
+   /**
+    * @brief Writes any queued changes to the job journal and stops the journal writer.
+    */
+   virtual void onShutdown() override;
+
    /**
     * @brief Initializes the local job repository.
     *
@@ -109,6 +170,12 @@ private:
    /** The scratch path configured by the system administrator. */
    const system::FilePath m_jobsRootPath;
 
+   /** The view of the jobs of the other Local Plugin instances which share the scratch path. */
+   std::shared_ptr<LocalClusterJobIndex> m_clusterIndex;
+
+   /** The timer which periodically refreshes the jobs of the other Local Plugin instances. */
+   std::shared_ptr<system::AsyncTimedEvent> m_clusterRefreshTimer;
+
    /** The scratch path configured by the system administrator. */
    const system::FilePath m_jobsPath;
 
@@ -117,6 +184,18 @@ private:
 
    /** The scratch path configured by the system administrator. */
    const system::FilePath m_outputRootPath;
+
+   /** The journal of the jobs owned by this Local Plugin instance. */
+   std::shared_ptr<LocalJobJournal> m_journal;
+
+   /** The timer which periodically compacts the job journal. */
+   std::shared_ptr<system::AsyncTimedEvent> m_compactionTimer;
+
+   /** The job status notifier, for notifying subscribers of status changes to the jobs of other hosts. */
+   jobs::JobStatusNotifierPtr m_notifier;
+
+   /** The callback to invoke for each job that is still running when the jobs are loaded from disk. */
+   OnRunningJobLoaded m_onRunningJobLoaded;
 };
 
 } // namespace local
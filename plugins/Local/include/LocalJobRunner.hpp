@@ -30,6 +30,8 @@
 #include <api/Response.hpp>
 #include <jobs/JobStatusNotifier.hpp>
 
+#include <LocalAdmissionQueue.hpp>
+#include <LocalExecWatcher.hpp>
 #include <LocalSecureCookie.hpp>
 
 namespace rstudio {
@@ -40,7 +42,13 @@ class Error;
 namespace system {
 
 class AsyncDeadlineEvent;
+class AsyncTimedEvent;
 
+namespace process {
+
+struct ProcessOptions;
+
+} // namespace process
 } // namespace system
 
 namespace local {
@@ -73,6 +81,17 @@ public:
       jobs::JobStatusNotifierPtr in_notifier,
       std::shared_ptr<LocalJobRepository> in_jobRepository);
 
+   /**
+    * @brief Cancels a job which is still waiting for resources.
+    *
+    * The job must be locked when this method is invoked.
+    *
+    * @param in_job     The job to cancel.
+    *
+    * @return True if the job was waiting for resources and has been canceled; false if the job has already started.
+    */
+   bool cancelJob(const api::JobPtr& in_job);
+
    /**
     * @brief Initializes the job runner.
     *
@@ -81,7 +100,7 @@ public:
    Error initialize();
 
    /**
-    * @brief Runs the specified job.
+    * @brief Runs the specified job, or queues it until enough CPUs and memory are free to run it.
     *
     * @param io_job                 The Job to be run.
     * @param out_wasInvalidJob      Whether the error that occurred was because the requested Job was invalid.
@@ -94,8 +113,41 @@ private:
    // Convenience typedefs.
    typedef std::weak_ptr<LocalJobRunner> WeakLocalJobRunner;
    typedef std::map<std::string, std::shared_ptr<system::AsyncDeadlineEvent> > ProcessWatchEvents;
+   typedef std::map<pid_t, api::JobPtr> ExecWatchJobs;
+   typedef std::map<std::string, api::JobPtr> LoadedJobs;
+   typedef std::map<std::string, std::shared_ptr<system::process::ProcessOptions> > QueuedProcessOptions;
+
+   // The file to which errors reported by rsandbox for a job are written.
+   struct JobErrorFile;
+   typedef std::shared_ptr<JobErrorFile> JobErrorFilePtr;
+
+   /**
+    * @brief Launches the process of a job.
+    *
+    * The job must be locked when this method is invoked.
+    *
+    * @param io_job         The job to launch.
+    * @param in_procOpts    The options of the job's process.
+    *
+    * @return Success if the process could be launched; Error otherwise.
+    */
+   Error launchJob(const api::JobPtr& io_job, const system::process::ProcessOptions& in_procOpts);
+
+   /**
+    * @brief Callback to be invoked when a queued Job may start.
+    *
+    * @param in_weakThis    A weak pointer to this LocalJobRunner.
+    * @param io_job         The Job to start.
+    */
+   static void onJobAdmitted(WeakLocalJobRunner in_weakThis, api::JobPtr io_job);
 
-   static void onJobErrorCallback(api::JobPtr in_job, const std::string& in_errorStr);
+   /**
+    * @brief Callback to be invoked when rsandbox writes to standard error for a Job.
+    *
+    * @param in_errorFile   The error file of the Job.
+    * @param in_errorStr    The error that was written.
+    */
+   static void onJobErrorCallback(const JobErrorFilePtr& in_errorFile, const std::string& in_errorStr);
 
    /**
     * @brief Callback to be invoked when a Job exits.
@@ -103,8 +155,21 @@ private:
     * @param in_weakThis    A weak pointer to this LocalJobRunner.
     * @param in_exitCode    The exit code of the Job.
     * @param io_job         The Job that has exited.
+    * @param in_errorFile   The error file of the Job, which will be closed.
+    */
+   static void onJobExitCallback(
+      WeakLocalJobRunner in_weakThis,
+      int in_exitCode,
+      api::JobPtr io_job,
+      const JobErrorFilePtr& in_errorFile);
+
+   /**
+    * @brief Callback to be invoked when the job repository loads a Job whose process is still running.
+    *
+    * @param in_weakThis    A weak pointer to this LocalJobRunner.
+    * @param in_job         The running Job.
     */
-   static void onJobExitCallback(WeakLocalJobRunner in_weakThis, int in_exitCode, api::JobPtr io_job);
+   static void onRunningJobLoaded(WeakLocalJobRunner in_weakThis, const api::JobPtr& in_job);
 
    /**
     * @brief Callback to be invoked after a set amount of time to check whether the Job is running yet.
@@ -115,6 +180,31 @@ private:
     */
    static void onProcessWatchDeadline(WeakLocalJobRunner in_weakThis, int in_count, api::JobPtr io_job);
 
+   /**
+    * @brief Callback to be invoked when the process of a pending Job may have called exec.
+    *
+    * @param in_weakThis    A weak pointer to this LocalJobRunner.
+    * @param in_pid         The ID of the process which called exec.
+    */
+   static void onProcessExec(WeakLocalJobRunner in_weakThis, pid_t in_pid);
+
+   /**
+    * @brief Checks whether a pending Job has started running, and updates its status if so.
+    *
+    * The Job must be locked when this method is invoked.
+    *
+    * @param io_job     The Job to check.
+    *
+    * @return True if the Job no longer needs to be watched; false otherwise.
+    */
+   bool checkProcessStarted(const api::JobPtr& io_job);
+
+   /**
+    * @brief Checks whether the processes of the running Jobs loaded at startup have exited, and updates their status
+    *        and releases their resources if so.
+    */
+   void checkLoadedJobs();
+
    /**
     * @brief Adds or updates a process watch event.
     *
@@ -125,6 +215,20 @@ private:
       const std::string& in_id,
       const std::shared_ptr<system::AsyncDeadlineEvent>& in_processWatchEvent);
 
+   /**
+    * @brief Stops watching the specified process for calls to exec.
+    *
+    * @param in_pid     The ID of the process to stop watching.
+    */
+   void removeExecWatch(pid_t in_pid);
+
+   /**
+    * @brief Releases the resources reserved by a job, and starts any queued jobs which now fit.
+    *
+    * @param in_id      The ID of the job which no longer needs its resources.
+    */
+   void releaseResources(const std::string& in_id);
+
    /**
     * @brief Removes a process watch event.
     *
@@ -132,13 +236,43 @@ private:
     */
    void removeWatchEvent(const std::string& in_id);
 
+   /**
+    * @brief Starts the specified jobs asynchronously, once their resources have been reserved.
+    *
+    * The jobs are started from the thread pool so that no job lock is held while another job is locked.
+    *
+    * @param in_jobs    The jobs to start.
+    */
+   void startAdmittedJobs(const api::JobList& in_jobs);
+
+   /** The queue of jobs waiting for enough CPUs and memory to run. */
+   LocalAdmissionQueue m_admissionQueue;
+
    /** The name of the host running this job. */
    const std::string& m_hostname;
 
    /** The job storage. */
    std::shared_ptr<LocalJobRepository> m_jobRepo;
 
-   /** The mutex to protect the process watch events. */
+   /** The pending jobs whose processes are being watched for calls to exec, by process ID. */
+   ExecWatchJobs m_execWatchJobs;
+
+   /** The watcher which reports when job processes call exec. */
+   std::unique_ptr<LocalExecWatcher> m_execWatcher;
+
+   /** The name of the program this process is running. */
+   std::string m_launcherProgram;
+
+   /** The running jobs loaded at startup whose processes haven't exited yet, by job ID. */
+   LoadedJobs m_loadedJobs;
+
+   /** The timer which periodically checks whether the processes of the running jobs loaded at startup have exited. */
+   std::shared_ptr<system::AsyncTimedEvent> m_loadedJobsTimer;
+
+   /**
+    * The mutex to protect the process and exec watch events, the process options of queued jobs, and the running jobs
+    * loaded at startup.
+    */
    std::mutex m_mutex;
 
    /** The job status notifier, to update the status of the job on exit. */
@@ -147,6 +281,9 @@ private:
    /** The watch events for each process that has not started running yet. */
    ProcessWatchEvents m_processWatchEvents;
 
+   /** The process options of each job which is waiting for resources, by job ID. */
+   QueuedProcessOptions m_queuedProcessOptions;
+
    /** The secure cookie. */
    LocalSecureCookie m_secureCookie;
 };
@@ -32,6 +32,7 @@
 #include <jobs/AbstractJobRepository.hpp>
 #include <jobs/JobStatusNotifier.hpp>
 
+#include "LocalIpAddressCache.hpp"
 #include "LocalJobRepository.hpp"
 #include "LocalSecureCookie.hpp"
 #include "LocalJobRunner.hpp"
@@ -215,6 +216,12 @@ private:
    /** The hostname of the machine running this instance of the Local Launcher Plugin. */
    const std::string m_hostname;
 
+   /** The IP addresses of the machine running this instance of the Local Launcher Plugin. */
+   LocalIpAddressCache m_ipAddresses;
+
+   /** The job repository, from which to get the IP addresses of the other Local Plugin instances. */
+   std::shared_ptr<LocalJobRepository> m_jobRepo;
+
    /** The job runner. */
    std::shared_ptr<LocalJobRunner> m_jobRunner;
 };
@@ -42,6 +42,20 @@ public:
     */
    static LocalOptions& getInstance();
 
+   /**
+    * @brief Gets the number of CPUs which may be requested by all running jobs combined.
+    *
+    * @return The CPU capacity of this host for jobs, or 0 if it is unlimited.
+    */
+   size_t getMaxCpus() const;
+
+   /**
+    * @brief Gets the amount of memory, in MB, which may be requested by all running jobs combined.
+    *
+    * @return The memory capacity of this host for jobs, in MB, or 0 if it is unlimited.
+    */
+   size_t getMaxMemoryMb() const;
+
    /**
     * @brief Gets the number of seconds that can elapse before an attempted connection to another local node will be
     *        timed out.
@@ -78,6 +92,16 @@ private:
     */
    LocalOptions() = default;
 
+   /**
+    * The number of CPUs which may be requested by all running jobs combined, or 0 for no limit.
+    */
+   size_t m_maxCpus;
+
+   /**
+    * The amount of memory, in MB, which may be requested by all running jobs combined, or 0 for no limit.
+    */
+   size_t m_maxMemoryMb;
+
    /**
     * The number of seconds that can elapse before an attempted connection to another local node will be timed out.
     */
@@ -0,0 +1,349 @@
+/*
+ * LocalAdmissionQueue.cpp
+ *
+ * Copyright (C) 2020 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include <LocalAdmissionQueue.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <mutex>
+
+#include <Error.hpp>
+#include <logging/Logger.hpp>
+#include <utils/MutexUtils.hpp>
+
+#include <LocalError.hpp>
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace local {
+
+namespace {
+
+// Tolerance for rounding errors when adding up fractional resource requests.
+constexpr double EPSILON = 1e-9;
+
+/**
+ * @brief The resources requested by a job.
+ */
+struct ResourceRequest
+{
+   /** The number of CPUs requested by the job. */
+   double Cpus = 1;
+
+   /** The amount of memory requested by the job, in MB. */
+   double MemoryMb = 0;
+};
+
+/**
+ * @brief A job which is waiting for resources.
+ */
+struct QueuedJob
+{
+   /** The job. */
+   api::JobPtr Job;
+
+   /** The resources requested by the job. */
+   ResourceRequest Request;
+
+   /** The order in which the job was submitted, relative to other jobs. */
+   uint64_t Sequence;
+};
+
+/**
+ * @brief The resources reserved by a started job.
+ */
+struct Reservation
+{
+   /** The name of the user who owns the job. */
+   std::string Username;
+
+   /** The resources reserved for the job. */
+   ResourceRequest Request;
+};
+
+Error parseResourceValue(const api::ResourceLimit& in_limit, double& out_value)
+{
+   char* end = nullptr;
+   out_value = std::strtod(in_limit.Value.c_str(), &end);
+   if ((end == in_limit.Value.c_str()) || (*end != '\0') || !std::isfinite(out_value) || (out_value < 0))
+      return createError(
+         LocalError::INVALID_JOB_CONFIG,
+         "Invalid value \"" + in_limit.Value + "\" for resource limit " + in_limit.ResourceType,
+         ERROR_LOCATION);
+
+   return Success();
+}
+
+Error getResourceRequest(const api::Job& in_job, ResourceRequest& out_request)
+{
+   for (const api::ResourceLimit& limit: in_job.ResourceLimits)
+   {
+      if (limit.Value.empty())
+         continue;
+
+      Error error;
+      if (limit.ResourceType == api::ResourceLimit::Type::CPU_COUNT)
+         error = parseResourceValue(limit, out_request.Cpus);
+      else if (limit.ResourceType == api::ResourceLimit::Type::MEMORY)
+         error = parseResourceValue(limit, out_request.MemoryMb);
+
+      if (error)
+         return error;
+   }
+
+   return Success();
+}
+
+} // anonymous namespace
+
+struct LocalAdmissionQueue::Impl
+{
+   Impl(size_t in_maxCpus, size_t in_maxMemoryMb) :
+      MaxCpus(static_cast<double>(in_maxCpus)),
+      MaxMemoryMb(static_cast<double>(in_maxMemoryMb)),
+      NextSequence(0),
+      UsedCpus(0),
+      UsedMemoryMb(0)
+   {
+   }
+
+   /**
+    * @brief Starts waiting jobs, in fair-share order, until the next one doesn't fit.
+    *
+    * The mutex must be locked when this method is invoked.
+    *
+    * @param io_admittedJobs    The jobs which may now be started.
+    */
+   void admitWaiting(api::JobList& io_admittedJobs)
+   {
+      while (!UserQueues.empty())
+      {
+         // The next job is the oldest waiting job of the user with the fewest CPUs reserved.
+         auto next = UserQueues.end();
+         double nextUserCpus = 0;
+         for (auto itr = UserQueues.begin(); itr != UserQueues.end(); ++itr)
+         {
+            auto cpuItr = UserCpus.find(itr->first);
+            double userCpus = (cpuItr == UserCpus.end()) ? 0 : cpuItr->second;
+            if ((next == UserQueues.end()) ||
+               (userCpus < nextUserCpus) ||
+               ((userCpus == nextUserCpus) && (itr->second.front().Sequence < next->second.front().Sequence)))
+            {
+               next = itr;
+               nextUserCpus = userCpus;
+            }
+         }
+
+         const QueuedJob& queuedJob = next->second.front();
+         if (!fits(queuedJob.Request))
+            return;
+
+         reserve(next->first, queuedJob.Job->Id, queuedJob.Request);
+         io_admittedJobs.push_back(queuedJob.Job);
+
+         next->second.pop_front();
+         if (next->second.empty())
+            UserQueues.erase(next);
+      }
+   }
+
+   /**
+    * @brief Checks whether the requested resources are currently available.
+    *
+    * @param in_request     The requested resources.
+    *
+    * @return True if the requested resources are available; false otherwise.
+    */
+   bool fits(const ResourceRequest& in_request) const
+   {
+      return ((MaxCpus == 0) || (UsedCpus + in_request.Cpus <= MaxCpus + EPSILON)) &&
+         ((MaxMemoryMb == 0) || (UsedMemoryMb + in_request.MemoryMb <= MaxMemoryMb + EPSILON));
+   }
+
+   /**
+    * @brief Reserves resources for a job.
+    *
+    * @param in_username    The name of the user who owns the job.
+    * @param in_jobId       The ID of the job.
+    * @param in_request     The resources to reserve.
+    */
+   void reserve(const std::string& in_username, const std::string& in_jobId, const ResourceRequest& in_request)
+   {
+      Reservations[in_jobId] = Reservation{ in_username, in_request };
+      UserCpus[in_username] += in_request.Cpus;
+      UsedCpus += in_request.Cpus;
+      UsedMemoryMb += in_request.MemoryMb;
+   }
+
+   /** The number of CPUs which may be reserved at once, or 0 for no limit. */
+   const double MaxCpus;
+
+   /** The amount of memory, in MB, which may be reserved at once, or 0 for no limit. */
+   const double MaxMemoryMb;
+
+   /** The mutex which protects the queues and reservations. */
+   std::mutex Mutex;
+
+   /** The sequence number to give the next submitted job. */
+   uint64_t NextSequence;
+
+   /** The resources reserved by each started job, by job ID. */
+   std::map<std::string, Reservation> Reservations;
+
+   /** The number of CPUs currently reserved. */
+   double UsedCpus;
+
+   /** The amount of memory currently reserved, in MB. */
+   double UsedMemoryMb;
+
+   /** The number of CPUs currently reserved by each user with started jobs. */
+   std::map<std::string, double> UserCpus;
+
+   /** The jobs waiting for resources, by the name of the user who owns them, in the order they were submitted. */
+   std::map<std::string, std::deque<QueuedJob> > UserQueues;
+};
+
+PRIVATE_IMPL_DELETER_IMPL(LocalAdmissionQueue)
+
+LocalAdmissionQueue::LocalAdmissionQueue(size_t in_maxCpus, size_t in_maxMemoryMb) :
+   m_impl(new Impl(in_maxCpus, in_maxMemoryMb))
+{
+}
+
+bool LocalAdmissionQueue::cancel(const std::string& in_jobId, api::JobList& out_admittedJobs)
+{
+   LOCK_MUTEX(m_impl->Mutex)
+   {
+      for (auto itr = m_impl->UserQueues.begin(); itr != m_impl->UserQueues.end(); ++itr)
+      {
+         std::deque<QueuedJob>& queue = itr->second;
+         for (auto jobItr = queue.begin(); jobItr != queue.end(); ++jobItr)
+         {
+            if (jobItr->Job->Id != in_jobId)
+               continue;
+
+            queue.erase(jobItr);
+            if (queue.empty())
+               m_impl->UserQueues.erase(itr);
+
+            m_impl->admitWaiting(out_admittedJobs);
+            return true;
+         }
+      }
+   }
+   END_LOCK_MUTEX
+
+   return false;
+}
+
+void LocalAdmissionQueue::release(const std::string& in_jobId, api::JobList& out_admittedJobs)
+{
+   LOCK_MUTEX(m_impl->Mutex)
+   {
+      auto itr = m_impl->Reservations.find(in_jobId);
+      if (itr == m_impl->Reservations.end())
+         return;
+
+      const Reservation& reservation = itr->second;
+      m_impl->UsedCpus = std::max(0.0, m_impl->UsedCpus - reservation.Request.Cpus);
+      m_impl->UsedMemoryMb = std::max(0.0, m_impl->UsedMemoryMb - reservation.Request.MemoryMb);
+
+      // A user's entry may already be gone if their other jobs requested no CPUs.
+      auto cpuItr = m_impl->UserCpus.find(reservation.Username);
+      if (cpuItr != m_impl->UserCpus.end())
+      {
+         cpuItr->second -= reservation.Request.Cpus;
+         if (cpuItr->second < EPSILON)
+            m_impl->UserCpus.erase(cpuItr);
+      }
+
+      m_impl->Reservations.erase(itr);
+      m_impl->admitWaiting(out_admittedJobs);
+   }
+   END_LOCK_MUTEX
+}
+
+void LocalAdmissionQueue::reserve(const api::JobPtr& in_job)
+{
+   // The job is running regardless, so count it with the default request rather than not at all.
+   ResourceRequest request;
+   Error error = getResourceRequest(*in_job, request);
+   if (error)
+   {
+      logging::logError(error, ERROR_LOCATION);
+      request = ResourceRequest();
+   }
+
+   LOCK_MUTEX(m_impl->Mutex)
+   {
+      m_impl->reserve(in_job->User.getUsername(), in_job->Id, request);
+   }
+   END_LOCK_MUTEX
+}
+
+Error LocalAdmissionQueue::submit(const api::JobPtr& in_job, bool& out_isAdmitted)
+{
+   out_isAdmitted = false;
+
+   ResourceRequest request;
+   Error error = getResourceRequest(*in_job, request);
+   if (error)
+      return error;
+
+   // A job which could never fit would wait forever.
+   if ((m_impl->MaxCpus != 0) && (request.Cpus > m_impl->MaxCpus + EPSILON))
+      return createError(
+         LocalError::INVALID_JOB_CONFIG,
+         "Requested " + std::to_string(request.Cpus) + " CPUs, but at most " +
+            std::to_string(static_cast<size_t>(m_impl->MaxCpus)) + " may be requested.",
+         ERROR_LOCATION);
+
+   if ((m_impl->MaxMemoryMb != 0) && (request.MemoryMb > m_impl->MaxMemoryMb + EPSILON))
+      return createError(
+         LocalError::INVALID_JOB_CONFIG,
+         "Requested " + std::to_string(request.MemoryMb) + " MB of memory, but at most " +
+            std::to_string(static_cast<size_t>(m_impl->MaxMemoryMb)) + " MB may be requested.",
+         ERROR_LOCATION);
+
+   LOCK_MUTEX(m_impl->Mutex)
+   {
+      const std::string& username = in_job->User.getUsername();
+      m_impl->UserQueues[username].push_back(QueuedJob{ in_job, request, m_impl->NextSequence++ });
+
+      // Other waiting jobs can't have become startable by adding this one, so at most this job is admitted.
+      api::JobList admittedJobs;
+      m_impl->admitWaiting(admittedJobs);
+      out_isAdmitted = !admittedJobs.empty();
+   }
+   END_LOCK_MUTEX
+
+   return Success();
+}
+
+} // namespace local
+} // namespace launcher_plugins
+} // namespace rstudio
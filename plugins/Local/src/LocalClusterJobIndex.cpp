@@ -0,0 +1,253 @@
+/*
+ * LocalClusterJobIndex.cpp
+ *
+ * Copyright (C) 2020 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include <LocalClusterJobIndex.hpp>
+
+#include <arpa/inet.h>
+#include <netdb.h>
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include <Error.hpp>
+#include <logging/Logger.hpp>
+#include <system/DateTime.hpp>
+#include <system/FilePath.hpp>
+#include <utils/MutexUtils.hpp>
+
+#include <LocalError.hpp>
+#include <LocalJobJournal.hpp>
+
+using namespace rstudio::launcher_plugins::system;
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace local {
+
+typedef std::shared_ptr<LocalJobJournalReader> LocalJobJournalReaderPtr;
+
+namespace {
+
+// How long the resolved addresses of another host may be used before the host is looked up again.
+constexpr int64_t HOST_ADDRESS_TTL_SECONDS = 60;
+
+/**
+ * @brief The result of looking up the IP addresses of another host.
+ */
+struct HostAddresses
+{
+   /** The IP addresses of the host. */
+   std::vector<std::string> Addresses;
+
+   /** The error which occurred while looking up the host, if any. */
+   Error LookupError;
+
+   /** The time at which the host was looked up. */
+   DateTime LookupTime;
+};
+
+/**
+ * @brief Resolves the IP addresses of another host.
+ *
+ * @param in_hostname       The name of the host.
+ * @param out_addresses     The IP addresses of the host.
+ *
+ * @return Success if the name of the host could be resolved; Error otherwise.
+ */
+Error resolveHostAddresses(const std::string& in_hostname, std::vector<std::string>& out_addresses)
+{
+   struct addrinfo hints;
+   std::memset(&hints, 0, sizeof(hints));
+   hints.ai_family = AF_UNSPEC;
+   hints.ai_socktype = SOCK_STREAM;
+
+   struct addrinfo* results = nullptr;
+   int result = ::getaddrinfo(in_hostname.c_str(), nullptr, &hints, &results);
+   if (result != 0)
+      return createError(
+         LocalError::HOST_LOOKUP_ERROR,
+         "Could not resolve host " + in_hostname + ": " + ::gai_strerror(result),
+         ERROR_LOCATION);
+
+   for (struct addrinfo* itr = results; itr != nullptr; itr = itr->ai_next)
+   {
+      char buffer[INET6_ADDRSTRLEN];
+      const void* address = (itr->ai_family == AF_INET) ?
+         static_cast<const void*>(&reinterpret_cast<struct sockaddr_in*>(itr->ai_addr)->sin_addr) :
+         static_cast<const void*>(&reinterpret_cast<struct sockaddr_in6*>(itr->ai_addr)->sin6_addr);
+      if (::inet_ntop(itr->ai_family, address, buffer, sizeof(buffer)) != nullptr)
+         out_addresses.emplace_back(buffer);
+   }
+
+   ::freeaddrinfo(results);
+   return Success();
+}
+
+} // anonymous namespace
+
+struct LocalClusterJobIndex::Impl
+{
+   Impl(const FilePath& in_jobsRootPath, const std::string& in_hostname) :
+      Hostname(in_hostname),
+      JobsRootPath(in_jobsRootPath)
+   {
+   }
+
+   /**
+    * @brief Looks up the IP addresses of each host whose addresses are missing or out of date.
+    *
+    * Only refresh modifies the addresses, so they may be read here without locking the mutex.
+    *
+    * @param in_hosts       The journal reader of each other host, by hostname.
+    */
+   void resolveHosts(const std::map<std::string, LocalJobJournalReaderPtr>& in_hosts)
+   {
+      const DateTime now;
+      std::map<std::string, HostAddresses> addresses;
+      for (const auto& host: in_hosts)
+      {
+         auto itr = Addresses.find(host.first);
+         if ((itr != Addresses.end()) &&
+            (now < (itr->second.LookupTime + TimeDuration::Seconds(HOST_ADDRESS_TTL_SECONDS))))
+         {
+            addresses[host.first] = itr->second;
+            continue;
+         }
+
+         HostAddresses& hostAddresses = addresses[host.first];
+         hostAddresses.LookupTime = now;
+         hostAddresses.LookupError = resolveHostAddresses(host.first, hostAddresses.Addresses);
+      }
+
+      LOCK_MUTEX(Mutex)
+      {
+         Addresses = std::move(addresses);
+      }
+      END_LOCK_MUTEX
+   }
+
+   /** The IP addresses of each other host, by hostname. */
+   std::map<std::string, HostAddresses> Addresses;
+
+   /** The hostname of this Local Plugin instance. */
+   const std::string Hostname;
+
+   /** The directory which contains the job journal directory of every host. */
+   const FilePath JobsRootPath;
+
+   /** The mutex which protects the addresses of the other hosts. */
+   mutable std::mutex Mutex;
+
+   /** The journal reader of each other host, by hostname. */
+   std::map<std::string, LocalJobJournalReaderPtr> Readers;
+};
+
+PRIVATE_IMPL_DELETER_IMPL(LocalClusterJobIndex)
+
+LocalClusterJobIndex::LocalClusterJobIndex(const FilePath& in_jobsRootPath, const std::string& in_hostname) :
+   m_impl(new Impl(in_jobsRootPath, in_hostname))
+{
+}
+
+Error LocalClusterJobIndex::getHostAddresses(
+   const std::string& in_host,
+   std::vector<std::string>& out_addresses) const
+{
+   LOCK_MUTEX(m_impl->Mutex)
+   {
+      auto itr = m_impl->Addresses.find(in_host);
+      if (itr == m_impl->Addresses.end())
+         return createError(
+            LocalError::HOST_LOOKUP_ERROR,
+            "Host " + in_host + " has not been resolved yet.",
+            ERROR_LOCATION);
+
+      if (itr->second.LookupError)
+         return itr->second.LookupError;
+
+      out_addresses = itr->second.Addresses;
+   }
+   END_LOCK_MUTEX
+
+   return Success();
+}
+
+Error LocalClusterJobIndex::refresh(size_t in_maxBytesPerHost, PeerJobChangesList& out_changes)
+{
+   std::vector<FilePath> children;
+   Error error = m_impl->JobsRootPath.getChildren(children);
+   if (error)
+      return error;
+
+   std::map<std::string, LocalJobJournalReaderPtr> readers;
+   for (const FilePath& child: children)
+   {
+      const std::string host = child.getFilename();
+      if ((host == m_impl->Hostname) || !child.isDirectory())
+         continue;
+
+      auto itr = m_impl->Readers.find(host);
+      LocalJobJournalReaderPtr reader = (itr == m_impl->Readers.end()) ?
+         std::make_shared<LocalJobJournalReader>(child) :
+         itr->second;
+      readers[host] = reader;
+
+      PeerJobChanges changes;
+      changes.Host = host;
+      error = reader->read(in_maxBytesPerHost, changes.ChangedJobs, changes.RemovedJobIds, changes.IsComplete);
+      if (error)
+      {
+         // One unreadable host shouldn't hide the jobs of the others.
+         logging::logError(error, ERROR_LOCATION);
+         continue;
+      }
+
+      if (changes.IsComplete || !changes.ChangedJobs.empty() || !changes.RemovedJobIds.empty())
+         out_changes.push_back(std::move(changes));
+   }
+
+   // The directory of a host which no longer exists was removed by an administrator, so none of its jobs remain.
+   for (const auto& reader: m_impl->Readers)
+   {
+      if (readers.find(reader.first) == readers.end())
+      {
+         PeerJobChanges changes;
+         changes.Host = reader.first;
+         changes.IsComplete = true;
+         out_changes.push_back(std::move(changes));
+      }
+   }
+
+   // Look hosts up here, rather than when their addresses are requested, so that requests never wait on a lookup.
+   m_impl->resolveHosts(readers);
+
+   m_impl->Readers = std::move(readers);
+   return Success();
+}
+
+} // namespace local
+} // namespace launcher_plugins
+} // namespace rstudio
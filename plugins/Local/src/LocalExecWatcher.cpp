@@ -0,0 +1,339 @@
+/*
+ * LocalExecWatcher.cpp
+ *
+ * Copyright (C) 2020 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <LocalExecWatcher.hpp>
+
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include <Error.hpp>
+#include <logging/Logger.hpp>
+#include <options/Options.hpp>
+#include <system/Asio.hpp>
+#include <system/PosixSystem.hpp>
+#include <system/User.hpp>
+#include <utils/MutexUtils.hpp>
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace local {
+
+namespace {
+
+// Depending on the version of the kernel headers, the event type enum is either nested in proc_event or not.
+typedef decltype(proc_event::what) ProcessEventType;
+
+/**
+ * @brief Opens a netlink socket which is subscribed to the kernel's process events.
+ *
+ * @param out_socket     The subscribed socket.
+ *
+ * @return Success if the socket could be opened and subscribed; Error otherwise.
+ */
+Error openProcessEventSocket(int& out_socket)
+{
+   int sock = ::socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+   if (sock < 0)
+      return systemError(errno, ERROR_LOCATION);
+
+   struct sockaddr_nl address;
+   std::memset(&address, 0, sizeof(address));
+   address.nl_family = AF_NETLINK;
+   address.nl_groups = CN_IDX_PROC;
+   address.nl_pid = 0;
+
+   if (::bind(sock, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) < 0)
+   {
+      Error error = systemError(errno, ERROR_LOCATION);
+      ::close(sock);
+      return error;
+   }
+
+   // The request is a netlink header, followed by a connector message, followed by the operation.
+   struct nlmsghdr header;
+   std::memset(&header, 0, sizeof(header));
+   header.nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(enum proc_cn_mcast_op));
+   header.nlmsg_type = NLMSG_DONE;
+
+   struct cn_msg message;
+   std::memset(&message, 0, sizeof(message));
+   message.id.idx = CN_IDX_PROC;
+   message.id.val = CN_VAL_PROC;
+   message.len = sizeof(enum proc_cn_mcast_op);
+
+   enum proc_cn_mcast_op operation = PROC_CN_MCAST_LISTEN;
+
+   std::vector<char> request(header.nlmsg_len, 0);
+   std::memcpy(request.data(), &header, sizeof(header));
+   std::memcpy(request.data() + NLMSG_HDRLEN, &message, sizeof(message));
+   std::memcpy(request.data() + NLMSG_HDRLEN + sizeof(message), &operation, sizeof(operation));
+
+   if (::send(sock, request.data(), request.size(), 0) < 0)
+   {
+      Error error = systemError(errno, ERROR_LOCATION);
+      ::close(sock);
+      return error;
+   }
+
+   out_socket = sock;
+   return Success();
+}
+
+} // anonymous namespace
+
+struct LocalExecWatcher::Impl : public std::enable_shared_from_this<LocalExecWatcher::Impl>
+{
+   typedef std::shared_ptr<LocalExecWatcher::Impl> SharedThis;
+   typedef std::weak_ptr<LocalExecWatcher::Impl> WeakThis;
+
+   /**
+    * @brief Constructor.
+    *
+    * @param in_onExec      Callback function which will be invoked when a watched process calls exec.
+    */
+   explicit Impl(OnProcessExec in_onExec) :
+      IsActive(false),
+      OnExec(std::move(in_onExec))
+   {
+   }
+
+   /**
+    * @brief Invokes the exec callback for every watched process.
+    */
+   void notifyAll()
+   {
+      std::vector<pid_t> pids;
+      LOCK_MUTEX(Mutex)
+      {
+         pids.assign(Watched.begin(), Watched.end());
+      }
+      END_LOCK_MUTEX
+
+      for (pid_t pid: pids)
+         OnExec(pid);
+   }
+
+   /**
+    * @brief Handles process event messages read from the netlink socket.
+    *
+    * @param in_data        The data that was read.
+    * @param in_length      The number of bytes that were read.
+    */
+   void onRead(const char* in_data, size_t in_length)
+   {
+      // The read buffer isn't guaranteed to be aligned, so copy each structure out of it before using it.
+      size_t offset = 0;
+      while ((offset + sizeof(struct nlmsghdr)) <= in_length)
+      {
+         struct nlmsghdr header;
+         std::memcpy(&header, in_data + offset, sizeof(header));
+         if ((header.nlmsg_len < sizeof(header)) || ((offset + header.nlmsg_len) > in_length))
+            break;
+
+         if (header.nlmsg_len >= NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(struct proc_event)))
+         {
+            struct proc_event event;
+            std::memcpy(&event, in_data + offset + NLMSG_HDRLEN + sizeof(struct cn_msg), sizeof(event));
+            if (event.what == ProcessEventType::PROC_EVENT_EXEC)
+               onExec(event.event_data.exec.process_tgid);
+         }
+
+         offset += NLMSG_ALIGN(header.nlmsg_len);
+      }
+   }
+
+   /**
+    * @brief Invokes the exec callback if the specified process is being watched.
+    *
+    * @param in_pid     The ID of the process which called exec.
+    */
+   void onExec(pid_t in_pid)
+   {
+      bool isWatched = false;
+      LOCK_MUTEX(Mutex)
+      {
+         isWatched = Watched.find(in_pid) != Watched.end();
+      }
+      END_LOCK_MUTEX
+
+      if (isWatched)
+         OnExec(in_pid);
+   }
+
+   /**
+    * @brief Handles errors reading from the netlink socket.
+    *
+    * @param in_error   The error that occurred.
+    */
+   void onReadError(const Error& in_error)
+   {
+      // If the socket buffer overflowed, some events were lost but the socket is still usable. Let the owner re-check
+      // every watched process and keep reading.
+      if (in_error.getCode() == ENOBUFS)
+      {
+         logging::logDebugMessage("Process events were dropped by the kernel; re-checking all watched processes.");
+         notifyAll();
+         startReading();
+         return;
+      }
+
+      logging::logError(in_error, ERROR_LOCATION);
+      logging::logWarningMessage("Stopped receiving process events; falling back to polling for job state changes.");
+      IsActive = false;
+      notifyAll();
+   }
+
+   /**
+    * @brief Begins reading process events from the netlink socket.
+    */
+   void startReading()
+   {
+      WeakThis weakThis = shared_from_this();
+      Stream->readBytes(
+         [weakThis](const char* in_data, size_t in_length)
+         {
+            if (SharedThis sharedThis = weakThis.lock())
+               sharedThis->onRead(in_data, in_length);
+         },
+         [weakThis](const Error& in_error)
+         {
+            if (SharedThis sharedThis = weakThis.lock())
+               sharedThis->onReadError(in_error);
+         });
+   }
+
+   /** Whether process events are currently being received. */
+   std::atomic_bool IsActive;
+
+   /** The mutex which protects the set of watched processes. */
+   std::mutex Mutex;
+
+   /** The callback to invoke when a watched process calls exec. */
+   OnProcessExec OnExec;
+
+   /** The stream from which process events are read. */
+   std::unique_ptr<system::AsioStream> Stream;
+
+   /** The IDs of the watched processes. */
+   std::set<pid_t> Watched;
+};
+
+LocalExecWatcher::LocalExecWatcher(OnProcessExec in_onExec) :
+   m_impl(new Impl(std::move(in_onExec)))
+{
+}
+
+LocalExecWatcher::~LocalExecWatcher()
+{
+   stop();
+}
+
+bool LocalExecWatcher::isActive() const
+{
+   return m_impl->IsActive;
+}
+
+Error LocalExecWatcher::start()
+{
+   // ------------------------------------------------------------------------------------------------------------------
+   // MAINTENANCE NOTE:
+   // Subscribing to process events requires CAP_NET_ADMIN, so root privileges must be restored briefly. Only the
+   // subscription itself happens with elevated privileges; events are received as the server user afterwards.
+   // ------------------------------------------------------------------------------------------------------------------
+   const options::Options& options = options::Options::getInstance();
+   if (options.useUnprivilegedMode())
+      return systemError(EPERM, "Process events are not available in unprivileged mode.", ERROR_LOCATION);
+
+   if (!system::posix::realUserIsRoot())
+      return systemError(EPERM, "Process events are only available to the root user.", ERROR_LOCATION);
+
+   Error error = system::posix::restoreRoot();
+   if (error)
+      return error;
+
+   int sock = -1;
+   Error openError = openProcessEventSocket(sock);
+
+   // Always go back to the server user, even if the socket couldn't be opened.
+   system::User serverUser;
+   error = options.getServerUser(serverUser);
+   if (!error)
+   {
+      Optional<system::GidType> groupUser;
+      error = system::posix::temporarilyDropPrivileges(serverUser, groupUser);
+   }
+
+   if (error)
+   {
+      if (sock >= 0)
+         ::close(sock);
+      return error;
+   }
+
+   if (openError)
+      return openError;
+
+   m_impl->Stream.reset(new system::AsioStream(sock));
+   m_impl->IsActive = true;
+   m_impl->startReading();
+
+   return Success();
+}
+
+void LocalExecWatcher::stop()
+{
+   m_impl->IsActive = false;
+   if (m_impl->Stream)
+      m_impl->Stream->close();
+}
+
+void LocalExecWatcher::unwatch(pid_t in_pid)
+{
+   LOCK_MUTEX(m_impl->Mutex)
+   {
+      m_impl->Watched.erase(in_pid);
+   }
+   END_LOCK_MUTEX
+}
+
+void LocalExecWatcher::watch(pid_t in_pid)
+{
+   LOCK_MUTEX(m_impl->Mutex)
+   {
+      m_impl->Watched.insert(in_pid);
+   }
+   END_LOCK_MUTEX
+}
+
+} // namespace local
+} // namespace launcher_plugins
+} // namespace rstudio
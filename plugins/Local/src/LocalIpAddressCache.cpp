@@ -0,0 +1,253 @@
+/*
+ * LocalIpAddressCache.cpp
+ *
+ * Copyright (C) 2020 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <LocalIpAddressCache.hpp>
+
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+#include <Error.hpp>
+#include <logging/Logger.hpp>
+#include <system/Asio.hpp>
+#include <system/DateTime.hpp>
+#include <system/PosixSystem.hpp>
+#include <utils/MutexUtils.hpp>
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace local {
+
+namespace {
+
+// How long loaded addresses may be used when address change notifications aren't available.
+constexpr int64_t FALLBACK_TTL_SECONDS = 5;
+
+/**
+ * @brief Opens a netlink socket which is subscribed to IPv4 and IPv6 address changes.
+ *
+ * @param out_socket     The subscribed socket.
+ *
+ * @return Success if the socket could be opened and subscribed; Error otherwise.
+ */
+Error openAddressChangeSocket(int& out_socket)
+{
+   int sock = ::socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+   if (sock < 0)
+      return systemError(errno, ERROR_LOCATION);
+
+   struct sockaddr_nl address;
+   std::memset(&address, 0, sizeof(address));
+   address.nl_family = AF_NETLINK;
+   address.nl_groups = RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
+
+   if (::bind(sock, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) < 0)
+   {
+      Error error = systemError(errno, ERROR_LOCATION);
+      ::close(sock);
+      return error;
+   }
+
+   out_socket = sock;
+   return Success();
+}
+
+} // anonymous namespace
+
+struct LocalIpAddressCache::Impl : public std::enable_shared_from_this<LocalIpAddressCache::Impl>
+{
+   typedef std::shared_ptr<LocalIpAddressCache::Impl> SharedThis;
+   typedef std::weak_ptr<LocalIpAddressCache::Impl> WeakThis;
+
+   /**
+    * @brief Constructor.
+    */
+   Impl() :
+      IsListening(false),
+      IsStale(true)
+   {
+   }
+
+   /**
+    * @brief Reloads the IP addresses of this machine.
+    *
+    * The mutex must be held when this method is invoked.
+    *
+    * @return Success if the IP addresses could be loaded; Error otherwise.
+    */
+   Error load()
+   {
+      // Clear the stale flag first, so a change reported while the addresses are loaded causes another reload.
+      IsStale = false;
+
+      using system::posix::IpAddress;
+      std::vector<IpAddress> addresses;
+      Error error = system::posix::getIpAddresses(addresses, true);
+      if (error)
+      {
+         IsStale = true;
+         return error;
+      }
+
+      Addresses.clear();
+      for (const IpAddress& addr: addresses)
+      {
+         // Keep all addresses except the loop-back and link local addresses.
+         if ((addr.Address.find("127") != 0) &&
+            (addr.Address.find("::1") != 0) &&
+            (addr.Address.find('%') == std::string::npos))
+            Addresses.push_back(addr.Address);
+      }
+
+      LoadTime = system::DateTime();
+      return Success();
+   }
+
+   /**
+    * @brief Handles errors reading from the netlink socket.
+    *
+    * @param in_error   The error that occurred.
+    */
+   void onReadError(const Error& in_error)
+   {
+      // Either way, notifications may have been missed.
+      IsStale = true;
+
+      // If the socket buffer overflowed, the socket is still usable.
+      if (in_error.getCode() == ENOBUFS)
+      {
+         startReading();
+         return;
+      }
+
+      logging::logError(in_error, ERROR_LOCATION);
+      logging::logWarningMessage(
+         "Stopped receiving network address changes; network information will be reloaded periodically.");
+      IsListening = false;
+   }
+
+   /**
+    * @brief Begins reading address change notifications from the netlink socket.
+    */
+   void startReading()
+   {
+      // Every message on this socket is an address being added or removed, so there's no need to parse them.
+      WeakThis weakThis = shared_from_this();
+      Stream->readBytes(
+         [weakThis](const char*, size_t)
+         {
+            if (SharedThis sharedThis = weakThis.lock())
+               sharedThis->IsStale = true;
+         },
+         [weakThis](const Error& in_error)
+         {
+            if (SharedThis sharedThis = weakThis.lock())
+               sharedThis->onReadError(in_error);
+         });
+   }
+
+   /** The externally reachable IP addresses of this machine. */
+   std::vector<std::string> Addresses;
+
+   /** Whether address change notifications are being received. */
+   std::atomic_bool IsListening;
+
+   /** Whether the addresses may have changed since they were loaded. */
+   std::atomic_bool IsStale;
+
+   /** The time at which the addresses were last loaded. */
+   system::DateTime LoadTime;
+
+   /** The mutex which protects the addresses. */
+   std::mutex Mutex;
+
+   /** The stream from which address change notifications are read. */
+   std::unique_ptr<system::AsioStream> Stream;
+};
+
+LocalIpAddressCache::LocalIpAddressCache() :
+   m_impl(new Impl())
+{
+}
+
+LocalIpAddressCache::~LocalIpAddressCache()
+{
+   if (m_impl->Stream)
+      m_impl->Stream->close();
+}
+
+Error LocalIpAddressCache::getIpAddresses(std::vector<std::string>& out_addresses) const
+{
+   LOCK_MUTEX(m_impl->Mutex)
+   {
+      bool isExpired = !m_impl->IsListening &&
+         ((m_impl->LoadTime + system::TimeDuration::Seconds(FALLBACK_TTL_SECONDS)) <= system::DateTime());
+      if (m_impl->IsStale || isExpired)
+      {
+         Error error = m_impl->load();
+         if (error)
+            return error;
+      }
+
+      out_addresses = m_impl->Addresses;
+   }
+   END_LOCK_MUTEX
+
+   return Success();
+}
+
+Error LocalIpAddressCache::initialize()
+{
+   // Subscribe before loading, so no change can be missed in between.
+   int sock = -1;
+   Error error = openAddressChangeSocket(sock);
+   if (error)
+   {
+      logging::logErrorAsInfo(error);
+      logging::logInfoMessage(
+         "Network address changes are unavailable. Network information will be reloaded periodically.");
+   }
+   else
+   {
+      m_impl->Stream.reset(new system::AsioStream(sock));
+      m_impl->IsListening = true;
+      m_impl->startReading();
+   }
+
+   LOCK_MUTEX(m_impl->Mutex)
+   {
+      return m_impl->load();
+   }
+   END_LOCK_MUTEX
+
+   return Success();
+}
+
+} // namespace local
+} // namespace launcher_plugins
+} // namespace rstudio
@@ -0,0 +1,1150 @@
+/*
+ * LocalJobJournal.cpp
+ *
+ * Copyright (C) 2020 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <LocalJobJournal.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <boost/crc.hpp>
+
+#include <Error.hpp>
+#include <json/Json.hpp>
+#include <system/DateTime.hpp>
+#include <system/FilePath.hpp>
+#include <utils/FileUtils.hpp>
+#include <utils/MutexUtils.hpp>
+
+#include <LocalError.hpp>
+
+using namespace rstudio::launcher_plugins::system;
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace local {
+
+namespace {
+
+constexpr const char* JOURNAL_FILE_PREFIX = "jobs.journal.";
+constexpr const char* SNAPSHOT_FILE = "jobs.snapshot";
+
+constexpr const char* RECORD_TYPE = "type";
+constexpr const char* RECORD_TYPE_HEADER = "header";
+constexpr const char* RECORD_TYPE_JOB = "job";
+constexpr const char* RECORD_TYPE_REMOVE = "remove";
+constexpr const char* RECORD_TYPE_STATUS = "status";
+
+constexpr const char* FIELD_EXIT_CODE = "exitCode";
+constexpr const char* FIELD_GENERATION = "generation";
+constexpr const char* FIELD_ID = "id";
+constexpr const char* FIELD_JOB = "job";
+constexpr const char* FIELD_LAST_UPDATE_TIME = "lastUpdateTime";
+constexpr const char* FIELD_STATUS = "status";
+constexpr const char* FIELD_STATUS_MESSAGE = "statusMessage";
+
+// Each record is prefixed with an 8 character hex checksum and a space.
+constexpr size_t CHECKSUM_LENGTH = 8;
+
+// The journal won't be compacted until at least this many records have been appended to it.
+constexpr size_t MIN_COMPACTION_RECORDS = 1000;
+
+// Files are only parsed on multiple threads if each thread would have at least this many records to parse.
+constexpr size_t MIN_RECORDS_PER_LOAD_THREAD = 512;
+
+typedef std::map<std::string, api::JobPtr> JobMap;
+
+/**
+ * @brief A change to a job which has been queued but not yet written to the journal.
+ */
+struct PendingRecord
+{
+   /**
+    * @brief The kind of record to write. Later kinds supersede earlier ones, except that a status change never
+    *        supersedes a full job record or a removal.
+    */
+   enum class Kind
+   {
+      STATUS,
+      JOB,
+      REMOVAL
+   };
+
+   /** The kind of record to write. */
+   Kind RecordKind;
+
+   /** The job to which the record applies. Not set for removals. */
+   api::JobPtr Job;
+};
+
+typedef std::map<std::string, PendingRecord> PendingRecordMap;
+
+/**
+ * @brief A record which has been read from a journal or snapshot file, but not yet applied.
+ */
+struct ParsedRecord
+{
+   /** The error which occurred while parsing the record, if any. */
+   Error ParseError;
+
+   /** The record. */
+   json::Object Record;
+
+   /** The type of the record. */
+   std::string Type;
+
+   /** The job described by the record, for job records. Parsing jobs is expensive, so it's done ahead of time. */
+   api::JobPtr Job;
+};
+
+uint32_t computeChecksum(const char* in_data, size_t in_length)
+{
+   boost::crc_32_type crc;
+   crc.process_bytes(in_data, in_length);
+   return crc.checksum();
+}
+
+std::string frameRecord(const json::Object& in_record)
+{
+   const std::string payload = in_record.write();
+
+   char checksum[CHECKSUM_LENGTH + 1];
+   std::snprintf(checksum, sizeof(checksum), "%08x", computeChecksum(payload.data(), payload.size()));
+
+   std::string line;
+   line.reserve(CHECKSUM_LENGTH + payload.size() + 2);
+   line.append(checksum).append(" ").append(payload).append("\n");
+   return line;
+}
+
+Error unframeRecord(const char* in_line, size_t in_length, json::Object& out_record)
+{
+   if ((in_length <= CHECKSUM_LENGTH + 1) || (in_line[CHECKSUM_LENGTH] != ' '))
+      return createError(LocalError::JOB_JOURNAL_ERROR, "Journal record is malformed.", ERROR_LOCATION);
+
+   char* end = nullptr;
+   const std::string checksumStr(in_line, CHECKSUM_LENGTH);
+   unsigned long expected = std::strtoul(checksumStr.c_str(), &end, 16);
+   if (end != checksumStr.c_str() + CHECKSUM_LENGTH)
+      return createError(LocalError::JOB_JOURNAL_ERROR, "Journal record is malformed.", ERROR_LOCATION);
+
+   const char* payload = in_line + CHECKSUM_LENGTH + 1;
+   const size_t payloadLength = in_length - CHECKSUM_LENGTH - 1;
+   if (computeChecksum(payload, payloadLength) != expected)
+      return createError(
+         LocalError::JOB_JOURNAL_ERROR,
+         "Journal record checksum does not match.",
+         ERROR_LOCATION);
+
+   // The caller guarantees that the payload is null-terminated.
+   return out_record.parse(payload);
+}
+
+json::Object makeHeaderRecord(uint64_t in_generation)
+{
+   json::Object record;
+   record[RECORD_TYPE] = RECORD_TYPE_HEADER;
+   record[FIELD_GENERATION] = in_generation;
+   return record;
+}
+
+json::Object makeJobRecord(const api::Job& in_job)
+{
+   json::Object record;
+   record[RECORD_TYPE] = RECORD_TYPE_JOB;
+   record[FIELD_JOB] = in_job.toJson();
+   return record;
+}
+
+json::Object makeRemovalRecord(const std::string& in_jobId)
+{
+   json::Object record;
+   record[RECORD_TYPE] = RECORD_TYPE_REMOVE;
+   record[FIELD_ID] = in_jobId;
+   return record;
+}
+
+json::Object makeStatusRecord(const api::Job& in_job)
+{
+   json::Object record;
+   record[RECORD_TYPE] = RECORD_TYPE_STATUS;
+   record[FIELD_ID] = in_job.Id;
+   record[FIELD_STATUS] = api::Job::stateToString(in_job.Status);
+   record[FIELD_STATUS_MESSAGE] = in_job.StatusMessage;
+   if (in_job.LastUpdateTime)
+      record[FIELD_LAST_UPDATE_TIME] = in_job.LastUpdateTime.getValueOr(DateTime()).toString();
+   if (in_job.ExitCode)
+      record[FIELD_EXIT_CODE] = in_job.ExitCode.getValueOr(0);
+
+   return record;
+}
+
+Error openJournalFile(const FilePath& in_file, int& out_fd)
+{
+   out_fd = ::open(in_file.getAbsolutePath().c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR);
+   if (out_fd < 0)
+   {
+      Error error = systemError(errno, ERROR_LOCATION);
+      error.addProperty("path", in_file);
+      return error;
+   }
+
+   return Success();
+}
+
+bool parseJournalGeneration(const FilePath& in_file, uint64_t& out_generation)
+{
+   const std::string filename = in_file.getFilename();
+   const std::string prefix = JOURNAL_FILE_PREFIX;
+   if ((filename.size() <= prefix.size()) || (filename.compare(0, prefix.size(), prefix) != 0))
+      return false;
+
+   char* end = nullptr;
+   const char* genStr = filename.c_str() + prefix.size();
+   out_generation = std::strtoull(genStr, &end, 10);
+   return (end != genStr) && (*end == '\0');
+}
+
+Error applyStatusRecord(const json::Object& in_record, JobMap& io_jobs)
+{
+   std::string id, status;
+   Optional<std::string> statusMessage, lastUpdateTime;
+   Optional<int> exitCode;
+   Error error = json::readObject(
+      in_record,
+      FIELD_ID, id,
+      FIELD_STATUS, status,
+      FIELD_STATUS_MESSAGE, statusMessage,
+      FIELD_LAST_UPDATE_TIME, lastUpdateTime,
+      FIELD_EXIT_CODE, exitCode);
+   if (error)
+      return error;
+
+   // The job may have been removed before its status changed.
+   auto itr = io_jobs.find(id);
+   if (itr == io_jobs.end())
+      return Success();
+
+   api::Job::State state;
+   error = api::Job::stateFromString(status, state);
+   if (error)
+      return error;
+
+   api::JobPtr& job = itr->second;
+   job->Status = state;
+   job->StatusMessage = statusMessage.getValueOr("");
+   if (exitCode)
+      job->ExitCode = exitCode;
+
+   if (lastUpdateTime)
+   {
+      DateTime updateTime;
+      error = DateTime::fromString(lastUpdateTime.getValueOr(""), updateTime);
+      if (error)
+         return error;
+
+      job->LastUpdateTime = updateTime;
+   }
+
+   return Success();
+}
+
+Error parseRecord(const char* in_line, size_t in_length, ParsedRecord& out_record)
+{
+   Error error = unframeRecord(in_line, in_length, out_record.Record);
+   if (error)
+      return error;
+
+   error = json::readObject(out_record.Record, RECORD_TYPE, out_record.Type);
+   if (error)
+      return error;
+
+   if (out_record.Type == RECORD_TYPE_JOB)
+   {
+      json::Object jobObj;
+      error = json::readObject(out_record.Record, FIELD_JOB, jobObj);
+      if (error)
+         return error;
+
+      out_record.Job.reset(new api::Job());
+      error = api::Job::fromJson(jobObj, *out_record.Job);
+   }
+
+   return error;
+}
+
+Error applyRecord(const ParsedRecord& in_record, JobMap& io_jobs, Optional<uint64_t>& io_generation)
+{
+   const std::string& type = in_record.Type;
+   if (type == RECORD_TYPE_JOB)
+      io_jobs[in_record.Job->Id] = in_record.Job;
+   else if (type == RECORD_TYPE_STATUS)
+      return applyStatusRecord(in_record.Record, io_jobs);
+   else if (type == RECORD_TYPE_REMOVE)
+   {
+      std::string id;
+      Error error = json::readObject(in_record.Record, FIELD_ID, id);
+      if (error)
+         return error;
+
+      io_jobs.erase(id);
+   }
+   else if (type == RECORD_TYPE_HEADER)
+   {
+      uint64_t generation = 0;
+      Error error = json::readObject(in_record.Record, FIELD_GENERATION, generation);
+      if (error)
+         return error;
+
+      io_generation = generation;
+   }
+   else
+      return createError(
+         LocalError::JOB_JOURNAL_ERROR,
+         "Unknown journal record type \"" + type + "\".",
+         ERROR_LOCATION);
+
+   return Success();
+}
+
+Error replayFile(
+   const FilePath& in_file,
+   size_t in_maxThreads,
+   JobMap& io_jobs,
+   Optional<uint64_t>& out_generation,
+   size_t& out_records,
+   size_t& out_completeSize)
+{
+   out_records = 0;
+   out_completeSize = 0;
+
+   std::string contents;
+   Error error = utils::readFileIntoString(in_file, contents);
+   if (error)
+      return error;
+
+   // Find the records. Each new line is replaced with a null terminator so the records can be parsed in place.
+   std::vector<std::pair<size_t, size_t> > lines;
+   size_t start = 0;
+   while (start < contents.size())
+   {
+      size_t end = contents.find('\n', start);
+      if (end == std::string::npos)
+      {
+         // A record without a trailing new line was not completely written, likely because the process was stopped
+         // mid-write. Everything before it is still valid.
+         logging::logWarningMessage(
+            "Ignoring incomplete record at the end of job journal file " + in_file.getAbsolutePath());
+         break;
+      }
+
+      contents[end] = '\0';
+      lines.emplace_back(start, end - start);
+      start = end + 1;
+   }
+
+   out_completeSize = start;
+
+   // Parsing is by far the most expensive part of loading, and records can be parsed independently, so spread large
+   // files across several threads. The records must still be applied in order.
+   std::vector<ParsedRecord> records(lines.size());
+   auto parseRange = [&contents, &lines, &records](size_t in_begin, size_t in_end)
+   {
+      for (size_t i = in_begin; i < in_end; ++i)
+         records[i].ParseError = parseRecord(&contents[lines[i].first], lines[i].second, records[i]);
+   };
+
+   const size_t threadCount = std::max<size_t>(
+      1,
+      std::min(in_maxThreads, lines.size() / MIN_RECORDS_PER_LOAD_THREAD));
+   const size_t chunkSize = (lines.size() + threadCount - 1) / threadCount;
+
+   std::vector<std::thread> threads;
+   for (size_t i = 1; i < threadCount; ++i)
+      threads.emplace_back(parseRange, i * chunkSize, std::min(lines.size(), (i + 1) * chunkSize));
+
+   parseRange(0, std::min(lines.size(), chunkSize));
+   for (std::thread& thread: threads)
+      thread.join();
+
+   for (size_t i = 0; i < records.size(); ++i)
+   {
+      // A bad record only affects the job it describes, so log it and keep going.
+      error = records[i].ParseError;
+      if (!error)
+         error = applyRecord(records[i], io_jobs, out_generation);
+
+      if (error)
+      {
+         error.addProperty("path", in_file);
+         error.addProperty("line", static_cast<int>(i + 1));
+         logging::logErrorAsWarning(error);
+      }
+      else
+         ++out_records;
+   }
+
+   return Success();
+}
+
+} // anonymous namespace
+
+struct LocalJobJournal::Impl
+{
+   explicit Impl(const FilePath& in_journalDirectory) :
+      Directory(in_journalDirectory),
+      Fd(-1),
+      Generation(0),
+      OldestGeneration(0),
+      RecordCount(0),
+      SnapshotJobCount(0),
+      IsStopping(false)
+   {
+   }
+
+   ~Impl()
+   {
+      stopWriter();
+
+      if (Fd >= 0)
+         ::close(Fd);
+   }
+
+   FilePath getJournalFile(uint64_t in_generation) const
+   {
+      return Directory.completeChildPath(JOURNAL_FILE_PREFIX + std::to_string(in_generation));
+   }
+
+   /**
+    * @brief Writes every queued record to the journal with a single write, and syncs it.
+    *
+    * Job locks will be taken to serialize the queued jobs, so this must not be invoked while holding a job lock.
+    *
+    * @return Success if all of the queued records could be written; Error otherwise.
+    */
+   Error drain()
+   {
+      // Only one thread drains at a time so that batches are written in the order they were taken from the queue.
+      UNIQUE_LOCK_MUTEX(DrainMutex)
+      {
+         PendingRecordMap pending;
+         LOCK_MUTEX(QueueMutex)
+         {
+            pending.swap(Pending);
+         }
+         END_LOCK_MUTEX
+
+         if (pending.empty())
+            return Success();
+
+         // Serialize the latest version of each job now, so a job which changed many times while it was queued is
+         // only written once.
+         std::string batch;
+         for (const auto& entry: pending)
+         {
+            const PendingRecord& record = entry.second;
+            if (record.RecordKind == PendingRecord::Kind::REMOVAL)
+            {
+               batch.append(frameRecord(makeRemovalRecord(entry.first)));
+               continue;
+            }
+
+            LOCK_JOB(record.Job)
+            {
+               if (record.RecordKind == PendingRecord::Kind::JOB)
+                  batch.append(frameRecord(makeJobRecord(*record.Job)));
+               else
+                  batch.append(frameRecord(makeStatusRecord(*record.Job)));
+            }
+            END_LOCK_JOB
+         }
+
+         Error error;
+         LOCK_MUTEX(Mutex)
+         {
+            if (Fd < 0)
+               error = createError(
+                  LocalError::JOB_JOURNAL_ERROR,
+                  "The job journal is not open for writing.",
+                  ERROR_LOCATION);
+            else
+               error = utils::writeAll(Fd, batch);
+
+            // Only the data needs to be synced since the journal size is the only metadata that changes.
+            if (!error && (::fdatasync(Fd) != 0))
+               error = systemError(errno, ERROR_LOCATION);
+
+            if (!error)
+               RecordCount += pending.size();
+         }
+         END_LOCK_MUTEX
+
+         if (error)
+         {
+            // Put the records back so they can be retried. Anything queued since this batch was taken is newer.
+            LOCK_MUTEX(QueueMutex)
+            {
+               for (auto& entry: pending)
+               {
+                  auto itr = Pending.find(entry.first);
+                  if (itr == Pending.end())
+                     Pending.insert(entry);
+                  else if (itr->second.RecordKind == PendingRecord::Kind::STATUS)
+                     itr->second = entry.second;
+               }
+            }
+            END_LOCK_MUTEX
+
+            return error;
+         }
+      }
+      END_LOCK_MUTEX
+
+      return Success();
+   }
+
+   /**
+    * @brief Queues a record to be written to the journal by the writer thread.
+    *
+    * @param in_jobId       The ID of the job to which the record applies.
+    * @param in_kind        The kind of record to write.
+    * @param in_job         The job to which the record applies, if any.
+    */
+   void enqueue(const std::string& in_jobId, PendingRecord::Kind in_kind, const api::JobPtr& in_job)
+   {
+      LOCK_MUTEX(QueueMutex)
+      {
+         auto itr = Pending.find(in_jobId);
+         if (itr == Pending.end())
+            Pending[in_jobId] = PendingRecord{ in_kind, in_job };
+         else if (in_kind != PendingRecord::Kind::STATUS)
+            itr->second = PendingRecord{ in_kind, in_job };
+
+         QueueCondition.notify_one();
+      }
+      END_LOCK_MUTEX
+   }
+
+   /**
+    * @brief Writes queued records to the journal until the writer is stopped.
+    */
+   void runWriter()
+   {
+      bool stopping = false;
+      while (!stopping)
+      {
+         UNIQUE_LOCK_MUTEX(QueueMutex)
+         {
+            QueueCondition.wait(uniqueLock, [this]() { return IsStopping || !Pending.empty(); });
+            stopping = IsStopping;
+         }
+         END_LOCK_MUTEX
+
+         // Records which are queued while this batch is being written will be picked up by the next batch, so writes
+         // are naturally batched when the disk is slow.
+         Error error = drain();
+         if (error)
+         {
+            logging::logError(error, ERROR_LOCATION);
+
+            // Give the problem a chance to clear up before retrying.
+            UNIQUE_LOCK_MUTEX(QueueMutex)
+            {
+               QueueCondition.wait_for(uniqueLock, std::chrono::seconds(1), [this]() { return IsStopping; });
+            }
+            END_LOCK_MUTEX
+         }
+      }
+   }
+
+   /**
+    * @brief Starts the writer thread.
+    */
+   void startWriter()
+   {
+      Writer = std::thread(&Impl::runWriter, this);
+   }
+
+   /**
+    * @brief Stops the writer thread, after it has written any records which were already queued.
+    */
+   void stopWriter()
+   {
+      LOCK_MUTEX(QueueMutex)
+      {
+         IsStopping = true;
+         QueueCondition.notify_one();
+      }
+      END_LOCK_MUTEX
+
+      if (Writer.joinable())
+         Writer.join();
+   }
+
+   /** The directory which contains the snapshot and journal files. */
+   const FilePath Directory;
+
+   /** The file descriptor of the active journal file. */
+   int Fd;
+
+   /** The generation of the active journal file. */
+   uint64_t Generation;
+
+   /** The generation of the oldest journal file that may still exist on disk. */
+   uint64_t OldestGeneration;
+
+   /** The number of records that have been appended since the last compaction. */
+   size_t RecordCount;
+
+   /** The number of jobs that were written to the last snapshot. */
+   size_t SnapshotJobCount;
+
+   /** Mutex which protects the active journal file. */
+   std::mutex Mutex;
+
+   /** Mutex which prevents multiple compactions from running at the same time. */
+   std::mutex CompactionMutex;
+
+   /** The records which have been queued but not yet written, by job ID. */
+   PendingRecordMap Pending;
+
+   /** Whether the writer thread should exit. */
+   bool IsStopping;
+
+   /** Mutex which protects the queued records and the stopping flag. */
+   std::mutex QueueMutex;
+
+   /** Condition variable which signals the writer thread that records were queued or that it should exit. */
+   std::condition_variable QueueCondition;
+
+   /** Mutex which ensures only one batch of records is written at a time. */
+   std::mutex DrainMutex;
+
+   /** The thread which writes queued records to the journal. */
+   std::thread Writer;
+};
+
+PRIVATE_IMPL_DELETER_IMPL(LocalJobJournal)
+
+LocalJobJournal::LocalJobJournal(const FilePath& in_journalDirectory) :
+   m_impl(new Impl(in_journalDirectory))
+{
+}
+
+Error LocalJobJournal::compact(const GetJobsToSnapshot& in_getJobs)
+{
+   UNIQUE_LOCK_MUTEX(m_impl->CompactionMutex)
+   {
+      // Start a new journal file first. Anything recorded from this point on will be written to the new file, so the
+      // snapshot only needs to include the changes which were made before now.
+      uint64_t newGeneration = 0;
+      LOCK_MUTEX(m_impl->Mutex)
+      {
+         newGeneration = m_impl->Generation + 1;
+
+         int fd = -1;
+         Error error = openJournalFile(m_impl->getJournalFile(newGeneration), fd);
+         if (error)
+            return error;
+
+         error = utils::syncDirectory(m_impl->Directory);
+         if (error)
+            logging::logError(error, ERROR_LOCATION);
+
+         if (m_impl->Fd >= 0)
+            ::close(m_impl->Fd);
+
+         m_impl->Fd = fd;
+         m_impl->Generation = newGeneration;
+         m_impl->RecordCount = 0;
+      }
+      END_LOCK_MUTEX
+
+      api::JobList jobs = in_getJobs();
+
+      std::string snapshot = frameRecord(makeHeaderRecord(newGeneration));
+      for (const api::JobPtr& job: jobs)
+      {
+         LOCK_JOB(job)
+         {
+            snapshot.append(frameRecord(makeJobRecord(*job)));
+         }
+         END_LOCK_JOB
+      }
+
+      Error error = utils::writeStringToFileAtomically(
+         snapshot,
+         m_impl->Directory.completeChildPath(SNAPSHOT_FILE),
+         utils::FileSyncMode::FILE_AND_DIRECTORY);
+      if (error)
+         return error;
+
+      // Every older journal file has now been folded into the snapshot.
+      for (uint64_t gen = m_impl->OldestGeneration; gen < newGeneration; ++gen)
+      {
+         error = m_impl->getJournalFile(gen).removeIfExists();
+         if (error)
+            logging::logError(error, ERROR_LOCATION);
+      }
+
+      m_impl->OldestGeneration = newGeneration;
+      m_impl->SnapshotJobCount = jobs.size();
+
+      logging::logDebugMessage(
+         "Compacted job journal into a snapshot of " + std::to_string(jobs.size()) + " jobs.");
+   }
+   END_LOCK_MUTEX
+
+   return Success();
+}
+
+Error LocalJobJournal::flush()
+{
+   return m_impl->drain();
+}
+
+Error LocalJobJournal::load(size_t in_maxThreads, api::JobList& out_jobs)
+{
+   JobMap jobs;
+
+   // Replay the snapshot first. It covers every journal file older than its own generation.
+   uint64_t snapshotGeneration = 0;
+   FilePath snapshotFile = m_impl->Directory.completeChildPath(SNAPSHOT_FILE);
+   if (snapshotFile.exists())
+   {
+      Optional<uint64_t> generation;
+      size_t records = 0, completeSize = 0;
+      Error error = replayFile(snapshotFile, in_maxThreads, jobs, generation, records, completeSize);
+      if (error)
+         return error;
+
+      snapshotGeneration = generation.getValueOr(0);
+      m_impl->SnapshotJobCount = jobs.size();
+   }
+
+   // Then replay any newer journal files, oldest first.
+   std::vector<FilePath> children;
+   Error error = m_impl->Directory.getChildren(children);
+   if (error)
+      return error;
+
+   const std::string snapshotTempPrefix = std::string(SNAPSHOT_FILE) + ".tmp.";
+   std::map<uint64_t, FilePath> journalFiles;
+   for (const FilePath& child: children)
+   {
+      uint64_t generation = 0;
+      if (parseJournalGeneration(child, generation))
+      {
+         if (generation < snapshotGeneration)
+         {
+            // Compaction finished but the process stopped before the old journal was removed.
+            error = child.removeIfExists();
+            if (error)
+               logging::logError(error, ERROR_LOCATION);
+         }
+         else
+            journalFiles[generation] = child;
+      }
+      else if (child.getFilename().compare(0, snapshotTempPrefix.size(), snapshotTempPrefix) == 0)
+      {
+         // A snapshot which was never renamed into place because the process stopped mid-compaction.
+         error = child.removeIfExists();
+         if (error)
+            logging::logError(error, ERROR_LOCATION);
+      }
+   }
+
+   m_impl->RecordCount = 0;
+   m_impl->OldestGeneration = snapshotGeneration;
+   m_impl->Generation = snapshotGeneration;
+   size_t completeSize = 0;
+   for (const auto& journalFile: journalFiles)
+   {
+      Optional<uint64_t> unused;
+      size_t records = 0;
+      error = replayFile(journalFile.second, in_maxThreads, jobs, unused, records, completeSize);
+      if (error)
+         return error;
+
+      m_impl->RecordCount += records;
+      m_impl->Generation = journalFile.first;
+   }
+
+   // Drop any incomplete record from the end of the journal that will be appended to, so it can't corrupt the next
+   // record.
+   FilePath journalFile = m_impl->getJournalFile(m_impl->Generation);
+   if (!journalFiles.empty() && (journalFile.getSize() > completeSize))
+   {
+      if (::truncate(journalFile.getAbsolutePath().c_str(), static_cast<off_t>(completeSize)) != 0)
+         return systemError(errno, ERROR_LOCATION);
+   }
+
+   if (!journalFiles.empty())
+      m_impl->OldestGeneration = journalFiles.begin()->first;
+
+   error = openJournalFile(journalFile, m_impl->Fd);
+   if (error)
+      return error;
+
+   m_impl->startWriter();
+
+   for (const auto& job: jobs)
+      out_jobs.push_back(job.second);
+
+   return Success();
+}
+
+bool LocalJobJournal::needsCompaction() const
+{
+   bool needsCompaction = false;
+   LOCK_MUTEX(m_impl->Mutex)
+   {
+      needsCompaction = m_impl->RecordCount > std::max(MIN_COMPACTION_RECORDS, m_impl->SnapshotJobCount);
+   }
+   END_LOCK_MUTEX
+
+   return needsCompaction;
+}
+
+void LocalJobJournal::recordJob(const api::JobPtr& in_job)
+{
+   m_impl->enqueue(in_job->Id, PendingRecord::Kind::JOB, in_job);
+}
+
+void LocalJobJournal::recordRemoval(const std::string& in_jobId)
+{
+   m_impl->enqueue(in_jobId, PendingRecord::Kind::REMOVAL, api::JobPtr());
+}
+
+void LocalJobJournal::recordStatus(const api::JobPtr& in_job)
+{
+   m_impl->enqueue(in_job->Id, PendingRecord::Kind::STATUS, in_job);
+}
+
+void LocalJobJournal::stop()
+{
+   m_impl->stopWriter();
+
+   // Nothing else can be queued by now, but write anything that raced with the writer exiting.
+   Error error = m_impl->drain();
+   if (error)
+      logging::logError(error, ERROR_LOCATION);
+}
+
+struct LocalJobJournalReader::Impl
+{
+   explicit Impl(const FilePath& in_journalDirectory) :
+      Directory(in_journalDirectory),
+      Generation(0),
+      IsLoaded(false),
+      Offset(0)
+   {
+   }
+
+   /**
+    * @brief Applies a single record, tracking which jobs were changed or removed.
+    *
+    * @param in_line        The record, which must be null terminated.
+    * @param in_length      The length of the record.
+    * @param io_changed     The IDs of the jobs which were changed.
+    * @param io_removed     The IDs of the jobs which were removed.
+    */
+   void applyLine(const char* in_line, size_t in_length, std::set<std::string>& io_changed, std::set<std::string>& io_removed)
+   {
+      ParsedRecord record;
+      Error error = parseRecord(in_line, in_length, record);
+
+      std::string id;
+      if (!error && (record.Type == RECORD_TYPE_JOB))
+         id = record.Job->Id;
+      else if (!error && (record.Type != RECORD_TYPE_HEADER))
+         error = json::readObject(record.Record, FIELD_ID, id);
+
+      Optional<uint64_t> unused;
+      if (!error)
+         error = applyRecord(record, Jobs, unused);
+
+      if (error)
+      {
+         error.addProperty("path", Directory);
+         logging::logErrorAsWarning(error);
+         return;
+      }
+
+      if (id.empty())
+         return;
+
+      if (record.Type == RECORD_TYPE_REMOVE)
+      {
+         io_changed.erase(id);
+         io_removed.insert(id);
+      }
+      else if (Jobs.find(id) != Jobs.end())
+      {
+         io_removed.erase(id);
+         io_changed.insert(id);
+      }
+   }
+
+   /**
+    * @brief Lists the journal files in the directory.
+    *
+    * @param out_journalFiles   The journal files, by generation.
+    *
+    * @return Success if the directory could be listed; Error otherwise.
+    */
+   Error listJournalFiles(std::map<uint64_t, FilePath>& out_journalFiles) const
+   {
+      std::vector<FilePath> children;
+      Error error = Directory.getChildren(children);
+      if (error)
+         return error;
+
+      for (const FilePath& child: children)
+      {
+         uint64_t generation = 0;
+         if (parseJournalGeneration(child, generation))
+            out_journalFiles[generation] = child;
+      }
+
+      return Success();
+   }
+
+   /**
+    * @brief Replaces the known jobs with the contents of the snapshot, and starts following the journal file of the
+    *        snapshot's generation from the beginning.
+    *
+    * @return Success if the snapshot could be read; Error otherwise.
+    */
+   Error loadSnapshot()
+   {
+      Jobs.clear();
+      Generation = 0;
+      Offset = 0;
+
+      FilePath snapshotFile = Directory.completeChildPath(SNAPSHOT_FILE);
+      if (snapshotFile.exists())
+      {
+         Optional<uint64_t> generation;
+         size_t records = 0, completeSize = 0;
+         Error error = replayFile(snapshotFile, 1, Jobs, generation, records, completeSize);
+         if (error)
+            return error;
+
+         Generation = generation.getValueOr(0);
+      }
+
+      IsLoaded = true;
+      return Success();
+   }
+
+   /**
+    * @brief Reads complete records from the journal file being followed.
+    *
+    * @param in_maxBytes    The maximum number of bytes to read. More may be read if a single record is larger.
+    * @param io_changed     The IDs of the jobs which were changed.
+    * @param io_removed     The IDs of the jobs which were removed.
+    * @param out_bytesRead  The number of bytes of complete records which were read.
+    * @param out_isAtEnd    Whether every complete record in the file has been read.
+    *
+    * @return Success if the file could be read; Error otherwise.
+    */
+   Error readJournal(
+      size_t in_maxBytes,
+      std::set<std::string>& io_changed,
+      std::set<std::string>& io_removed,
+      size_t& out_bytesRead,
+      bool& out_isAtEnd)
+   {
+      out_bytesRead = 0;
+      out_isAtEnd = true;
+
+      FilePath journalFile = Directory.completeChildPath(JOURNAL_FILE_PREFIX + std::to_string(Generation));
+      int fd = ::open(journalFile.getAbsolutePath().c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd < 0)
+      {
+         // The writer may not have created the journal file yet.
+         if (errno == ENOENT)
+            return Success();
+
+         Error error = systemError(errno, ERROR_LOCATION);
+         error.addProperty("path", journalFile);
+         return error;
+      }
+
+      // Read until the buffer holds at least one complete record, or the end of the file was reached.
+      std::string buffer;
+      size_t length = 0;
+      size_t want = std::max<size_t>(in_maxBytes, 1);
+      size_t lastNewLine = std::string::npos;
+      Error error;
+      while (true)
+      {
+         buffer.resize(length + want);
+         ssize_t result = ::pread(fd, &buffer[length], want, static_cast<off_t>(Offset + length));
+         if (result < 0)
+         {
+            if (errno == EINTR)
+               continue;
+
+            error = systemError(errno, ERROR_LOCATION);
+            error.addProperty("path", journalFile);
+            break;
+         }
+
+         length += static_cast<size_t>(result);
+         lastNewLine = buffer.rfind('\n', length == 0 ? 0 : length - 1);
+         out_isAtEnd = (static_cast<size_t>(result) < want);
+         if (out_isAtEnd)
+            break;
+
+         if ((lastNewLine != std::string::npos) && (lastNewLine < length))
+            break;
+
+         want *= 2;
+      }
+
+      ::close(fd);
+      if (error)
+         return error;
+
+      if ((lastNewLine == std::string::npos) || (lastNewLine >= length))
+         return Success();
+
+      // Apply every complete record, in order. Anything after the last new line hasn't been completely written yet.
+      size_t start = 0;
+      while (start <= lastNewLine)
+      {
+         size_t end = buffer.find('\n', start);
+         buffer[end] = '\0';
+         applyLine(&buffer[start], end - start, io_changed, io_removed);
+         start = end + 1;
+      }
+
+      out_bytesRead = start;
+      Offset += start;
+      return Success();
+   }
+
+   /** The directory which contains the snapshot and journal files. */
+   FilePath Directory;
+
+   /** The generation of the journal file being followed. */
+   uint64_t Generation;
+
+   /** Whether the snapshot has been read. */
+   bool IsLoaded;
+
+   /** The jobs in the journal, as of the last read. */
+   JobMap Jobs;
+
+   /** The offset in the journal file being followed of the next record to read. */
+   uint64_t Offset;
+};
+
+PRIVATE_IMPL_DELETER_IMPL(LocalJobJournalReader)
+
+LocalJobJournalReader::LocalJobJournalReader(const FilePath& in_journalDirectory) :
+   m_impl(new Impl(in_journalDirectory))
+{
+}
+
+Error LocalJobJournalReader::read(
+   size_t in_maxBytes,
+   api::JobList& out_changedJobs,
+   std::vector<std::string>& out_removedJobIds,
+   bool& out_isComplete)
+{
+   out_isComplete = false;
+
+   std::map<uint64_t, FilePath> journalFiles;
+   Error error = m_impl->listJournalFiles(journalFiles);
+   if (error)
+      return error;
+
+   // If the journal file being followed was removed by a compaction, records may have been missed, so start over from
+   // the new snapshot.
+   bool isBehind = m_impl->IsLoaded &&
+      (journalFiles.find(m_impl->Generation) == journalFiles.end()) &&
+      !journalFiles.empty() &&
+      (journalFiles.begin()->first > m_impl->Generation);
+   if (!m_impl->IsLoaded || isBehind)
+   {
+      error = m_impl->loadSnapshot();
+      if (error)
+         return error;
+
+      out_isComplete = true;
+   }
+
+   std::set<std::string> changed, removed;
+   size_t remaining = in_maxBytes;
+   while (remaining > 0)
+   {
+      size_t bytesRead = 0;
+      bool isAtEnd = false;
+      error = m_impl->readJournal(remaining, changed, removed, bytesRead, isAtEnd);
+      if (error)
+         return error;
+
+      remaining -= std::min(remaining, bytesRead);
+      if (!isAtEnd)
+         continue;
+
+      // Once a newer journal file exists, nothing more will be written to the current one.
+      auto next = journalFiles.upper_bound(m_impl->Generation);
+      if (next == journalFiles.end())
+         break;
+
+      m_impl->Generation = next->first;
+      m_impl->Offset = 0;
+   }
+
+   if (out_isComplete)
+   {
+      for (const auto& job: m_impl->Jobs)
+         out_changedJobs.emplace_back(new api::Job(*job.second));
+   }
+   else
+   {
+      for (const std::string& id: changed)
+         out_changedJobs.emplace_back(new api::Job(*m_impl->Jobs[id]));
+
+      out_removedJobIds.assign(removed.begin(), removed.end());
+   }
+
+   return Success();
+}
+
+} // namespace local
+} // namespace launcher_plugins
+} // namespace rstudio
@@ -23,13 +23,19 @@
 
 #include <LocalJobRepository.hpp>
 
+#include <set>
+
 #include <Error.hpp>
 #include <json/Json.hpp>
 #include <options/Options.hpp>
+#include <system/Asio.hpp>
+#include <system/DateTime.hpp>
 #include <system/FilePath.hpp>
 #include <system/Process.hpp>
 #include <utils/FileUtils.hpp>
 
+#include <LocalClusterJobIndex.hpp>
+#include <LocalJobJournal.hpp>
 #include <LocalOptions.hpp>
 
 using namespace rstudio::launcher_plugins::system;
@@ -49,11 +55,20 @@ constexpr const char* OUT_FILE_EXT = ".stdout";
 constexpr const char* ROOT_JOBS_DIR = "jobs";
 constexpr const char* ROOT_OUTPUT_DIR = "output";
 
+// How often to check whether the job journal should be compacted.
+constexpr int64_t COMPACTION_INTERVAL_MINUTES = 5;
+
+// How often to read the changes other Local Plugin instances made to their jobs.
+constexpr int64_t CLUSTER_REFRESH_INTERVAL_SECONDS = 5;
+
+// The most journal data to read for each other Local Plugin instance per refresh.
+constexpr size_t MAX_CLUSTER_READ_BYTES_PER_HOST = 4 * 1024 * 1024;
+
 inline void deleteFileAsUser(const system::User& in_user, const FilePath& in_file)
 {
    if (!in_file.isEmpty())
    {
-      logging::logDebugMessage("Deleting job file: " + in_file.getAbsolutePath());
+      LOG_DEBUG_MESSAGE("Deleting job file: " + in_file.getAbsolutePath());
 
       system::process::ProcessOptions opts;
       opts.Executable = "rm";
@@ -78,7 +93,7 @@ inline void deleteFileAsUser(const system::User& in_user, const FilePath& in_fil
                std::to_string(result.ExitCode),
             ERROR_LOCATION);
 
-         logging::logDebugMessage(
+         LOG_DEBUG_MESSAGE(
             "Delete output file stdout: " + result.StdOut + "\nDelete output file stderr:" + result.StdError);
       }
 
@@ -137,7 +152,7 @@ inline Error ensureUserDirectory( const system::FilePath& in_userDirectory, cons
                " exited with non-zero exit code " +
                std::to_string(result.ExitCode));
 
-         logging::logDebugMessage(
+         LOG_DEBUG_MESSAGE(
             "Create directory for user " +
                in_user.getUsername() +
                "\n    stdout: \"" +
@@ -154,11 +169,6 @@ inline Error ensureUserDirectory( const system::FilePath& in_userDirectory, cons
    return Success();
 }
 
-inline FilePath getJobFilePath(const std::string& in_id, const system::FilePath& in_jobsPath)
-{
-   return in_jobsPath.completeChildPath(in_id + JOB_FILE_EXT);
-}
-
 inline Error readJobFromFile(const FilePath& in_jobFile, api::JobPtr& out_job)
 {
    // Programmer error if the out_job is a nullptr.
@@ -177,16 +187,63 @@ inline Error readJobFromFile(const FilePath& in_jobFile, api::JobPtr& out_job)
    return api::Job::fromJson(jobObj, *out_job);
 }
 
+Error loadLegacyJobs(const FilePath& in_jobsPath, api::JobList& io_jobs, std::vector<FilePath>& out_legacyJobFiles)
+{
+   std::vector<FilePath> children;
+   Error error = in_jobsPath.getChildren(children);
+   if (error)
+      return error;
+
+   std::set<std::string> journaledIds;
+   for (const api::JobPtr& job: io_jobs)
+      journaledIds.insert(job->Id);
+
+   for (const FilePath& jobFile: children)
+   {
+      if (jobFile.getExtension() != JOB_FILE_EXT)
+         continue;
+
+      out_legacyJobFiles.push_back(jobFile);
+
+      api::JobPtr job(new api::Job());
+      error = readJobFromFile(jobFile, job);
+      if (error)
+      {
+         // If there's a problem loading a job, just log the error and skip the job.
+         logging::logError(error);
+         continue;
+      }
+
+      // The journal always has the most recent version of a job.
+      if (journaledIds.find(job->Id) == journaledIds.end())
+         io_jobs.push_back(job);
+   }
+
+   return Success();
+}
+
 } // anonymous namespace
 
 LocalJobRepository::LocalJobRepository(const std::string& in_hostname, jobs::JobStatusNotifierPtr in_notifier) :
-   AbstractJobRepository(std::move(in_notifier)),
+   AbstractJobRepository(in_notifier),
    m_hostname(in_hostname),
    m_jobsRootPath(options::Options::getInstance().getScratchPath().completeChildPath(ROOT_JOBS_DIR)),
+   m_clusterIndex(new LocalClusterJobIndex(m_jobsRootPath, m_hostname)),
+   m_clusterRefreshTimer(new AsyncTimedEvent()),
    m_jobsPath(m_jobsRootPath.completeChildPath(m_hostname)),
    m_saveUnspecifiedOutput(LocalOptions::getInstance().shouldSaveUnspecifiedOutput()),
-   m_outputRootPath(options::Options::getInstance().getScratchPath().completeChildPath(ROOT_OUTPUT_DIR))
+   m_outputRootPath(options::Options::getInstance().getScratchPath().completeChildPath(ROOT_OUTPUT_DIR)),
+   m_journal(new LocalJobJournal(m_jobsPath)),
+   m_compactionTimer(new AsyncTimedEvent()),
+   m_notifier(std::move(in_notifier))
+{
+}
+
+Error LocalJobRepository::getPeerHostAddresses(
+   const std::string& in_host,
+   std::vector<std::string>& out_addresses) const
 {
+   return m_clusterIndex->getHostAddresses(in_host, out_addresses);
 }
 
 void LocalJobRepository::saveJob(api::JobPtr in_job) const
@@ -194,11 +251,7 @@ void LocalJobRepository::saveJob(api::JobPtr in_job) const
    LOCK_JOB(in_job)
    {
       if (m_hostname == in_job->Host)
-      {
-         Error error = utils::writeStringToFile(in_job->toJson().write(), getJobFilePath(in_job->Id, m_jobsPath));
-         if (error)
-            logging::logError(error, ERROR_LOCATION);
-      }
+         m_journal->recordJob(in_job);
    }
    END_LOCK_JOB
 }
@@ -223,63 +276,198 @@ Error LocalJobRepository::setJobOutputPaths(api::JobPtr io_job) const
    return Success();
 }
 
-Error LocalJobRepository::loadJobs(api::JobList& out_jobs) const
+void LocalJobRepository::setOnRunningJobLoaded(OnRunningJobLoaded in_onRunningJobLoaded)
 {
-   std::vector<FilePath> jobFiles;
-   Error error = m_jobsPath.getChildren(jobFiles);
+   m_onRunningJobLoaded = std::move(in_onRunningJobLoaded);
+}
+
+void LocalJobRepository::refreshClusterJobs()
+{
+   PeerJobChangesList peerChanges;
+   Error error = m_clusterIndex->refresh(MAX_CLUSTER_READ_BYTES_PER_HOST, peerChanges);
    if (error)
-      return error;
+   {
+      logging::logError(error, ERROR_LOCATION);
+      return;
+   }
 
-   for (const FilePath& jobFile: jobFiles)
+   for (const PeerJobChanges& changes: peerChanges)
    {
-      if (jobFile.getExtension() != JOB_FILE_EXT)
-         continue;
+      if (changes.IsComplete)
+      {
+         std::set<std::string> currentIds;
+         for (const api::JobPtr& job: changes.ChangedJobs)
+            currentIds.insert(job->Id);
 
-      api::JobPtr job(new api::Job());
-      error = readJobFromFile(jobFile, job);
-      if (error)
+         for (const api::JobPtr& job: getJobs())
+         {
+            if ((job->Host == changes.Host) && (currentIds.find(job->Id) == currentIds.end()))
+               removeJob(job->Id);
+         }
+      }
+
+      for (const std::string& id: changes.RemovedJobIds)
       {
-         // If there's a problem loading a job, just log the error and skip the job.
-         logging::logError(error);
-         continue;
+         // Never let another host remove a job owned by this one.
+         api::JobPtr job = getJob(id);
+         if (job && (job->Host != m_hostname))
+            removeJob(id);
+      }
+
+      for (const api::JobPtr& peerJob: changes.ChangedJobs)
+      {
+         api::JobPtr job = getJob(peerJob->Id);
+         if (!job)
+         {
+            addJob(peerJob);
+            continue;
+         }
+
+         if (job->Host == m_hostname)
+            continue;
+
+         // Status changes go through the notifier so that anyone streaming the job's status sees them.
+         LOCK_JOB(job)
+         {
+            api::Job::State status = job->Status;
+            std::string statusMessage = job->StatusMessage;
+            Optional<DateTime> lastUpdateTime = job->LastUpdateTime;
+
+            *job = *peerJob;
+            job->Status = status;
+            job->StatusMessage = statusMessage;
+            job->LastUpdateTime = lastUpdateTime;
+         }
+         END_LOCK_JOB
+
+         m_notifier->updateJob(
+            job,
+            peerJob->Status,
+            peerJob->StatusMessage,
+            peerJob->LastUpdateTime.getValueOr(DateTime()));
       }
+   }
+}
+
+void LocalJobRepository::compactJournal()
+{
+   if (!m_journal->needsCompaction())
+      return;
+
+   Error error = m_journal->compact(
+      [this]()
+      {
+         api::JobList ownedJobs;
+         for (const api::JobPtr& job: getJobs())
+         {
+            if (job->Host == m_hostname)
+               ownedJobs.push_back(job);
+         }
+
+         return ownedJobs;
+      });
 
+   if (error)
+      logging::logError(error, ERROR_LOCATION);
+}
+
+Error LocalJobRepository::loadJobs(api::JobList& out_jobs) const
+{
+   Error error = m_journal->load(options::Options::getInstance().getThreadPoolSize(), out_jobs);
+   if (error)
+      return error;
+
+   // Older versions of the Local Plugin saved each job to its own file. Any that are found will be moved into the
+   // journal.
+   std::vector<FilePath> legacyJobFiles;
+   error = loadLegacyJobs(m_jobsPath, out_jobs, legacyJobFiles);
+   if (error)
+      return error;
+
+   // Check every incomplete job against a single listing of the running processes, rather than probing /proc for each
+   // job.
+   std::set<pid_t> runningPids;
+   error = system::process::getProcessIds(runningPids);
+   if (error)
+      return error;
+
+   for (const api::JobPtr& job: out_jobs)
+   {
       // Update the status of the job on load.
       if (!job->isCompleted())
       {
          bool jobModified = false;
-         system::process::ProcessInfo procInfo;
-         Error error = system::process::ProcessInfo::getProcessInfo(job->Pid.getValueOr(0), procInfo);
-         if (isFileNotFoundError(error))
+         if (!job->Pid)
          {
-            // If we couldn't find details about the job, it finished between the time the last instance of the Local 
-            // Plugin exited and this instance started. Update the job state to the best of our knowledge to avoid jobs
-            // stuck in their states.
-            job->Status = api::Job::State::FINISHED;
+            // Jobs which were waiting for resources were never started, and their queue didn't survive the restart.
+            job->Status = api::Job::State::FAILED;
+            job->StatusMessage = "The Local Plugin stopped while the job was waiting for resources.";
             job->LastUpdateTime = system::DateTime();
             jobModified = true;
          }
-         else if (!error && (job->Status ==  api::Job::State::PENDING) && (procInfo.Executable != "rsandbox"))
+         else if (runningPids.find(job->Pid.getValueOr(0)) == runningPids.end())
          {
-            job->Status = api::Job::State::RUNNING;
+            // If the process isn't running, the job finished between the time the last instance of the Local Plugin
+            // exited and this instance started. Update the job state to the best of our knowledge to avoid jobs stuck
+            // in their states.
+            job->Status = api::Job::State::FINISHED;
             job->LastUpdateTime = system::DateTime();
             jobModified = true;
          }
-         else if (error)
+         else if (job->Status == api::Job::State::PENDING)
          {
-            job->Status = api::Job::State::FAILED;
-            job->LastUpdateTime = system::DateTime();
-            jobModified = true;
+            // Only pending jobs need the details of their process, to tell whether the job has started yet.
+            system::process::ProcessInfo procInfo;
+            error = system::process::ProcessInfo::getProcessInfo(job->Pid.getValueOr(0), procInfo);
+            if (error)
+            {
+               job->Status = api::Job::State::FAILED;
+               job->LastUpdateTime = system::DateTime();
+               jobModified = true;
+            }
+            else if (procInfo.Executable != "rsandbox")
+            {
+               job->Status = api::Job::State::RUNNING;
+               job->LastUpdateTime = system::DateTime();
+               jobModified = true;
+            }
          }
-         
 
          if (jobModified)
-            saveJob(job);
+            m_journal->recordStatus(job);
+
+         // The job's process outlived the previous instance of the Local Plugin, so it is still using resources.
+         if (!job->isCompleted() && m_onRunningJobLoaded)
+            m_onRunningJobLoaded(job);
       }
+   }
 
-      out_jobs.push_back(job);
+   if (!legacyJobFiles.empty() || m_journal->needsCompaction())
+   {
+      error = m_journal->compact([&out_jobs]() { return out_jobs; });
+      if (error)
+         logging::logError(error, ERROR_LOCATION);
+      else
+      {
+         // The legacy job files are only safe to remove once their jobs are in the snapshot.
+         for (const FilePath& jobFile: legacyJobFiles)
+         {
+            error = jobFile.removeIfExists();
+            if (error)
+               logging::logError(error, ERROR_LOCATION);
+         }
+      }
    }
 
+   // The jobs of the other hosts are added last, so they are never written to this host's snapshot.
+   PeerJobChangesList peerChanges;
+   error = m_clusterIndex->refresh(MAX_CLUSTER_READ_BYTES_PER_HOST, peerChanges);
+   if (error)
+      logging::logError(error, ERROR_LOCATION);
+
+   for (const PeerJobChanges& changes: peerChanges)
+      out_jobs.insert(out_jobs.end(), changes.ChangedJobs.begin(), changes.ChangedJobs.end());
+
    logging::logInfoMessage("Loaded " + std::to_string(out_jobs.size())  + " jobs from file");
 
    return Success();
@@ -296,16 +484,13 @@ void LocalJobRepository::onJobRemoved(const api::JobPtr& in_job)
    {
       if (in_job->Host != m_hostname)
       {
-         logging::logDebugMessage("Not deleting job files for job " + in_job->Id + " owned by host " + in_job->Host);
+         LOG_DEBUG_MESSAGE("Not deleting job files for job " + in_job->Id + " owned by host " + in_job->Host);
          return;
       }
 
-      logging::logDebugMessage("Deleting job files for job: " + in_job->Id);
+      LOG_DEBUG_MESSAGE("Deleting job files for job: " + in_job->Id);
 
-      FilePath jobFile = getJobFilePath(in_job->Id, m_jobsPath);
-      Error error = jobFile.removeIfExists();
-      if (error)
-         logging::logError(error, ERROR_LOCATION);
+      m_journal->recordRemoval(in_job->Id);
 
       FilePath stdoutFile(in_job->StandardOutFile);
       FilePath stderrFile(in_job->StandardErrFile);
@@ -318,6 +503,20 @@ void LocalJobRepository::onJobRemoved(const api::JobPtr& in_job)
    END_LOCK_JOB
 }
 
+void LocalJobRepository::onJobUpdated(const api::JobPtr& in_job)
+{
+   // The job lock is already held.
+   if (in_job->Host == m_hostname)
+      m_journal->recordStatus(in_job);
+}
+
+void LocalJobRepository::onShutdown()
+{
+   m_clusterRefreshTimer->cancel();
+   m_compactionTimer->cancel();
+   m_journal->stop();
+}
+
 Error LocalJobRepository::onInitialize()
 {
    Error error = ensureDirectory(m_jobsRootPath);
@@ -332,6 +531,23 @@ Error LocalJobRepository::onInitialize()
    if (error)
       return error;
 
+   WeakThis weakThis = std::static_pointer_cast<LocalJobRepository>(shared_from_this());
+   m_compactionTimer->start(
+      TimeDuration::Minutes(COMPACTION_INTERVAL_MINUTES),
+      [weakThis]()
+      {
+         if (SharedThis sharedThis = weakThis.lock())
+            sharedThis->compactJournal();
+      });
+
+   m_clusterRefreshTimer->start(
+      TimeDuration::Seconds(CLUSTER_REFRESH_INTERVAL_SECONDS),
+      [weakThis]()
+      {
+         if (SharedThis sharedThis = weakThis.lock())
+            sharedThis->refreshClusterJobs();
+      });
+
    return Success();
 }
 
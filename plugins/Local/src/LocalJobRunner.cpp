@@ -23,19 +23,23 @@
 
 #include <LocalJobRunner.hpp>
 
-#include <cmath>
+#include <unistd.h>
 
-#include <boost/algorithm/string.hpp>
+#include <algorithm>
+#include <cmath>
+#include <set>
 
 #include <json/Json.hpp>
 #include <system/Asio.hpp>
 #include <system/DateTime.hpp>
 #include <system/Crypto.hpp>
 #include <system/Process.hpp>
+#include <utils/FileUtils.hpp>
 
 #include <LocalConstants.hpp>
 #include <LocalError.hpp>
 #include <LocalJobRepository.hpp>
+#include <LocalOptions.hpp>
 
 namespace rstudio {
 namespace launcher_plugins {
@@ -47,10 +51,13 @@ typedef std::shared_ptr<LocalJobRunner> SharedThis;
 
 namespace {
 
+// How often to check whether the processes of the running jobs loaded at startup have exited.
+constexpr int64_t LOADED_JOB_POLL_INTERVAL_SECONDS = 5;
+
 Error decryptPassword(const api::JobPtr& in_job, const std::string& in_key, std::string& out_password)
 {
    Optional<std::string> encryptedPasswordOpt = in_job->getJobConfigValue(s_encryptedPassword);
-   if (!encryptedPasswordOpt)
+   if (encryptedPasswordOpt)
    {
       std::string encryptedPassword = encryptedPasswordOpt.getValueOr("");
 
@@ -84,18 +91,39 @@ Error generateJobId(std::string& out_id)
 {
    // The ID just needs to be unique, so generate some random data and then base-64 encode it so it's writable to file
    // and to be used in a file name.
-   std::vector<unsigned char> randomData;
-   Error error = system::crypto::random(16, randomData);
+   unsigned char randomData[16];
+   Error error = system::crypto::random(sizeof(randomData), randomData);
    if (error)
       return error;
 
-   std::string id;
-   error = system::crypto::base64Encode(randomData, id);
+   error = system::crypto::base64Encode(randomData, sizeof(randomData), out_id);
    if (error)
       return error;
 
    // Don't allow / in the ID, as it will be used as part of a file name.
-   out_id = boost::replace_all_copy(id, "/", "-");
+   std::replace(out_id.begin(), out_id.end(), '/', '-');
+   return Success();
+}
+
+/**
+ * @brief Gets the name of the program which the specified process is currently running.
+ *
+ * Only /proc/<pid>/cmdline is read, since that is enough to tell whether rsandbox has executed the job yet.
+ *
+ * @param in_pid        The ID of the process.
+ * @param out_name      The file name of the program the process is running.
+ *
+ * @return Success if the program name could be read; Error otherwise.
+ */
+Error getProgramName(const std::string& in_pid, std::string& out_name)
+{
+   std::string cmdline;
+   Error error = utils::readFileIntoString(system::FilePath("/proc/" + in_pid + "/cmdline"), cmdline);
+   if (error)
+      return error;
+
+   // The first NUL-separated element is the command.
+   out_name = system::FilePath(cmdline.substr(0, cmdline.find('\0'))).getFilename();
    return Success();
 }
 
@@ -147,19 +175,171 @@ Error populateProcessOptions(
 
 } // anonymous namespace
 
+/**
+ * @brief The file to which the errors reported by rsandbox for a job are appended.
+ */
+struct LocalJobRunner::JobErrorFile
+{
+   /**
+    * @brief Constructor.
+    *
+    * @param in_job     The job whose errors will be written.
+    */
+   explicit JobErrorFile(api::JobPtr in_job) :
+      Fd(-1),
+      IsClosed(false),
+      Job(std::move(in_job))
+   {
+   }
+
+   /**
+    * @brief Destructor. Closes the file, if it is open.
+    */
+   ~JobErrorFile()
+   {
+      close();
+   }
+
+   /**
+    * @brief Closes the file, if it is open. Nothing more will be written to the file after this is invoked.
+    */
+   void close()
+   {
+      LOCK_MUTEX(Mutex)
+      {
+         if (Fd >= 0)
+            ::close(Fd);
+
+         Fd = -1;
+         IsClosed = true;
+      }
+      END_LOCK_MUTEX
+   }
+
+   /**
+    * @brief Appends the specified error to the file, opening it as the job user if necessary.
+    *
+    * @param in_error   The error to append.
+    */
+   void write(const std::string& in_error)
+   {
+      if (Job->StandardErrFile.empty())
+         return;
+
+      LOCK_MUTEX(Mutex)
+      {
+         if (IsClosed)
+            return;
+
+         if (Fd < 0)
+         {
+            Error error = system::process::openFileForAppendAsUser(
+               system::FilePath(Job->StandardErrFile),
+               Job->User,
+               Fd);
+            if (error)
+            {
+               // Don't try again for every error the job reports.
+               IsClosed = true;
+               error.addProperty("description", "Could not open job output file " + Job->StandardErrFile);
+               logging::logError(error, ERROR_LOCATION);
+               return;
+            }
+         }
+
+         const char* data = in_error.c_str();
+         size_t remaining = in_error.size();
+         while (remaining > 0)
+         {
+            ssize_t written = ::write(Fd, data, remaining);
+            if ((written < 0) && (errno == EINTR))
+               continue;
+
+            if (written <= 0)
+            {
+               Error error = systemError(errno, ERROR_LOCATION);
+               error.addProperty(
+                  "description",
+                  "Could not write rsandbox error to job output file " + Job->StandardErrFile);
+               logging::logError(error, ERROR_LOCATION);
+               return;
+            }
+
+            data += written;
+            remaining -= static_cast<size_t>(written);
+         }
+      }
+      END_LOCK_MUTEX
+   }
+
+   /** The file descriptor of the open file, or -1 if it isn't open. */
+   int Fd;
+
+   /** Whether the file has been closed, or could not be opened. */
+   bool IsClosed;
+
+   /** The job whose errors will be written. */
+   api::JobPtr Job;
+
+   /** The mutex which protects the file. */
+   std::mutex Mutex;
+};
+
 LocalJobRunner::LocalJobRunner(
    const std::string& in_hostname,
    jobs::JobStatusNotifierPtr in_notifier,
    std::shared_ptr<LocalJobRepository> in_jobRepository) :
+   m_admissionQueue(LocalOptions::getInstance().getMaxCpus(), LocalOptions::getInstance().getMaxMemoryMb()),
    m_hostname(in_hostname),
    m_jobRepo(std::move(in_jobRepository)),
    m_notifier(std::move(in_notifier))
 {
 }
 
+bool LocalJobRunner::cancelJob(const api::JobPtr& in_job)
+{
+   api::JobList admittedJobs;
+   if (!m_admissionQueue.cancel(in_job->Id, admittedJobs))
+      return false;
+
+   LOCK_MUTEX(m_mutex)
+   {
+      m_queuedProcessOptions.erase(in_job->Id);
+   }
+   END_LOCK_MUTEX
+
+   m_notifier->updateJob(in_job, State::CANCELED);
+   startAdmittedJobs(admittedJobs);
+   return true;
+}
+
 Error LocalJobRunner::initialize()
 {
-   return m_secureCookie.initialize();
+   Error error = m_secureCookie.initialize();
+   if (error)
+      return error;
+
+   // Until the job process has executed rsandbox, it will still be running this program.
+   error = getProgramName("self", m_launcherProgram);
+   if (error)
+      return error;
+
+   // Prefer to be told when job processes call exec. If that isn't possible, fall back to polling.
+   m_execWatcher.reset(
+      new LocalExecWatcher(std::bind(LocalJobRunner::onProcessExec, weak_from_this(), std::placeholders::_1)));
+   error = m_execWatcher->start();
+   if (error)
+   {
+      logging::logErrorAsInfo(error);
+      logging::logInfoMessage(
+         "Process events are unavailable. Job processes will be polled to detect when they start.");
+   }
+
+   // Jobs started by a previous instance of the Local Plugin are still using resources if they are running.
+   m_jobRepo->setOnRunningJobLoaded(
+      std::bind(LocalJobRunner::onRunningJobLoaded, weak_from_this(), std::placeholders::_1));
+
+   return Success();
 }
 
 Error LocalJobRunner::runJob(api::JobPtr& io_job, bool& out_wasInvalidJob)
@@ -188,21 +368,68 @@ Error LocalJobRunner::runJob(api::JobPtr& io_job, bool& out_wasInvalidJob)
       return error;
    }
 
-   // Set up the onExit and onStderr (for logging) callbacks.
+   // Store the process options first, since resources released on another thread may admit the job as soon as it has
+   // been submitted to the admission queue.
+   auto queuedProcOpts = std::make_shared<system::process::ProcessOptions>(std::move(procOpts));
+   LOCK_MUTEX(m_mutex)
+   {
+      m_queuedProcessOptions[io_job->Id] = queuedProcOpts;
+   }
+   END_LOCK_MUTEX
+
+   // Reserve the job's CPUs and memory, or wait until they are free. The SDK adds the job to the repository once it is
+   // PENDING, so queued jobs can be seen and canceled.
+   bool isAdmitted = false;
+   error = m_admissionQueue.submit(io_job, isAdmitted);
+   if (error || isAdmitted)
+   {
+      LOCK_MUTEX(m_mutex)
+      {
+         m_queuedProcessOptions.erase(io_job->Id);
+      }
+      END_LOCK_MUTEX
+   }
+
+   if (error)
+   {
+      out_wasInvalidJob = true;
+      return error;
+   }
+
+   if (!isAdmitted)
+   {
+      LOG_DEBUG_MESSAGE("Job " + io_job->Id + " is waiting for resources.");
+      m_notifier->updateJob(io_job, State::PENDING, "Waiting for resources.");
+      return Success();
+   }
+
+   error = launchJob(io_job, *queuedProcOpts);
+   if (error)
+      releaseResources(io_job->Id);
+
+   return error;
+}
+
+Error LocalJobRunner::launchJob(const api::JobPtr& io_job, const system::process::ProcessOptions& in_procOpts)
+{
+   // Set up the onExit and onStderr (for logging) callbacks. The job's stderr file is opened when the first error is
+   // written to it, and closed when the job exits.
+   auto errorFile = std::make_shared<JobErrorFile>(io_job);
    system::process::AsyncProcessCallbacks callbacks;
    callbacks.OnExit = std::bind(
       LocalJobRunner::onJobExitCallback,
       weak_from_this(),
       std::placeholders::_1,
-      io_job);
+      io_job,
+      errorFile);
 
    const std::string& jobId = io_job->Id;
-   callbacks.OnStandardError = std::bind(LocalJobRunner::onJobErrorCallback, io_job, std::placeholders::_1);
+   callbacks.OnStandardError = std::bind(LocalJobRunner::onJobErrorCallback, errorFile, std::placeholders::_1);
 
    // Run the process. The SDK locks the job before calling submit job, which prevents the job going from non-existent
    // in the system directly to the FINISHED status if the job is very quick.
    std::shared_ptr<system::process::AbstractChildProcess> childProcess;
-   error = system::process::ProcessSupervisor::runAsyncProcess(procOpts, callbacks, &childProcess);
+   Error error = system::process::ProcessSupervisor::runAsyncProcess(in_procOpts, callbacks, &childProcess);
    if (error || (childProcess == nullptr))
       return createError(
          LocalError::JOB_LAUNCH_ERROR,
@@ -214,6 +441,23 @@ Error LocalJobRunner::runJob(api::JobPtr& io_job, bool& out_wasInvalidJob)
    io_job->Pid = childProcess->getPid();
    m_notifier->updateJob(io_job, State::PENDING);
 
+   // Watch for the job to exec. The process may already have done so before it was watched, so check it once now.
+   if (m_execWatcher->isActive())
+   {
+      pid_t pid = io_job->Pid.getValueOr(0);
+      LOCK_MUTEX(m_mutex)
+      {
+         m_execWatchJobs[pid] = io_job;
+      }
+      END_LOCK_MUTEX
+
+      m_execWatcher->watch(pid);
+      if (checkProcessStarted(io_job))
+         removeExecWatch(pid);
+
+      return Success();
+   }
+
    auto jobWatchEvent = std::make_shared<system::AsyncDeadlineEvent>(
       std::bind(LocalJobRunner::onProcessWatchDeadline, weak_from_this(), 1, io_job),
       system::TimeDuration::Microseconds(100000));
@@ -223,49 +467,33 @@ Error LocalJobRunner::runJob(api::JobPtr& io_job, bool& out_wasInvalidJob)
    return Success();
 }
 
-void LocalJobRunner::onJobErrorCallback(api::JobPtr in_job, const std::string& in_errorStr)
+void LocalJobRunner::onJobErrorCallback(const JobErrorFilePtr& in_errorFile, const std::string& in_errorStr)
 {
-   logging::logDebugMessage("Standard error for job " + in_job->Id + ": " + in_errorStr);
+   // A misbehaving job may write to stderr continuously, so limit how much of it is logged. It is still written in full
+   // to the job's error file below.
+   LOG_RATE_LIMITED(
+      logging::LogLevel::DEBUG,
+      100,
+      10,
+      "Standard error for job " + in_errorFile->Job->Id + ": " + in_errorStr);
 
    // If there's a stderr file for the job, write the error there as well.
-   if (!in_job->StandardErrFile.empty())
-   {
-      system::process::ProcessOptions procOpts;
-      procOpts.Executable = "echo";
-      procOpts.Arguments = { in_errorStr };
-      procOpts.IsShellCommand = true;
-      procOpts.StandardOutputFile = system::FilePath(in_job->StandardErrFile);
-      procOpts.StandardErrorFile = procOpts.StandardOutputFile;
-
-      system::process::SyncChildProcess childProcess(procOpts);
-      system::process::ProcessResult result;
-
-      Error error = childProcess.run(result);
-
-      std::string errMsg = "Could not write rsandbox error to job output file " + in_job->StandardErrFile;
-      if (error)
-      {
-         error.addProperty("description", errMsg);
-         logging::logError(error, ERROR_LOCATION);
-      }
-
-      if (result.ExitCode != 0)
-      {
-         if (!result.StdError.empty())
-            errMsg.append(" - ").append(result.StdError);
-
-         logging::logErrorMessage(errMsg, ERROR_LOCATION);
-      }
-   }
+   in_errorFile->write(in_errorStr);
 }
 
-void LocalJobRunner::onJobExitCallback(WeakLocalJobRunner in_weakThis, int in_exitCode, api::JobPtr io_job)
+void LocalJobRunner::onJobExitCallback(
+   WeakLocalJobRunner in_weakThis,
+   int in_exitCode,
+   api::JobPtr io_job,
+   const JobErrorFilePtr& in_errorFile)
 {
+   in_errorFile->close();
+
    if (SharedThis sharedThis = in_weakThis.lock())
    {
       LOCK_JOB(io_job)
       {
-         logging::logDebugMessage(
+         LOG_DEBUG_MESSAGE(
             "Job " +
             io_job->Id +
             "(pid " +
@@ -274,6 +502,7 @@ void LocalJobRunner::onJobExitCallback(WeakLocalJobRunner in_weakThis, int in_ex
             std::to_string(in_exitCode));
 
          io_job->ExitCode = in_exitCode;
+         sharedThis->removeExecWatch(io_job->Pid.getValueOr(0));
 
          // If the job was explicitly killed, the status doesn't need to be changed so there's no need to notify.
          // Normally notifying the status update will save the job, so save the job manually this time. Otherwise,
@@ -296,6 +525,79 @@ void LocalJobRunner::onJobExitCallback(WeakLocalJobRunner in_weakThis, int in_ex
          }
       }
       END_LOCK_JOB
+
+      sharedThis->releaseResources(io_job->Id);
+   }
+}
+
+void LocalJobRunner::onJobAdmitted(WeakLocalJobRunner in_weakThis, api::JobPtr io_job)
+{
+   if (SharedThis sharedThis = in_weakThis.lock())
+   {
+      std::shared_ptr<system::process::ProcessOptions> procOpts;
+      LOCK_MUTEX(sharedThis->m_mutex)
+      {
+         auto itr = sharedThis->m_queuedProcessOptions.find(io_job->Id);
+         if (itr != sharedThis->m_queuedProcessOptions.end())
+         {
+            procOpts = itr->second;
+            sharedThis->m_queuedProcessOptions.erase(itr);
+         }
+      }
+      END_LOCK_MUTEX
+
+      Error error;
+      LOCK_JOB(io_job)
+      {
+         if (procOpts == nullptr)
+            error = createError(
+               LocalError::JOB_LAUNCH_ERROR,
+               "Process options for queued job " + io_job->Id + " are missing.",
+               ERROR_LOCATION);
+         else
+            error = sharedThis->launchJob(io_job, *procOpts);
+
+         if (error)
+            sharedThis->m_notifier->updateJob(io_job, State::FAILED, "Could not launch the job.");
+      }
+      END_LOCK_JOB
+
+      if (error)
+      {
+         logging::logError(error, ERROR_LOCATION);
+         sharedThis->releaseResources(io_job->Id);
+      }
+   }
+}
+
+void LocalJobRunner::onRunningJobLoaded(WeakLocalJobRunner in_weakThis, const api::JobPtr& in_job)
+{
+   if (SharedThis sharedThis = in_weakThis.lock())
+   {
+      sharedThis->m_admissionQueue.reserve(in_job);
+
+      // The process isn't a child of this process, so its exit can't be waited on. Poll for it instead.
+      bool startTimer = false;
+      LOCK_MUTEX(sharedThis->m_mutex)
+      {
+         startTimer = (sharedThis->m_loadedJobsTimer == nullptr);
+         if (startTimer)
+            sharedThis->m_loadedJobsTimer.reset(new system::AsyncTimedEvent());
+
+         sharedThis->m_loadedJobs[in_job->Id] = in_job;
+      }
+      END_LOCK_MUTEX
+
+      if (startTimer)
+      {
+         sharedThis->m_loadedJobsTimer->start(
+            system::TimeDuration::Seconds(LOADED_JOB_POLL_INTERVAL_SECONDS),
+            [in_weakThis]()
+            {
+               if (SharedThis sharedThis = in_weakThis.lock())
+                  sharedThis->checkLoadedJobs();
+            });
+      }
    }
 }
 
@@ -313,30 +615,8 @@ void LocalJobRunner::onProcessWatchDeadline(WeakLocalJobRunner in_weakThis, int
 
       LOCK_JOB(io_job)
       {
-         // Check the job status. If it already exited, just stop watching.
-         if ((io_job->Status == State::KILLED) || (io_job->Status == State::FINISHED))
-         {
-            // Remove the watch event to prevent an ever-growing map.
-            sharedThis->removeWatchEvent(io_job->Id);
-            return;
-         }
-
-         system::process::ProcessInfo procInfo;
-         Error error = system::process::ProcessInfo::getProcessInfo(io_job->Pid.getValueOr(0), procInfo);
-         if (error)
-         {
-            logging::logError(error, ERROR_LOCATION);
-
-            // Remove the watch event to prevent an ever-growing map.
-            sharedThis->removeWatchEvent(io_job->Id);
-            return;
-         }
-
-         // If the process name has changed from rsandbox, then the job is running. Update the status and exit.
-         if (procInfo.Executable != "rsandbox")
+         if (sharedThis->checkProcessStarted(io_job))
          {
-            sharedThis->m_notifier->updateJob(io_job, State::RUNNING);
-
             // Remove the watch event to prevent an ever-growing map.
             sharedThis->removeWatchEvent(io_job->Id);
             return;
@@ -359,6 +639,126 @@ void LocalJobRunner::onProcessWatchDeadline(WeakLocalJobRunner in_weakThis, int
    }
 }
 
+void LocalJobRunner::onProcessExec(WeakLocalJobRunner in_weakThis, pid_t in_pid)
+{
+   if (SharedThis sharedThis = in_weakThis.lock())
+   {
+      api::JobPtr job;
+      LOCK_MUTEX(sharedThis->m_mutex)
+      {
+         auto itr = sharedThis->m_execWatchJobs.find(in_pid);
+         if (itr != sharedThis->m_execWatchJobs.end())
+            job = itr->second;
+      }
+      END_LOCK_MUTEX
+
+      if (job == nullptr)
+         return;
+
+      bool startPolling = false;
+      LOCK_JOB(job)
+      {
+         if (sharedThis->checkProcessStarted(job))
+            sharedThis->removeExecWatch(in_pid);
+         else if (!sharedThis->m_execWatcher->isActive())
+         {
+            // Exec events are no longer being received, so the job won't be noticed starting unless it is polled.
+            sharedThis->removeExecWatch(in_pid);
+            startPolling = true;
+         }
+      }
+      END_LOCK_JOB
+
+      if (startPolling)
+      {
+         auto jobWatchEvent = std::make_shared<system::AsyncDeadlineEvent>(
+            std::bind(LocalJobRunner::onProcessWatchDeadline, in_weakThis, 1, job),
+            system::TimeDuration::Microseconds(100000));
+         sharedThis->addProcessWatchEvent(job->Id, jobWatchEvent);
+         jobWatchEvent->start();
+      }
+   }
+}
+
+bool LocalJobRunner::checkProcessStarted(const api::JobPtr& io_job)
+{
+   // If the job already exited or started running, there's nothing left to watch for.
+   if (io_job->Status != State::PENDING)
+      return true;
+
+   std::string programName;
+   Error error = getProgramName(std::to_string(io_job->Pid.getValueOr(0)), programName);
+   if (error)
+   {
+      logging::logError(error, ERROR_LOCATION);
+      return true;
+   }
+
+   // Until the process has executed rsandbox and rsandbox has executed the job, the job is still pending.
+   if ((programName == "rsandbox") || (programName == m_launcherProgram))
+      return false;
+
+   m_notifier->updateJob(io_job, State::RUNNING);
+   return true;
+}
+
+void LocalJobRunner::checkLoadedJobs()
+{
+   LoadedJobs loadedJobs;
+   LOCK_MUTEX(m_mutex)
+   {
+      loadedJobs = m_loadedJobs;
+   }
+   END_LOCK_MUTEX
+
+   std::set<pid_t> runningPids;
+   Error error = system::process::getProcessIds(runningPids);
+   if (error)
+   {
+      logging::logError(error, ERROR_LOCATION);
+      return;
+   }
+
+   for (const auto& loadedJob: loadedJobs)
+   {
+      const api::JobPtr& job = loadedJob.second;
+      bool hasExited = false;
+      LOCK_JOB(job)
+      {
+         // A job which was killed is already complete, but its resources are in use until its process exits.
+         if (runningPids.find(job->Pid.getValueOr(0)) == runningPids.end())
+         {
+            hasExited = true;
+            if (!job->isCompleted())
+            {
+               // The exit code isn't known, since the process wasn't a child of this process.
+               if (job->Status == State::PENDING)
+                  m_notifier->updateJob(job, State::RUNNING);
+
+               m_notifier->updateJob(job, State::FINISHED);
+            }
+         }
+      }
+      END_LOCK_JOB
+
+      if (!hasExited)
+         continue;
+
+      bool isDone = false;
+      LOCK_MUTEX(m_mutex)
+      {
+         m_loadedJobs.erase(job->Id);
+         isDone = m_loadedJobs.empty();
+      }
+      END_LOCK_MUTEX
+
+      if (isDone)
+         m_loadedJobsTimer->cancel();
+
+      releaseResources(job->Id);
+   }
+}
+
 void LocalJobRunner::addProcessWatchEvent(
    const std::string& in_id,
    const std::shared_ptr<system::AsyncDeadlineEvent>& in_processWatchEvent)
@@ -370,6 +770,23 @@ void LocalJobRunner::addProcessWatchEvent(
    END_LOCK_MUTEX
 }
 
+void LocalJobRunner::removeExecWatch(pid_t in_pid)
+{
+   m_execWatcher->unwatch(in_pid);
+   LOCK_MUTEX(m_mutex)
+   {
+      m_execWatchJobs.erase(in_pid);
+   }
+   END_LOCK_MUTEX
+}
+
+void LocalJobRunner::releaseResources(const std::string& in_id)
+{
+   api::JobList admittedJobs;
+   m_admissionQueue.release(in_id, admittedJobs);
+   startAdmittedJobs(admittedJobs);
+}
+
 void LocalJobRunner::removeWatchEvent(const std::string& in_id)
 {
    LOCK_MUTEX(m_mutex)
@@ -381,6 +798,12 @@ void LocalJobRunner::removeWatchEvent(const std::string& in_id)
    END_LOCK_MUTEX
 }
 
+void LocalJobRunner::startAdmittedJobs(const api::JobList& in_jobs)
+{
+   for (const api::JobPtr& job: in_jobs)
+      system::AsioService::post(std::bind(LocalJobRunner::onJobAdmitted, weak_from_this(), job));
+}
+
 } // namespace local
 } // namespace launcher_plugins
 } // namespace rstudio
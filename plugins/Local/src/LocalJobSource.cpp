@@ -27,10 +27,11 @@
 
 #include <Error.hpp>
 #include <api/stream/FileOutputStream.hpp>
-#include <system/PosixSystem.hpp>
 #include <system/Process.hpp>
 
 #include <LocalConstants.hpp>
+#include <LocalError.hpp>
+#include <LocalOptions.hpp>
 #include <LocalResourceStream.hpp>
 
 namespace rstudio {
@@ -61,27 +62,65 @@ bool signalJob(
    return !error;
 }
 
+/**
+ * @brief Checks whether a job was launched by the Local Plugin on another host. Such jobs are only visible through the
+ *        shared job journals, so they can't be controlled from this host.
+ *
+ * @param in_hostname           The name of this host.
+ * @param in_job                The job to check.
+ * @param in_messageDetail      The operation which was requested, for the status message.
+ * @param out_message           A message explaining that the job is running on another host, if it is.
+ *
+ * @return True if the job was launched on another host; false otherwise.
+ */
+bool isRemoteJob(
+   const std::string& in_hostname,
+   const api::JobPtr& in_job,
+   const std::string& in_messageDetail,
+   std::string& out_message)
+{
+   if (in_job->Host == in_hostname)
+      return false;
+
+   out_message = "Cannot " + in_messageDetail + " job " + in_job->Id + " because it is running on host " +
+      in_job->Host + ". It can only be controlled through the Local Plugin on that host.";
+   return true;
+}
+
 LocalJobSource::LocalJobSource(
    std::string in_hostname,
    jobs::JobStatusNotifierPtr in_jobStatusNotifier,
    std::shared_ptr<LocalJobRepository> in_jobRepository) :
       api::IJobSource(in_jobRepository, std::move(in_jobStatusNotifier)),
-      m_hostname(std::move(in_hostname))
+      m_hostname(std::move(in_hostname)),
+      m_jobRepo(in_jobRepository)
 {
    m_jobRunner.reset(new LocalJobRunner(m_hostname, m_jobStatusNotifier, in_jobRepository));
 }
 
 Error LocalJobSource::initialize()
 {
-   // TODO: Initialize communications with the other local plugins, if any.
+   // The jobs of other Local Plugin instances which share the scratch path are read from their job journals by the
+   // job repository, so no further communication with them is needed.
+   Error error = m_ipAddresses.initialize();
+   if (error)
+      return error;
+
    return m_jobRunner->initialize();
 }
 
 bool LocalJobSource::cancelJob(api::JobPtr in_job, bool& out_isComplete, std::string& out_statusMessage)
 {
    out_isComplete = false;
-   out_statusMessage = "The RStudio Local Launcher Plugin does not support canceling jobs.";
-   return false;
+   if (isRemoteJob(m_hostname, in_job, "cancel", out_statusMessage))
+      return true;
+
+   // Only jobs which are still waiting for resources haven't been started yet.
+   out_isComplete = m_jobRunner->cancelJob(in_job);
+   if (!out_isComplete)
+      out_statusMessage = "Job " + in_job->Id + " has already been started and can no longer be canceled.";
+
+   return true;
 }
 
 Error LocalJobSource::getConfiguration(const system::User&, api::JobSourceConfiguration& out_configuration) const
@@ -92,32 +131,40 @@ Error LocalJobSource::getConfiguration(const system::User&, api::JobSourceConfig
    out_configuration.CustomConfig.emplace_back(s_encryptedPassword, strType);
    out_configuration.CustomConfig.emplace_back(s_initializationVector, strType);
 
+   // Advertise the CPU and memory capacity of this host, if jobs are limited by it.
+   const LocalOptions& options = LocalOptions::getInstance();
+   if (options.getMaxCpus() > 0)
+      out_configuration.ResourceLimits.emplace_back(
+         api::ResourceLimit::Type::CPU_COUNT,
+         std::to_string(options.getMaxCpus()),
+         "1");
+   if (options.getMaxMemoryMb() > 0)
+      out_configuration.ResourceLimits.emplace_back(
+         api::ResourceLimit::Type::MEMORY,
+         std::to_string(options.getMaxMemoryMb()));
+
    return Success();
 }
 
 Error LocalJobSource::getNetworkInfo(api::JobPtr in_job, api::NetworkInfo& out_networkInfo) const
 {
-   using system::posix::IpAddress;
-   std::vector<IpAddress> addresses;
-   Error error = system::posix::getIpAddresses(addresses, true);
+   // Jobs from other hosts are read from their journals, so the addresses of this host don't apply to them.
+   Error error = (in_job->Host == m_hostname) ?
+      m_ipAddresses.getIpAddresses(out_networkInfo.IpAddresses) :
+      m_jobRepo->getPeerHostAddresses(in_job->Host, out_networkInfo.IpAddresses);
    if (error)
       return error;
 
    out_networkInfo.Hostname = in_job->Host;
-   for (const IpAddress& addr: addresses)
-   {
-      // Return all addresses except the loop-back and link local addresses.
-      if ((addr.Address.find("127") != 0) &&
-         (addr.Address.find("::1") != 0) &&
-         (addr.Address.find("%") == std::string::npos))
-         out_networkInfo.IpAddresses.push_back(addr.Address);
-   }
-
    return Success();
 }
 
 bool LocalJobSource::killJob(api::JobPtr in_job, bool& out_isComplete, std::string& out_statusMessage)
 {
+   out_isComplete = false;
+   if (isRemoteJob(m_hostname, in_job, "kill", out_statusMessage))
+      return true;
+
    out_isComplete = signalJob(in_job->Id, in_job->Pid, SIGKILL, "kill", out_statusMessage);
    if (out_isComplete)
       m_jobStatusNotifier->updateJob(in_job, api::Job::State::KILLED);
@@ -127,6 +174,10 @@ bool LocalJobSource::killJob(api::JobPtr in_job, bool& out_isComplete, std::stri
 
 bool LocalJobSource::resumeJob(api::JobPtr in_job, bool& out_isComplete, std::string& out_statusMessage)
 {
+   out_isComplete = false;
+   if (isRemoteJob(m_hostname, in_job, "resume", out_statusMessage))
+      return true;
+
    out_isComplete = signalJob(in_job->Id, in_job->Pid, SIGCONT, "resume", out_statusMessage);
    if (out_isComplete)
       m_jobStatusNotifier->updateJob(in_job, api::Job::State::RUNNING);
@@ -136,12 +187,20 @@ bool LocalJobSource::resumeJob(api::JobPtr in_job, bool& out_isComplete, std::st
 
 bool LocalJobSource::stopJob(api::JobPtr in_job, bool& out_isComplete, std::string& out_statusMessage)
 {
+   out_isComplete = false;
+   if (isRemoteJob(m_hostname, in_job, "stop", out_statusMessage))
+      return true;
+
    out_isComplete = signalJob(in_job->Id, in_job->Pid, SIGTERM, "stop", out_statusMessage);
    return true;
 }
 
 bool LocalJobSource::suspendJob(api::JobPtr in_job, bool& out_isComplete, std::string& out_statusMessage)
 {
+   out_isComplete = false;
+   if (isRemoteJob(m_hostname, in_job, "suspend", out_statusMessage))
+      return true;
+
    out_isComplete = signalJob(in_job->Id, in_job->Pid, SIGSTOP, "suspend", out_statusMessage);
    if (out_isComplete)
       m_jobStatusNotifier->updateJob(in_job, api::Job::State::SUSPENDED);
@@ -172,6 +231,14 @@ Error LocalJobSource::createResourceStream(
    comms::AbstractLauncherCommunicatorPtr in_launcherCommunicator,
    api::AbstractResourceStreamPtr& out_resourceStream)
 {
+   // Resource utilization is read from /proc, which only has the processes of this host.
+   if (in_job->Host != m_hostname)
+      return createError(
+         LocalError::UNSUPPORTED_OP,
+         "Cannot stream the resource utilization of job " + in_job->Id + " because it is running on host " +
+            in_job->Host + ".",
+         ERROR_LOCATION);
+
    out_resourceStream.reset(
       new LocalResourceStream(
          system::TimeDuration::Seconds(3),
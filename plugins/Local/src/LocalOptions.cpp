@@ -34,6 +34,16 @@ LocalOptions& LocalOptions::getInstance()
    return options;
 }
 
+size_t LocalOptions::getMaxCpus() const
+{
+   return m_maxCpus;
+}
+
+size_t LocalOptions::getMaxMemoryMb() const
+{
+   return m_maxMemoryMb;
+}
+
 size_t LocalOptions::getNodeConnectionTimeoutSeconds() const
 {
    return m_nodeConnectionTimeoutSeconds;
@@ -51,6 +61,14 @@ void LocalOptions::initialize()
    using namespace rstudio::launcher_plugins::options;
    Options& options = Options::getInstance();
    options.registerOptions()
+      ("max-cpus",
+       Value<size_t>(m_maxCpus).setDefaultValue(0),
+       "number of CPUs that may be requested by all running jobs combined, after which jobs wait for resources to "
+       "free up, or 0 for no limit")
+      ("max-memory-mb",
+       Value<size_t>(m_maxMemoryMb).setDefaultValue(0),
+       "amount of memory, in MB, that may be requested by all running jobs combined, after which jobs wait for "
+       "resources to free up, or 0 for no limit")
       ("node-connection-timeout-seconds",
        Value<size_t>(m_nodeConnectionTimeoutSeconds).setDefaultValue(3),
        "amount of seconds to allow for outgoing connections to other nodes in a load balanced cluster or 0 to use "
@@ -0,0 +1,149 @@
+/*
+ * LocalAdmissionQueueTests.cpp
+ *
+ * Copyright (C) 2020 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <TestMain.hpp>
+
+#include <Error.hpp>
+#include <api/Job.hpp>
+
+#include <LocalAdmissionQueue.hpp>
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace local {
+
+namespace {
+
+api::JobPtr makeJob(const std::string& in_id, const std::string& in_cpus)
+{
+   api::JobPtr job(new api::Job());
+   job->Id = in_id;
+
+   api::ResourceLimit cpuLimit(api::ResourceLimit::Type::CPU_COUNT);
+   cpuLimit.Value = in_cpus;
+   job->ResourceLimits.push_back(cpuLimit);
+
+   return job;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Release a 1 CPU job and a 0 CPU job")
+{
+   LocalAdmissionQueue queue(0, 0);
+
+   bool isAdmitted = false;
+   REQUIRE_FALSE(queue.submit(makeJob("1", "1"), isAdmitted));
+   CHECK(isAdmitted);
+   REQUIRE_FALSE(queue.submit(makeJob("2", "0"), isAdmitted));
+   CHECK(isAdmitted);
+
+   api::JobList admittedJobs;
+   queue.release("1", admittedJobs);
+   queue.release("2", admittedJobs);
+   CHECK(admittedJobs.empty());
+
+   REQUIRE_FALSE(queue.submit(makeJob("3", "1"), isAdmitted));
+   CHECK(isAdmitted);
+}
+
+TEST_CASE("Release a 0 CPU job and a 1 CPU job")
+{
+   LocalAdmissionQueue queue(0, 0);
+
+   bool isAdmitted = false;
+   REQUIRE_FALSE(queue.submit(makeJob("1", "0"), isAdmitted));
+   CHECK(isAdmitted);
+   REQUIRE_FALSE(queue.submit(makeJob("2", "1"), isAdmitted));
+   CHECK(isAdmitted);
+
+   api::JobList admittedJobs;
+   queue.release("1", admittedJobs);
+   queue.release("2", admittedJobs);
+   CHECK(admittedJobs.empty());
+}
+
+TEST_CASE("Release two 0 CPU jobs")
+{
+   LocalAdmissionQueue queue(0, 0);
+
+   bool isAdmitted = false;
+   REQUIRE_FALSE(queue.submit(makeJob("1", "0"), isAdmitted));
+   CHECK(isAdmitted);
+   REQUIRE_FALSE(queue.submit(makeJob("2", "0"), isAdmitted));
+   CHECK(isAdmitted);
+
+   api::JobList admittedJobs;
+   queue.release("1", admittedJobs);
+   queue.release("2", admittedJobs);
+   CHECK(admittedJobs.empty());
+}
+
+TEST_CASE("Mixed requests with a CPU limit")
+{
+   LocalAdmissionQueue queue(2, 0);
+
+   bool isAdmitted = false;
+   REQUIRE_FALSE(queue.submit(makeJob("1", "0"), isAdmitted));
+   CHECK(isAdmitted);
+   REQUIRE_FALSE(queue.submit(makeJob("2", "1"), isAdmitted));
+   CHECK(isAdmitted);
+   REQUIRE_FALSE(queue.submit(makeJob("3", "1"), isAdmitted));
+   CHECK(isAdmitted);
+   REQUIRE_FALSE(queue.submit(makeJob("4", "1"), isAdmitted));
+   CHECK_FALSE(isAdmitted);
+
+   // Releasing the 0 CPU job doesn't free anything for the waiting job.
+   api::JobList admittedJobs;
+   queue.release("1", admittedJobs);
+   CHECK(admittedJobs.empty());
+
+   queue.release("2", admittedJobs);
+   REQUIRE(admittedJobs.size() == 1);
+   CHECK(admittedJobs[0]->Id == "4");
+
+   admittedJobs.clear();
+   queue.release("3", admittedJobs);
+   queue.release("4", admittedJobs);
+   CHECK(admittedJobs.empty());
+
+   REQUIRE_FALSE(queue.submit(makeJob("5", "2"), isAdmitted));
+   CHECK(isAdmitted);
+}
+
+TEST_CASE("Release a reserved 0 CPU job after a 1 CPU job")
+{
+   LocalAdmissionQueue queue(0, 0);
+
+   queue.reserve(makeJob("1", "1"));
+   queue.reserve(makeJob("2", "0"));
+
+   api::JobList admittedJobs;
+   queue.release("1", admittedJobs);
+   queue.release("2", admittedJobs);
+   CHECK(admittedJobs.empty());
+}
+
+} // namespace local
+} // namespace launcher_plugins
+} // namespace rstudio
@@ -0,0 +1,93 @@
+/*
+ * LocalClusterJobIndexTests.cpp
+ *
+ * Copyright (C) 2020 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <TestMain.hpp>
+
+#include <unistd.h>
+
+#include <Error.hpp>
+#include <system/FilePath.hpp>
+
+#include <LocalClusterJobIndex.hpp>
+#include <LocalError.hpp>
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace local {
+
+TEST_CASE("Host addresses")
+{
+   system::FilePath jobsRoot("/tmp/rlps-cluster-index-tests-" + std::to_string(::getpid()));
+   REQUIRE_FALSE(jobsRoot.ensureDirectory());
+   REQUIRE_FALSE(jobsRoot.completeChildPath("thishost").ensureDirectory());
+   REQUIRE_FALSE(jobsRoot.completeChildPath("localhost").ensureDirectory());
+   REQUIRE_FALSE(jobsRoot.completeChildPath("rlps-no-such-host.invalid").ensureDirectory());
+
+   LocalClusterJobIndex index(jobsRoot, "thishost");
+
+   SECTION("Not resolved before the first refresh")
+   {
+      std::vector<std::string> addresses;
+      Error error = index.getHostAddresses("localhost", addresses);
+      CHECK(error);
+      CHECK(error.getCode() == static_cast<int>(LocalError::HOST_LOOKUP_ERROR));
+      CHECK(addresses.empty());
+   }
+
+   SECTION("Resolved by refresh")
+   {
+      PeerJobChangesList changes;
+      REQUIRE_FALSE(index.refresh(1024, changes));
+
+      std::vector<std::string> addresses;
+      REQUIRE_FALSE(index.getHostAddresses("localhost", addresses));
+      CHECK_FALSE(addresses.empty());
+
+      // The host's own journal is ignored, so its addresses are never looked up.
+      addresses.clear();
+      Error error = index.getHostAddresses("thishost", addresses);
+      CHECK(error.getCode() == static_cast<int>(LocalError::HOST_LOOKUP_ERROR));
+      CHECK(addresses.empty());
+
+      error = index.getHostAddresses("rlps-no-such-host.invalid", addresses);
+      CHECK(error.getCode() == static_cast<int>(LocalError::HOST_LOOKUP_ERROR));
+      CHECK(addresses.empty());
+   }
+
+   SECTION("Forgotten when the host is removed")
+   {
+      PeerJobChangesList changes;
+      REQUIRE_FALSE(index.refresh(1024, changes));
+      REQUIRE_FALSE(jobsRoot.completeChildPath("localhost").remove());
+      REQUIRE_FALSE(index.refresh(1024, changes));
+
+      std::vector<std::string> addresses;
+      CHECK(index.getHostAddresses("localhost", addresses));
+   }
+
+   CHECK_FALSE(jobsRoot.remove());
+}
+
+} // namespace local
+} // namespace launcher_plugins
+} // namespace rstudio
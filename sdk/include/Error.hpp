@@ -96,6 +96,9 @@ public:
    /**
     * @brief Constructor.
     *
+    * The function and file names are not copied, so they must outlive the location. ERROR_LOCATION passes string
+    * literals, which always do.
+    *
     * @param in_function    The function in which the error occurred.
     * @param in_file        The file in which the error occurred.
     * @param in_line        The line at which the error occurred.
@@ -132,14 +135,14 @@ public:
     *
     * @return The file where the error occurred.
     */
-   const std::string& getFile() const;
+   std::string getFile() const;
 
    /**
     * @brief Gets the function where the error occurred.
     *
     * @return The function where the error occurred.
     */
-   const std::string& getFunction() const;
+   std::string getFunction() const;
 
    /**
     * @brief Gets the line where the error occurred.
@@ -156,8 +159,14 @@ public:
    bool hasLocation() const;
 
 private:
-   // The private implementation of ErrorLocation.
-   PRIVATE_IMPL(m_impl);
+   // The function in which the error occurred.
+   const char* m_function;
+
+   // The file in which the error occurred.
+   const char* m_file;
+
+   // The line at which the error occurred.
+   long m_line;
 };
 
 /**
@@ -175,7 +184,7 @@ class Error : public virtual ErrorLock
 {
 public:
    /**
-    * @brief Constructor.
+    * @brief Constructor. Creates a success, which does not allocate.
     */
    Error();
 
@@ -186,6 +195,31 @@ public:
     */
    Error(const Error& in_other);
 
+   /**
+    * @brief Move constructor.
+    *
+    * @param in_other   The error to move to this error.
+    */
+   Error(Error&& in_other) noexcept;
+
+   /**
+    * @brief Assignment operator.
+    *
+    * @param in_other   The error to copy to this error.
+    *
+    * @return A reference to this error.
+    */
+   Error& operator=(const Error& in_other);
+
+   /**
+    * @brief Move assignment operator.
+    *
+    * @param in_other   The error to move to this error.
+    *
+    * @return A reference to this error.
+    */
+   Error& operator=(Error&& in_other) noexcept;
+
    /**
     * @brief Constructor.
     *
@@ -424,11 +458,20 @@ private:
    PRIVATE_IMPL_SHARED(m_impl);
 
    /**
-    * @brief Gets a reference to the private implementation member.
+    * @brief Gets a reference to the private implementation member. A success, which has no private implementation,
+    *        shares a single empty one.
+    *
+    * @return A reference to the private implementation member.
+    */
+   const Impl& impl() const;
+
+   /**
+    * @brief Gets a reference to a private implementation member which is not shared with any other error, creating it
+    *        if necessary.
     *
     * @return A reference to the private implementation member.
     */
-   Impl& impl() const;
+   Impl& mutableImpl();
 };
 
 /**
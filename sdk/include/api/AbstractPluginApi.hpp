@@ -62,6 +62,20 @@ public:
     */
    Error initialize();
 
+   /**
+    * @brief This method shuts down the abstract plugin API. It should be invoked after the communicator and the
+    *        thread pool have stopped, so that no further job changes can occur.
+    */
+   void shutdown();
+
+   /**
+    * @brief This method reloads the configuration of the Job Source. It should be invoked after the options have
+    *        been reloaded.
+    *
+    * @return Success if the configuration of the Job Source could be reloaded; Error otherwise.
+    */
+   Error reloadConfiguration();
+
 protected:
    /**
     * @brief Constructor.
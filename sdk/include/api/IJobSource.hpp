@@ -171,6 +171,18 @@ public:
     */
    virtual bool killJob(JobPtr in_job, bool& out_isComplete, std::string& out_statusMessage) = 0;
 
+   /**
+    * @brief Reloads any configuration of the Job Source which may change while the Plugin is running, such as its user
+    *        profiles.
+    *
+    * This method is invoked when the Plugin receives SIGHUP, after the Plugin's options have been reloaded. If an
+    * error is returned, the Job Source should continue to use its previous configuration. The default implementation
+    * does nothing.
+    *
+    * @return Success if the configuration could be reloaded; Error otherwise.
+    */
+   virtual Error reloadConfiguration() { return Success(); }
+
    /**
     * @brief Resumes a suspended job.
     *
@@ -61,6 +61,13 @@ public:
     */
    virtual ~Response() = default;
 
+   /**
+    * @brief Gets the ID of the request for which this response is being sent.
+    *
+    * @return The ID of the request for which this response is being sent.
+    */
+   uint64_t getRequestId() const;
+
    /**
     * @brief Converts this response to a JSON object.
     *
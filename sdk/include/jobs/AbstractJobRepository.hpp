@@ -111,6 +111,11 @@ public:
     */
    void removeJob(const std::string& in_jobId);
 
+   /**
+    * @brief Shuts down the AbstractJobRepository. Jobs should not be added, updated, or removed after this is invoked.
+    */
+   void shutdown();
+
 private:
    /**
     * @brief Responsible for loading any jobs which were in the system when the Plugin started.
@@ -137,6 +142,16 @@ private:
     */
    virtual void onJobRemoved(const api::JobPtr& in_job);
 
+   /**
+    * @brief Allows inheriting classes to perform custom actions when the status of a job which is already in the
+    *        repository is updated.
+    *
+    * The job lock will be held when this method is invoked. The repository lock will not be held.
+    *
+    * @param in_job     The job that was updated.
+    */
+   virtual void onJobUpdated(const api::JobPtr& in_job);
+
    /**
     * @brief Allows inheriting classes to perform custom initialization actions when the repository is created.
     *
@@ -144,6 +159,12 @@ private:
     */
    virtual Error onInitialize();
 
+   /**
+    * @brief Allows inheriting classes to perform custom actions when the repository is shut down, such as persisting
+    *        any changes which have not yet been written.
+    */
+   virtual void onShutdown();
+
    // The private implementation of AbstractJobRepository.
    PRIVATE_IMPL(m_impl);
 };
@@ -275,6 +275,10 @@ private:
 
 /**
  * @brief Class which allows sending log messages to a file.
+ *
+ * The log file is kept open and messages are buffered. Warnings and errors are written immediately; other messages are
+ * written once enough of them have been buffered, or within about a second. If another process rotates or removes the
+ * log file, the new file is opened the next time messages are written.
  */
 class FileLogDestination : public ILogDestination
 {
@@ -303,7 +307,7 @@ public:
       bool in_reloadable = false);
 
    /**
-    * @brief Destructor.
+    * @brief Destructor. Writes any buffered messages to the log file.
     */
    ~FileLogDestination() override;
 
@@ -76,6 +76,15 @@ public:
     */
    LogLevel getLogLevel() { return m_logLevel; }
 
+   /**
+    * @brief Sets the maximum level of logs that will be written to this log destination.
+    *
+    * Once the log destination has been added to the logger, use logging::setLogDestinationLevel instead.
+    *
+    * @param in_logLevel    The new maximum log level of this log destination.
+    */
+   void setLogLevel(LogLevel in_logLevel) { m_logLevel = in_logLevel; }
+
    /**
     * @brief Gets the log message format type for this log destination.
     *
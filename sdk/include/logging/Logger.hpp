@@ -24,6 +24,7 @@
 #ifndef LAUNCHER_PLUGINS_LOGGER_HPP
 #define LAUNCHER_PLUGINS_LOGGER_HPP
 
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <ostream>
@@ -34,6 +35,7 @@
 #include <boost/function.hpp>
 #include <Optional.hpp>
 
+#include <system/DateTime.hpp>
 #include <system/User.hpp>
 
 #include <PImpl.hpp>
@@ -110,6 +112,86 @@ enum class LogMessageFormatType
    JSON   = 1    // A JSON format, one JSON object per line
 };
 
+/**
+ * @enum AsyncLogOverflowPolicy
+ * @brief Enum which represents what to do with a log message when the asynchronous log queue is full.
+ */
+enum class AsyncLogOverflowPolicy
+{
+   BLOCK       = 0,   // Wait until the log writer thread makes room for the message.
+   DROP_DEBUG  = 1,   // Drop debug messages, and wait until there is room for any other message.
+   DROP        = 2    // Drop the message.
+};
+
+/**
+ * @brief Limits how many messages are written by a single log call site.
+ *
+ * Up to a fixed number of messages are written in each interval. Further messages in the same interval are suppressed,
+ * except that one of every few suppressed messages may be sampled. The number of messages that were suppressed since
+ * the last message that was written is reported with the next message that is written. If no message is written once
+ * the interval ends, the count is reported on its own by the next call to reportSuppressedMessages.
+ *
+ * This class is thread-safe and does not lock. See also the LOG_RATE_LIMITED macro, which declares a rate limiter for
+ * the call site.
+ */
+class LogRateLimiter
+{
+public:
+   /**
+    * @brief Constructor.
+    *
+    * @param in_maxMessages     The maximum number of messages to write in each interval.
+    * @param in_interval        The length of an interval.
+    * @param in_sampleRate      If not 0, one of every in_sampleRate messages beyond the maximum is written anyway.
+    */
+   LogRateLimiter(size_t in_maxMessages, const system::TimeDuration& in_interval, size_t in_sampleRate = 0);
+
+   /**
+    * @brief Constructor.
+    *
+    * @param in_maxMessages     The maximum number of messages to write in each interval.
+    * @param in_interval        The length of an interval.
+    * @param in_sampleRate      If not 0, one of every in_sampleRate messages beyond the maximum is written anyway.
+    * @param in_logLevel        The log level at which to report suppressed messages on their own.
+    * @param in_location        The location of the rate limited call site.
+    */
+   LogRateLimiter(
+      size_t in_maxMessages,
+      const system::TimeDuration& in_interval,
+      size_t in_sampleRate,
+      LogLevel in_logLevel,
+      const ErrorLocation& in_location);
+
+   /**
+    * @brief Destructor.
+    */
+   ~LogRateLimiter();
+
+   /**
+    * @brief Writes a record of the messages which each rate limiter has suppressed since it last wrote a message, once
+    *        the interval in which they were suppressed has ended.
+    *
+    * Without this, the messages suppressed at the end of a burst would only be reported when the call site next logs.
+    *
+    * @param in_force       Whether to report suppressed messages even if their interval has not ended yet.
+    */
+   static void reportSuppressedMessages(bool in_force = false);
+
+   /**
+    * @brief Checks whether a message should be written, and counts it as suppressed if not.
+    *
+    * @param out_suppressedCount    The number of messages which were suppressed since the last message that was
+    *                               written, if this message should be written.
+    *
+    * @return True if the message should be written; false if it should be suppressed.
+    */
+   bool tryAcquire(uint64_t& out_suppressedCount);
+
+private:
+   // The private implementation of LogRateLimiter.
+   PRIVATE_IMPL(m_impl);
+};
+
 /**
  * @brief Helper function which cleans the log delimiter character from a string.
  *
@@ -148,6 +230,35 @@ void addLogDestination(const std::shared_ptr<ILogDestination>& in_destination);
  */
 void addLogDestination(const std::shared_ptr<ILogDestination>& in_destination, const std::string& in_section);
 
+/**
+ * @brief Disables asynchronous logging, if it was enabled.
+ *
+ * All queued messages are written before this function returns.
+ */
+void disableAsyncLogging();
+
+/**
+ * @brief Enables asynchronous logging.
+ *
+ * Messages are formatted on the thread that logs them and then queued. A dedicated thread writes the queued messages to
+ * the log destinations in batches, so threads which log messages do not wait on the log destinations. Messages which
+ * are logged by the log writer thread itself, or by a forked child process, are still written immediately.
+ *
+ * If asynchronous logging is already enabled, the queued messages are written and the queue is replaced.
+ *
+ * @param in_queueCapacity      The maximum number of messages which may be waiting to be written. Rounded up to a
+ *                              power of two.
+ * @param in_overflowPolicy     What to do with a message that is logged while the queue is full.
+ */
+void enableAsyncLogging(size_t in_queueCapacity, AsyncLogOverflowPolicy in_overflowPolicy);
+
+/**
+ * @brief Gets the number of log messages which have been dropped because the asynchronous log queue was full.
+ *
+ * @return The number of log messages which have been dropped.
+ */
+uint64_t getDroppedLogMessageCount();
+
 /**
  * @brief Returns whether or not a file log destination is configured.
  *
@@ -169,6 +280,19 @@ bool hasStderrLogDestination();
  */
 bool isLogLevel(logging::LogLevel level);
 
+/**
+ * @brief Checks whether a message of the specified level would be written by any registered log destination.
+ *
+ * This check does not lock, so it may be used to avoid building log messages which would be discarded. See also the
+ * LOG_DEBUG_MESSAGE and LOG_INFO_MESSAGE macros.
+ *
+ * @param in_logLevel   The log level of the message.
+ * @param in_section    The section of the log that the message belongs in. Default: no section.
+ *
+ * @return True if a message of the specified level would be written; false otherwise.
+ */
+bool isLogLevelEnabled(LogLevel in_logLevel, const std::string& in_section = std::string());
+
 /**
  * @brief Replaces logging delimiters with ' ' in the specified string.
  *
@@ -394,6 +518,34 @@ void logInfoMessage(const std::string& in_message,
                     const Optional<LogMessageProperties>& in_properties,
                     const ErrorLocation& in_loggedFrom);
 
+/**
+ * @brief Logs an error to all registered destinations, unless the rate limiter suppresses it.
+ *
+ * If any errors were suppressed since the last error that was written by this rate limiter, the count is added to the
+ * error as the "suppressedErrors" property.
+ *
+ * @param io_rateLimiter    The rate limiter of the call site.
+ * @param in_error          The error to log.
+ */
+void logErrorRateLimited(LogRateLimiter& io_rateLimiter, const Error& in_error);
+
+/**
+ * @brief Logs a message that a LogRateLimiter allowed to all registered destinations.
+ *
+ * If any messages were suppressed since the last message that was written by the rate limiter, the count is logged
+ * with the message as the "suppressedMessages" property.
+ *
+ * @param in_logLevel           The log level of the message.
+ * @param in_message            The message to log.
+ * @param in_suppressedCount    The suppressed count returned by LogRateLimiter::tryAcquire.
+ * @param in_loggedFrom         The location from which the message was logged.
+ */
+void logRateLimitedMessage(
+   LogLevel in_logLevel,
+   const std::string& in_message,
+   uint64_t in_suppressedCount,
+   const ErrorLocation& in_loggedFrom);
+
 /**
  * @brief Logs an entire log message as is with an annotation indicating it came from source.
  *
@@ -429,6 +581,16 @@ void removeLogDestination(const std::string& in_destinationId, const std::string
  */
 void removeReloadableLogDestinations();
 
+/**
+ * @brief Changes the maximum level of log messages written to a registered log destination.
+ *
+ * If a log destination does not exist with the given ID, no log level will be changed.
+ *
+ * @param in_destinationId   The ID of the destination to change.
+ * @param in_logLevel        The new maximum level of log messages to write to the destination.
+ */
+void setLogDestinationLevel(const std::string& in_destinationId, LogLevel in_logLevel);
+
 /**
  * @brief Writes an error to the specified output stream.
  *
@@ -451,4 +613,54 @@ std::string writeError(const Error& in_error);
 } // namespace launcher_plugins
 } // namespace rstudio
 
+/**
+ * @brief Logs a debug message without a section. The arguments, which are the same as those of logDebugMessage, are only
+ *        evaluated if debug messages are enabled.
+ */
+#define LOG_DEBUG_MESSAGE(...)                                                                                        \
+   do                                                                                                                 \
+   {                                                                                                                  \
+      if (rstudio::launcher_plugins::logging::isLogLevelEnabled(rstudio::launcher_plugins::logging::LogLevel::DEBUG)) \
+         rstudio::launcher_plugins::logging::logDebugMessage(__VA_ARGS__);                                            \
+   } while (false)
+
+/**
+ * @brief Logs an info message without a section. The arguments, which are the same as those of logInfoMessage, are only
+ *        evaluated if info messages are enabled.
+ */
+#define LOG_INFO_MESSAGE(...)                                                                                        \
+   do                                                                                                                \
+   {                                                                                                                 \
+      if (rstudio::launcher_plugins::logging::isLogLevelEnabled(rstudio::launcher_plugins::logging::LogLevel::INFO)) \
+         rstudio::launcher_plugins::logging::logInfoMessage(__VA_ARGS__);                                            \
+   } while (false)
+
+
+/**
+ * @brief Logs a message without a section from this call site at most in_maxMessages times every in_intervalSeconds
+ *        seconds. The message is only constructed if it is enabled and not suppressed.
+ */
+#define LOG_RATE_LIMITED(in_logLevel, in_maxMessages, in_intervalSeconds, in_message)                               \
+   do                                                                                                               \
+   {                                                                                                                \
+      if (rstudio::launcher_plugins::logging::isLogLevelEnabled(in_logLevel))                                       \
+      {                                                                                                             \
+         static rstudio::launcher_plugins::logging::LogRateLimiter s_logRateLimiter(                                \
+            in_maxMessages,                                                                                         \
+            rstudio::launcher_plugins::system::TimeDuration::Seconds(in_intervalSeconds),                           \
+            0,                                                                                                      \
+            in_logLevel,                                                                                            \
+            ERROR_LOCATION);                                                                                        \
+         uint64_t suppressedCount = 0;                                                                              \
+         if (s_logRateLimiter.tryAcquire(suppressedCount))                                                          \
+         {                                                                                                          \
+            rstudio::launcher_plugins::logging::logRateLimitedMessage(                                              \
+               in_logLevel,                                                                                         \
+               in_message,                                                                                          \
+               suppressedCount,                                                                                     \
+               ERROR_LOCATION);                                                                                     \
+         }                                                                                                          \
+      }                                                                                                             \
+   } while (false)
+
 #endif
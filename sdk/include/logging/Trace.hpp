@@ -0,0 +1,146 @@
+/*
+ * Trace.hpp
+ * 
+ * Copyright (C) 2022 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef LAUNCHER_PLUGINS_TRACE_HPP
+#define LAUNCHER_PLUGINS_TRACE_HPP
+
+#include <Noncopyable.hpp>
+
+#include <cstdint>
+#include <string>
+
+#include <PImpl.hpp>
+
+namespace rstudio {
+namespace launcher_plugins {
+
+class Error;
+
+namespace system {
+
+class FilePath;
+
+} // namespace system
+} // namespace launcher_plugins
+} // namespace rstudio
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace logging {
+
+/**
+ * @file
+ * In-process tracing of the time spent handling requests.
+ *
+ * Completed spans are recorded in a fixed size ring buffer owned by the thread which ended them, so recording a span
+ * never contends with other threads. When a buffer is full, the oldest span of that thread is overwritten. The spans
+ * of all threads may be written to a file in the Chrome trace event format, which can be viewed with chrome://tracing
+ * or https://ui.perfetto.dev.
+ */
+
+/**
+ * @brief Measures the time spent in a single step of handling a request, from construction until it is ended or
+ *        destroyed.
+ *
+ * If tracing is not enabled when the span is constructed, the span does nothing and costs no more than checking
+ * whether tracing is enabled.
+ */
+class TraceSpan : public Noncopyable
+{
+public:
+   /**
+    * @brief Constructor. Starts the span.
+    *
+    * @param in_name        The name of the span. This must be a string literal, or otherwise outlive the process.
+    * @param in_requestId   The ID of the request for which this span is being recorded, or 0 if there is none.
+    * @param in_jobId       The ID of the job for which this span is being recorded, if any.
+    */
+   explicit TraceSpan(const char* in_name, uint64_t in_requestId = 0, const std::string& in_jobId = "");
+
+   /**
+    * @brief Destructor. Ends the span, if it has not already been ended.
+    */
+   ~TraceSpan();
+
+   /**
+    * @brief Ends the span and records it in the trace buffer of the calling thread. Subsequent calls have no effect.
+    */
+   void end();
+
+   /**
+    * @brief Sets the ID of the job for which this span is being recorded, for spans which start before the job ID is
+    *        known.
+    *
+    * @param in_jobId       The ID of the job for which this span is being recorded.
+    */
+   void setJobId(const std::string& in_jobId);
+
+   /**
+    * @brief Sets the ID of the request for which this span is being recorded, for spans which start before the request
+    *        ID is known.
+    *
+    * @param in_requestId   The ID of the request for which this span is being recorded.
+    */
+   void setRequestId(uint64_t in_requestId);
+
+private:
+   // The private implementation of TraceSpan.
+   PRIVATE_IMPL(m_impl);
+};
+
+/**
+ * @brief Stops recording trace spans and discards all recorded spans.
+ */
+void disableTracing();
+
+/**
+ * @brief Starts recording trace spans.
+ *
+ * If tracing was already enabled with a different number of spans per thread, all recorded spans are discarded.
+ *
+ * @param in_spansPerThread     The maximum number of completed spans to keep for each thread. Must be greater than 0.
+ */
+void enableTracing(size_t in_spansPerThread);
+
+/**
+ * @brief Checks whether trace spans are being recorded.
+ *
+ * @return True if trace spans are being recorded; false otherwise.
+ */
+bool isTracingEnabled();
+
+/**
+ * @brief Writes all currently recorded spans to a file in the Chrome trace event format, replacing the contents of the
+ *        file. Recorded spans are not discarded.
+ *
+ * @param in_traceFile      The file to which the spans should be written.
+ *
+ * @return Success if the spans could be written; Error otherwise.
+ */
+Error writeTrace(const system::FilePath& in_traceFile);
+
+} // namespace logging
+} // namespace launcher_plugins
+} // namespace rstudio
+
+#endif
@@ -73,6 +73,9 @@ public:
    /**
     * @brief Initializes the user profiles. Must be called before attempting to retrieve configuration values.
     *
+    * May be called again to reload the user profiles file. If the file cannot be read or is invalid, the previously
+    * loaded values remain in use.
+    *
     * @return Success if the user profiles file could be opened for read and parsed; Error otherwise.
     */
    Error initialize();
@@ -195,6 +195,33 @@ public:
     */
    Error readOptions(int in_argc, const char* const in_argv[], const system::FilePath& in_location);
 
+   /**
+    * @brief Reads the option file and command line arguments which were passed to readOptions again.
+    *
+    * All options are validated, but only the values of log-level, enable-debug-logging, job-expiry-hours, and
+    * user-cache-ttl-seconds are changed. Other options, including those registered by the plugin, keep the values
+    * they were read with until the plugin is restarted. If any option is invalid, no values are changed.
+    *
+    * The reloadable values may be read from any thread without locking.
+    *
+    * @return Success if all required options were read and no parsing errors occurred; Error otherwise.
+    */
+   Error reloadOptions();
+
+   /**
+    * @brief Gets what to do with a log message when the asynchronous log queue is full.
+    *
+    * @return What to do with a log message when the asynchronous log queue is full.
+    */
+   logging::AsyncLogOverflowPolicy getAsyncLogOverflowPolicy() const;
+
+   /**
+    * @brief Gets the maximum number of log messages which may be waiting to be written by the log writer thread.
+    *
+    * @return The maximum number of queued log messages, or 0 if log messages should be written synchronously.
+    */
+   size_t getAsyncLogQueueSize() const;
+
    /**
     * @brief Gets the number of hours after which finished jobs expire and should be pruned from the plugin.
     *
@@ -288,6 +315,36 @@ public:
     */
    size_t getThreadPoolSize() const;
 
+   /**
+    * @brief Gets the number of completed trace spans to keep for each thread.
+    *
+    * @return The number of completed trace spans to keep for each thread, or 0 if tracing is disabled.
+    */
+   size_t getTraceBufferSize() const;
+
+   /**
+    * @brief Gets the number of seconds between writes of the trace file.
+    *
+    * @return The number of seconds between writes of the trace file, or 0 if the trace file should only be written on
+    *         request.
+    */
+   system::TimeDuration getTraceDumpIntervalSeconds() const;
+
+   /**
+    * @brief Gets the amount of time to cache looked up system users.
+    *
+    * @return The amount of time to cache looked up system users, or 0 if they should not be cached.
+    */
+   system::TimeDuration getUserCacheTtlSeconds() const;
+
+   /**
+    * @brief Gets whether each thread in the thread pool should run work from its own queue.
+    *
+    * @return True if each thread in the thread pool should run work from its own queue; false if all threads should
+    *         share a single queue.
+    */
+   bool useIoContextPerThread() const;
+
    /**
     * @brief Gets whether the plugin should run in single-user unprivileged mode.
     *
@@ -26,7 +26,11 @@
 
 #include <Noncopyable.hpp>
 
+#include <cstddef>
 #include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 #include <PImpl.hpp>
 #include <utils/Functionals.hpp>
@@ -54,6 +58,202 @@ typedef std::function<void(const char*, size_t)> OnReadBytes;
  */
 typedef std::function<void(int)> OnSignal;
 
+/**
+ * @enum AsioThreadModel
+ * @brief How the worker threads of the ASIO service share work.
+ */
+enum class AsioThreadModel
+{
+   /** All worker threads run work from a single shared queue. */
+   SHARED_CONTEXT,
+
+   /**
+    * Each worker thread runs work from its own queue. Posted work is distributed between the threads, and each stream
+    * and timer is pinned to one thread when it is created.
+    */
+   CONTEXT_PER_THREAD
+};
+
+/**
+ * @brief A move-only job which may be posted to the AsioService.
+ *
+ * Small callables which can be moved without throwing are stored inside the task itself, so creating, posting, and
+ * running the task does not allocate. Larger callables are stored on the heap.
+ */
+class AsioTask final
+{
+public:
+   /**
+    * @brief Constructor.
+    *
+    * @tparam F             The type of the callable to run. It must be invocable with no arguments.
+    *
+    * @param in_callable    The callable to run.
+    */
+   template <
+      typename F,
+      typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, AsioTask>::value>::type>
+   explicit AsioTask(F&& in_callable)
+   {
+      typedef typename std::decay<F>::type Callable;
+      init<Callable>(std::forward<F>(in_callable), std::integral_constant<bool, fitsInline<Callable>()>());
+   }
+
+   /**
+    * @brief Move constructor.
+    *
+    * @param in_other   The task to move into this task. It may not be run afterwards.
+    */
+   AsioTask(AsioTask&& in_other) noexcept :
+      m_operations(in_other.m_operations)
+   {
+      if (m_operations != nullptr)
+      {
+         m_operations->Move(&m_storage, &in_other.m_storage);
+         in_other.m_operations = nullptr;
+      }
+   }
+
+   /**
+    * @brief Destructor.
+    */
+   ~AsioTask()
+   {
+      if (m_operations != nullptr)
+         m_operations->Destroy(&m_storage);
+   }
+
+   AsioTask(const AsioTask&) = delete;
+   AsioTask& operator=(const AsioTask&) = delete;
+   AsioTask& operator=(AsioTask&&) = delete;
+
+   /**
+    * @brief Runs the task.
+    */
+   void operator()()
+   {
+      m_operations->Invoke(&m_storage);
+   }
+
+   /**
+    * @brief Checks whether a callable of the specified type is stored inside the task, rather than on the heap.
+    *
+    * @tparam Callable      The type of the callable.
+    *
+    * @return True if a callable of the specified type is stored inside the task; false otherwise.
+    */
+   template <typename Callable>
+   static constexpr bool fitsInline()
+   {
+      return (sizeof(Callable) <= INLINE_SIZE) &&
+         (alignof(Callable) <= alignof(std::max_align_t)) &&
+         std::is_nothrow_move_constructible<Callable>::value;
+   }
+
+private:
+   /** The maximum size of a callable which is stored inside the task. */
+   static constexpr size_t INLINE_SIZE = 64;
+
+   /**
+    * @brief The operations on the stored callable.
+    */
+   struct Operations
+   {
+      /** Runs the stored callable. */
+      void (*Invoke)(void*);
+
+      /** Moves the stored callable from the second storage into the first, and destroys the original. */
+      void (*Move)(void*, void*);
+
+      /** Destroys the stored callable. */
+      void (*Destroy)(void*);
+   };
+
+   /**
+    * @brief The operations on a callable which is stored inside the task.
+    */
+   template <typename Callable>
+   struct InlineOperations
+   {
+      static void invoke(void* in_storage)
+      {
+         (*static_cast<Callable*>(in_storage))();
+      }
+
+      static void move(void* out_storage, void* in_storage)
+      {
+         Callable* source = static_cast<Callable*>(in_storage);
+         new (out_storage) Callable(std::move(*source));
+         source->~Callable();
+      }
+
+      static void destroy(void* in_storage)
+      {
+         static_cast<Callable*>(in_storage)->~Callable();
+      }
+
+      static const Operations s_operations;
+   };
+
+   /**
+    * @brief The operations on a callable which is stored on the heap. The task stores a pointer to the callable.
+    */
+   template <typename Callable>
+   struct HeapOperations
+   {
+      static void invoke(void* in_storage)
+      {
+         (**static_cast<Callable**>(in_storage))();
+      }
+
+      static void move(void* out_storage, void* in_storage)
+      {
+         *static_cast<Callable**>(out_storage) = *static_cast<Callable**>(in_storage);
+      }
+
+      static void destroy(void* in_storage)
+      {
+         delete *static_cast<Callable**>(in_storage);
+      }
+
+      static const Operations s_operations;
+   };
+
+   template <typename Callable, typename F>
+   void init(F&& in_callable, std::true_type)
+   {
+      new (&m_storage) Callable(std::forward<F>(in_callable));
+      m_operations = &InlineOperations<Callable>::s_operations;
+   }
+
+   template <typename Callable, typename F>
+   void init(F&& in_callable, std::false_type)
+   {
+      *reinterpret_cast<Callable**>(&m_storage) = new Callable(std::forward<F>(in_callable));
+      m_operations = &HeapOperations<Callable>::s_operations;
+   }
+
+   /** The storage for the callable, or for a pointer to it. */
+   typename std::aligned_storage<INLINE_SIZE, alignof(std::max_align_t)>::type m_storage;
+
+   /** The operations on the stored callable, or nullptr if the callable was moved out of this task. */
+   const Operations* m_operations;
+};
+
+template <typename Callable>
+const AsioTask::Operations AsioTask::InlineOperations<Callable>::s_operations = {
+   &AsioTask::InlineOperations<Callable>::invoke,
+   &AsioTask::InlineOperations<Callable>::move,
+   &AsioTask::InlineOperations<Callable>::destroy
+};
+
+template <typename Callable>
+const AsioTask::Operations AsioTask::HeapOperations<Callable>::s_operations = {
+   &AsioTask::HeapOperations<Callable>::invoke,
+   &AsioTask::HeapOperations<Callable>::move,
+   &AsioTask::HeapOperations<Callable>::destroy
+};
+
 /**
  * @brief Async input/output class which may be used to manage ASIO operations.
  */
@@ -64,15 +264,40 @@ public:
    /**
     * @brief Posts a job to be completed by this ASIO Service.
     *
+    * The job is moved into an AsioTask and handed to ASIO directly, so posting a small job does not allocate.
+    *
+    * @tparam F         The type of the job. It must be invocable with no arguments.
+    *
+    * @param in_work    The job to be posted to the ASIO Service.
+    */
+   template <typename F>
+   static void post(F&& in_work)
+   {
+      postTask(AsioTask(std::forward<F>(in_work)));
+   }
+
+   /**
+    * @brief Posts a job to be completed by this ASIO Service, on the queue selected by the specified key.
+    *
+    * Jobs posted with the same key are always run from the same queue. With AsioThreadModel::CONTEXT_PER_THREAD, this
+    * means they are run one at a time, in the order they were posted.
+    *
+    * @tparam F         The type of the job. It must be invocable with no arguments.
+    *
+    * @param in_key     The key which selects the queue on which the job will be run.
     * @param in_work    The job to be posted to the ASIO Service.
     */
-   static void post(const AsioFunction& in_work);
+   template <typename F>
+   static void post(size_t in_key, F&& in_work)
+   {
+      postTask(in_key, AsioTask(std::forward<F>(in_work)));
+   }
 
    /**
     * @brief Sets the signal handler on the ASIO service.
     *
-    * The ASIO service will manage signals sent to the process. The signal handler provided here will be invoked when a
-    * signal is received.
+    * The ASIO service will manage the SIGTERM, SIGINT, SIGUSR1, and SIGHUP signals sent to the process. The signal
+    * handler provided here will be invoked each time one of those signals is received.
     *
     * @param in_onSignal    The function to invoke when a signal is received.
     */
@@ -81,9 +306,10 @@ public:
    /**
     * @brief Creates and adds the specified number of worker threads to the ASIO service.
     *
-    * @param in_numThreads  The number of worker threads to add to the ASIO service.
+    * @param in_numThreads      The number of worker threads to add to the ASIO service.
+    * @param in_threadModel     How the new worker threads should share work. Default: AsioThreadModel::SHARED_CONTEXT.
     */
-   static void startThreads(size_t in_numThreads);
+   static void startThreads(size_t in_numThreads, AsioThreadModel in_threadModel = AsioThreadModel::SHARED_CONTEXT);
 
    /**
     * @brief Stops the ASIO Service.
@@ -111,6 +337,21 @@ private:
     */
    static AsioService& getAsioService();
 
+   /**
+    * @brief Posts a task to be completed by this ASIO Service.
+    *
+    * @param in_task    The task to be posted to the ASIO Service.
+    */
+   static void postTask(AsioTask&& in_task);
+
+   /**
+    * @brief Posts a task to be completed by this ASIO Service, on the queue selected by the specified key.
+    *
+    * @param in_key     The key which selects the queue on which the task will be run.
+    * @param in_task    The task to be posted to the ASIO Service.
+    */
+   static void postTask(size_t in_key, AsioTask&& in_task);
+
    // Private implementation of AsioService.
    PRIVATE_IMPL_SHARED(m_impl);
 };
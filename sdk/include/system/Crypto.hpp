@@ -204,6 +204,18 @@ Error encryptAndBase64Encode(
  */
 Error random(uint32_t in_length, std::vector<unsigned char>& out_randomData);
 
+/**
+ * @brief Generates random bytes of the specified length into a caller-provided buffer.
+ *
+ * This function behaves the same as the vector overload, but does not allocate.
+ *
+ * @param in_length         The number of bytes of random data to generate.
+ * @param out_randomData    The buffer to fill with random data. Must be at least in_length bytes long.
+ *
+ * @return Success if the random data could be generated; Error otherwise.
+ */
+Error random(uint32_t in_length, unsigned char* out_randomData);
+
 } // namespace crypto
 } // namespace system
 } // namespace launcher_plugins
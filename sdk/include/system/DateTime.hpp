@@ -24,6 +24,7 @@
 #ifndef LAUNCHER_PLUGINS_DATE_TIME_HPP
 #define LAUNCHER_PLUGINS_DATE_TIME_HPP
 
+#include <chrono>
 #include <string>
 
 #include <ctime>
@@ -233,6 +234,13 @@ public:
     */
    int64_t getMicroseconds() const;
 
+   /**
+    * @brief Converts this TimeDuration to a duration of the steady clock, for use with timers and timeouts.
+    *
+    * @return The equivalent steady clock duration, or 0 if this TimeDuration is "Infinity".
+    */
+   std::chrono::steady_clock::duration toSteadyDuration() const;
+
 private:
    // The private implementation of interval time.
    PRIVATE_IMPL(m_impl);
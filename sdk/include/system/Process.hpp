@@ -28,6 +28,7 @@
 #include <Noncopyable.hpp>
 
 #include <functional>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -403,6 +404,34 @@ private:
  */
 Error getChildProcesses(pid_t in_parentPid, std::vector<ProcessInfo>& out_processes);
 
+/**
+ * @brief Gets the PIDs of all the processes which are currently running on this machine.
+ *
+ * This is much cheaper than retrieving the process information of every process, so it can be used to check whether
+ * many processes are still running at once.
+ *
+ * @param out_pids          The PIDs of all running processes.
+ *
+ * @return Success if the running processes could be listed; Error otherwise.
+ */
+Error getProcessIds(std::set<pid_t>& out_pids);
+
+/**
+ * @brief Opens a file for appending as the specified user, creating it if it does not exist.
+ *
+ * If the user is not the effective user of this process, the file is opened by a short-lived child process which
+ * changes to the user and passes the open file descriptor back, so the file is created with the correct owner and the
+ * user's permissions are respected without changing the privileges of this process.
+ *
+ * @param in_file       The file to open.
+ * @param in_user       The user as whom the file should be opened. If empty, the file is opened as the effective user
+ *                      of this process.
+ * @param out_fd        The file descriptor of the open file. The caller is responsible for closing it.
+ *
+ * @return Success if the file could be opened; Error otherwise.
+ */
+Error openFileForAppendAsUser(const FilePath& in_file, const User& in_user, int& out_fd);
+
 /**
  * @brief Sends a signal to the specified process.
  * 
@@ -37,6 +37,7 @@ class Error;
 namespace system {
 
 class FilePath;
+class TimeDuration;
 
 } // namespace system
 } // namespace launcher_plugins
@@ -120,6 +121,23 @@ public:
     */
    static Error getUserFromIdentifier(UidType in_userId, User& out_user);
 
+   /**
+    * @brief Removes all users from the lookup cache, so the next lookup of each user reads the system user database.
+    *
+    * Users looked up with getCurrentUser or getUserFromIdentifier are cached, so repeated lookups do not query the
+    * system user database (which may be backed by a network service). Users which do not exist are cached for at most
+    * 5 seconds.
+    */
+   static void clearCache();
+
+   /**
+    * @brief Sets how long looked up users are cached. Clears the cache.
+    *
+    * @param in_timeToLive      How long looked up users are cached. A zero duration disables the cache. Default: 60
+    *                           seconds.
+    */
+   static void setCacheTimeToLive(const TimeDuration& in_timeToLive);
+
    /**
     * @brief Overloaded assignment operator.
     *
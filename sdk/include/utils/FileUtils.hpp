@@ -44,6 +44,21 @@ namespace rstudio {
 namespace launcher_plugins {
 namespace utils {
 
+/**
+ * @brief Enum which controls how a file written by writeStringToFileAtomically is flushed to disk.
+ */
+enum class FileSyncMode
+{
+   /** The file is not explicitly flushed. The write will survive the process exiting, but not a system crash. */
+   NONE,
+
+   /** The contents of the file are flushed to disk before the file is renamed into place. */
+   FILE,
+
+   /** The contents of the file and the parent directory are flushed to disk, so the rename also survives a crash. */
+   FILE_AND_DIRECTORY
+};
+
 /**
  * @brief Reads the entire contents of the specified file into a single string.
  *
@@ -54,6 +69,26 @@ namespace utils {
  */
 Error readFileIntoString(const system::FilePath& in_file, std::string& out_fileContents);
 
+/**
+ * @brief Flushes a directory to disk, so that files which were recently created in it or renamed into it survive a
+ *        system crash.
+ *
+ * @param in_directory      The directory to flush.
+ *
+ * @return Success if the directory could be flushed; Error otherwise.
+ */
+Error syncDirectory(const system::FilePath& in_directory);
+
+/**
+ * @brief Writes all of a string to a file descriptor, retrying partial and interrupted writes.
+ *
+ * @param in_fd             The file descriptor to which to write the data.
+ * @param in_contents       The data to write.
+ *
+ * @return Success if all of the data was written; Error otherwise.
+ */
+Error writeAll(int in_fd, const std::string& in_contents);
+
 /**
  * @brief Writes a string to a file, optionally appending to any existing content in the file (rather than overwriting).
  *
@@ -65,6 +100,23 @@ Error readFileIntoString(const system::FilePath& in_file, std::string& out_fileC
  */
 Error writeStringToFile(const std::string& in_contents, const system::FilePath& in_file, bool in_truncate = true);
 
+/**
+ * @brief Replaces the contents of a file with a string, such that the file will never be observed partially written.
+ *
+ * The data is written to a temporary file in the same directory as in_file, which is then renamed over in_file. Unlike
+ * writeStringToFile, line endings are not normalized, so the data is written exactly as provided.
+ *
+ * @param in_contents       The data to write to the file.
+ * @param in_file           The file to which to write the data.
+ * @param in_syncMode       How the data should be flushed to disk. Default: FileSyncMode::FILE_AND_DIRECTORY.
+ *
+ * @return Success if the data was written to the file; Error otherwise.
+ */
+Error writeStringToFileAtomically(
+   const std::string& in_contents,
+   const system::FilePath& in_file,
+   FileSyncMode in_syncMode = FileSyncMode::FILE_AND_DIRECTORY);
+
 } // namespace utils
 } // namespace launcher_plugins
 } // namespace rstudio
@@ -26,11 +26,13 @@
 #include <mutex>
 
 #include <Error.hpp>
+#include <api/AbstractPluginApi.hpp>
 #include <comms/StdIOLauncherCommunicator.hpp>
 #include <logging/Logger.hpp>
 #include <logging/FileLogDestination.hpp>
 #include <logging/StderrLogDestination.hpp>
 #include <logging/SyslogDestination.hpp>
+#include <logging/Trace.hpp>
 #include <options/Options.hpp>
 #include <system/PosixSystem.hpp>
 #include <system/User.hpp>
@@ -59,6 +61,12 @@ if (in_error)                             \
 
 namespace {
 
+// The ID of the log destination which writes to the plugin's log file.
+constexpr const char* MAIN_LOG_DESTINATION_ID = "MainLogDestination";
+
+// How often to report the log messages which rate limiters suppressed at the end of a burst.
+constexpr int64_t SUPPRESSED_LOG_REPORT_INTERVAL_SECONDS = 10;
+
 int configureScratchPath(
    const system::FilePath& in_scratchPath,
    const system::User& in_serverUser,
@@ -132,16 +140,123 @@ struct AbstractMain::Impl
       END_LOCK_MUTEX
    }
 
+   /**
+    * @brief Writes the recorded trace spans to the trace file, if tracing is enabled.
+    */
+   void writeTrace() const
+   {
+      if (!logging::isTracingEnabled())
+         return;
+
+      Error error = logging::writeTrace(m_traceFile);
+      if (error)
+         logging::logError(error);
+   }
+
+   /**
+    * @brief Starts periodically reporting the log messages which rate limiters suppressed at the end of a burst.
+    */
+   void startReportingSuppressedLogs()
+   {
+      m_reportSuppressedLogsEvent.start(
+         system::TimeDuration::Seconds(SUPPRESSED_LOG_REPORT_INTERVAL_SECONDS),
+         []() { logging::LogRateLimiter::reportSuppressedMessages(); });
+   }
+
+   /**
+    * @brief Reports any log messages which rate limiters suppressed one last time and stops reporting them.
+    */
+   void stopReportingSuppressedLogs()
+   {
+      m_reportSuppressedLogsEvent.cancel();
+      logging::LogRateLimiter::reportSuppressedMessages(true);
+   }
+
+   /**
+    * @brief Starts recording trace spans.
+    *
+    * @param in_spansPerThread      The number of completed spans to keep for each thread.
+    * @param in_traceFile           The file to which trace spans should be written.
+    * @param in_writeInterval       The interval at which trace spans should be written, or 0 to only write them when
+    *                               SIGUSR1 is received and on exit.
+    */
+   void startTracing(
+      size_t in_spansPerThread,
+      const system::FilePath& in_traceFile,
+      const system::TimeDuration& in_writeInterval)
+   {
+      m_traceFile = in_traceFile;
+      logging::enableTracing(in_spansPerThread);
+      m_writeTraceEvent.start(in_writeInterval, [this]() { writeTrace(); });
+   }
+
+   /**
+    * @brief Writes any recorded trace spans one last time and stops recording trace spans.
+    */
+   void stopTracing()
+   {
+      m_writeTraceEvent.cancel();
+      writeTrace();
+      logging::disableTracing();
+   }
+
+   /**
+    * @brief Reloads the options and the configuration of the plugin. If the options are invalid, the previous values
+    *        remain in use.
+    */
+   void reloadConfiguration()
+   {
+      logging::logInfoMessage("Reloading configuration...");
+
+      options::Options& options = options::Options::getInstance();
+      Error error = options.reloadOptions();
+      if (error)
+      {
+         logging::logError(error);
+         logging::logErrorMessage("Could not reload the options. The previous configuration will continue to be used.");
+         return;
+      }
+
+      logging::setLogDestinationLevel(MAIN_LOG_DESTINATION_ID, options.getLogLevel());
+      system::User::setCacheTimeToLive(options.getUserCacheTtlSeconds());
+
+      if (m_pluginApi != nullptr)
+      {
+         error = m_pluginApi->reloadConfiguration();
+         if (error)
+            logging::logError(error);
+      }
+   }
+
+   /**
+    * @brief Sets the plugin API whose configuration should be reloaded when SIGHUP is received. This must be invoked
+    *        before the ASIO threads are started.
+    *
+    * @param in_pluginApi       The plugin API.
+    */
+   void setPluginApi(std::shared_ptr<api::AbstractPluginApi> in_pluginApi)
+   {
+      m_pluginApi = std::move(in_pluginApi);
+   }
+
    /**
     * @brief Signal handler to be invoked when the process recevies a signal such as SIGINT.
     *
+    * SIGUSR1 writes the recorded trace spans to the trace file and SIGHUP reloads the configuration. Any other signal
+    * shuts down the process.
+    *
     * @param in_sharedThis      A shared pointer to this.
     * @param in_signal          The signal which was received.
     */
    static void onSignal(std::shared_ptr<Impl> in_sharedThis, int in_signal)
    {
       logging::logInfoMessage("Received signal: " + std::to_string(in_signal));
-      in_sharedThis->signalShutdown();
+      if (in_signal == SIGUSR1)
+         in_sharedThis->writeTrace();
+      else if (in_signal == SIGHUP)
+         in_sharedThis->reloadConfiguration();
+      else
+         in_sharedThis->signalShutdown();
    }
 
    /**
@@ -153,8 +268,14 @@ struct AbstractMain::Impl
     */
    static void onCommunicationError(std::shared_ptr<Impl> in_sharedThis, const Error& in_error)
    {
-      logging::logError(in_error);
-      logging::logErrorMessage("Received fatal error while attempting to communicate with Job Launcher Framework.");
+      // Every message that was already received may fail the same way, so don't log each of them.
+      static logging::LogRateLimiter s_errorRateLimiter(10, system::TimeDuration::Seconds(10));
+      logging::logErrorRateLimited(s_errorRateLimiter, in_error);
+      LOG_RATE_LIMITED(
+         logging::LogLevel::ERR,
+         1,
+         60,
+         "Received fatal error while attempting to communicate with Job Launcher Framework.");
 
       in_sharedThis->signalShutdown();
    }
@@ -181,6 +302,18 @@ private:
 
    /** Condition variable to use to wait for or send a shutdown signal. */
    std::condition_variable m_exitConditionVar;
+
+   /** The file to which trace spans are written. */
+   system::FilePath m_traceFile;
+
+   /** Timed event which reports the log messages suppressed by rate limiters periodically. */
+   system::AsyncTimedEvent m_reportSuppressedLogsEvent;
+
+   /** Timed event which writes the trace file periodically. */
+   system::AsyncTimedEvent m_writeTraceEvent;
+
+   /** The plugin API, whose configuration is reloaded when SIGHUP is received. */
+   std::shared_ptr<api::AbstractPluginApi> m_pluginApi;
 };
 
 int AbstractMain::run(int in_argc, char** in_argv)
@@ -208,6 +341,9 @@ int AbstractMain::run(int in_argc, char** in_argv)
    error = options.readOptions(in_argc, in_argv, getConfigFile());
    CHECK_ERROR(error)
 
+   // Cache looked up system users for the configured amount of time.
+   system::User::setCacheTimeToLive(options.getUserCacheTtlSeconds());
+
    // Ensure the server user exists.
    system::User serverUser;
    error = options.getServerUser(serverUser);
@@ -228,7 +364,7 @@ int AbstractMain::run(int in_argc, char** in_argv)
    addLogDestination(
          std::unique_ptr<ILogDestination>(
             new FileLogDestination(
-               "MainLogDestination",
+               MAIN_LOG_DESTINATION_ID,
                options.getLogLevel(),
                LogMessageFormatType::PRETTY,
                getProgramId(),
@@ -241,6 +377,20 @@ int AbstractMain::run(int in_argc, char** in_argv)
    // Remove the stderr log destination.
    rstudio::launcher_plugins::logging::removeLogDestination(stderrLogDest->getId());
 
+   // Move writing log messages off of the calling threads, if configured.
+   if (options.getAsyncLogQueueSize() > 0)
+      enableAsyncLogging(options.getAsyncLogQueueSize(), options.getAsyncLogOverflowPolicy());
+
+   // Report the messages that rate limited call sites suppressed, even if they don't log again.
+   m_abstractMainImpl->startReportingSuppressedLogs();
+
+   // Record where the time is spent handling requests, if configured.
+   if (options.getTraceBufferSize() > 0)
+      m_abstractMainImpl->startTracing(
+         options.getTraceBufferSize(),
+         options.getLoggingDir().completeChildPath(getProgramId() + ".trace.json"),
+         options.getTraceDumpIntervalSeconds());
+
    // Drop privileges to the server user.
    if (system::posix::realUserIsRoot())
    {
@@ -273,8 +423,14 @@ int AbstractMain::run(int in_argc, char** in_argv)
    error = pluginApi->initialize();
    CHECK_ERROR(error)
 
+   m_abstractMainImpl->setPluginApi(pluginApi);
+
    // Add the configured number of threads to the ASIO service.
-   system::AsioService::startThreads(options.getThreadPoolSize());
+   system::AsioService::startThreads(
+      options.getThreadPoolSize(),
+      options.useIoContextPerThread() ?
+         system::AsioThreadModel::CONTEXT_PER_THREAD :
+         system::AsioThreadModel::SHARED_CONTEXT);
 
    // Start the communicator.
    error = launcherCommunicator->start();
@@ -290,6 +446,19 @@ int AbstractMain::run(int in_argc, char** in_argv)
    launcherCommunicator->waitForExit();
    system::AsioService::waitForExit();
 
+   // Now that nothing else can change, give the plugin a chance to persist anything it hasn't yet written.
+   pluginApi->shutdown();
+   m_abstractMainImpl->setPluginApi(nullptr);
+
+   // Write the trace spans that were recorded since the trace file was last written.
+   m_abstractMainImpl->stopTracing();
+
+   // Report the log messages that were suppressed since they were last reported.
+   m_abstractMainImpl->stopReportingSuppressedLogs();
+
+   // Write any log messages that are still queued.
+   disableAsyncLogging();
+
    return EXIT_SUCCESS;
 }
 
@@ -21,6 +21,7 @@
  *
  */
 
+#include <cstring>
 #include <ostream>
 
 #include <boost/system/error_code.hpp>
@@ -58,60 +59,31 @@ std::ostream& operator<<(std::ostream& in_os, const ErrorLocation& in_location)
    return in_os;
 }
 
-struct ErrorLocation::Impl
-{
-   Impl() : Line(0)
-   {
-   }
-
-   Impl(const char* in_function, const char* in_file, long in_line) :
-      Function(in_function), File(in_file), Line(in_line)
-   {
-   }
-
-   std::string Function;
-   std::string File;
-   long Line;
-};
-
-PRIVATE_IMPL_DELETER_IMPL(ErrorLocation)
-
 ErrorLocation::ErrorLocation() :
-   m_impl(new Impl())
+   m_function(""),
+   m_file(""),
+   m_line(0)
 {
 }
 
-ErrorLocation::ErrorLocation(const ErrorLocation& in_other) :
-   m_impl(new Impl(*in_other.m_impl))
-{
-}
+ErrorLocation::ErrorLocation(const ErrorLocation& in_other) = default;
 
-ErrorLocation::ErrorLocation(rstudio::launcher_plugins::ErrorLocation&& in_other) noexcept :
-   m_impl(std::move(in_other.m_impl))
-{
-   // Don't leave an error location with a nullptr impl.
-   in_other.m_impl.reset(new Impl());
-}
+ErrorLocation::ErrorLocation(ErrorLocation&& in_other) noexcept = default;
 
 ErrorLocation::ErrorLocation(const char* in_function, const char* in_file, long in_line) :
-   m_impl(new Impl(in_function, in_file, in_line))
+   m_function((in_function == nullptr) ? "" : in_function),
+   m_file((in_file == nullptr) ? "" : in_file),
+   m_line(in_line)
 {
 }
 
-ErrorLocation& ErrorLocation::operator=(const ErrorLocation& in_other)
-{
-   m_impl->File = in_other.m_impl->File;
-   m_impl->Function = in_other.m_impl->Function;
-   m_impl->Line = in_other.m_impl->Line;
-
-   return *this;
-}
+ErrorLocation& ErrorLocation::operator=(const ErrorLocation& in_other) = default;
 
 bool ErrorLocation::operator==(const ErrorLocation& in_location) const
 {
-   return getFunction() == in_location.getFunction() &&
-          getFile() == in_location.getFile() &&
-          getLine() == in_location.getLine();
+   return (m_line == in_location.m_line) &&
+          (std::strcmp(m_function, in_location.m_function) == 0) &&
+          (std::strcmp(m_file, in_location.m_file) == 0);
 }
 
 std::string ErrorLocation::asString() const
@@ -121,19 +93,19 @@ std::string ErrorLocation::asString() const
    return ostr.str();
 }
 
-const std::string& ErrorLocation::getFunction() const
+std::string ErrorLocation::getFunction() const
 {
-   return m_impl->Function;
+   return m_function;
 }
 
-const std::string& ErrorLocation::getFile() const
+std::string ErrorLocation::getFile() const
 {
-   return m_impl->File;
+   return m_file;
 }
 
 long ErrorLocation::getLine() const
 {
-   return m_impl->Line;
+   return m_line;
 }
 
 bool ErrorLocation::hasLocation() const
@@ -187,8 +159,8 @@ struct Error::Impl
    bool Expected = false;
 };
 
-Error::Error() :
-   m_impl(new Impl())
+// A success has no implementation; one is only allocated when a property of the error is set.
+Error::Error()
 {
 }
 
@@ -198,6 +170,23 @@ Error::Error(const Error& in_other) :
 {
 }
 
+Error::Error(Error&& in_other) noexcept :
+   m_impl(std::move(in_other.m_impl))
+{
+}
+
+Error& Error::operator=(const Error& in_other)
+{
+   m_impl = in_other.m_impl;
+   return *this;
+}
+
+Error& Error::operator=(Error&& in_other) noexcept
+{
+   m_impl = std::move(in_other.m_impl);
+   return *this;
+}
+
 Error::Error(std::string in_name, int in_code, const ErrorLocation& in_location) :
    m_impl(new Impl(in_code, std::move(in_name), in_location))
 {
@@ -249,9 +238,7 @@ bool Error::operator!=(const rstudio::launcher_plugins::Error& in_other) const
 
 void Error::addOrUpdateProperty(const std::string& in_name, const std::string& in_value)
 {
-   copyOnWrite();
-
-   for (auto & property : impl().Properties)
+   for (auto & property : mutableImpl().Properties)
    {
       if (property.first == in_name)
       {
@@ -275,8 +262,7 @@ void Error::addOrUpdateProperty(const std::string& in_name, int in_value)
 
 void Error::addProperty(const std::string& in_name, const std::string& in_value)
 {
-   copyOnWrite();
-   impl().Properties.push_back(std::make_pair(in_name, in_value));
+   mutableImpl().Properties.push_back(std::make_pair(in_name, in_value));
 }
 
 void Error::addProperty(const std::string& in_name, const FilePath& in_value)
@@ -379,33 +365,39 @@ std::string Error::getSummary() const
 
 bool Error::isExpected() const
 {
-   return m_impl->Expected;
+   return impl().Expected;
 }
 
 void Error::setExpected()
 {
-   m_impl->Expected = true;
+   mutableImpl().Expected = true;
 }
 
 void Error::copyOnWrite()
 {
-   if ((m_impl != nullptr) && !m_impl.unique())
-      m_impl.reset(new Impl(impl()));
+   if (m_impl == nullptr)
+      m_impl.reset(new Impl());
+   else if (!m_impl.unique())
+      m_impl.reset(new Impl(*m_impl));
 }
 
 bool Error::isError() const
+{
+   return (m_impl != nullptr) && (m_impl->Code != 0);
+}
+
+const Error::Impl& Error::impl() const
 {
    if (m_impl != nullptr)
-      return impl().Code != 0;
-   else
-      return false;
+      return *m_impl;
+
+   static const Impl s_successImpl;
+   return s_successImpl;
 }
 
-Error::Impl& Error::impl() const
+Error::Impl& Error::mutableImpl()
 {
-   // This doesn't really change the internal meaning of the object, so it's safe to const_cast here.
-   if (m_impl == nullptr)
-      const_cast<std::shared_ptr<Impl>*>(&m_impl)->reset(new Impl());
+   copyOnWrite();
    return *m_impl;
 }
 
@@ -34,6 +34,7 @@
 #include <api/stream/ResourceStreamManager.hpp>
 #include <json/Json.hpp>
 #include <jobs/JobPruner.hpp>
+#include <logging/Trace.hpp>
 #include <options/Options.hpp>
 #include <system/Asio.hpp>
 
@@ -143,7 +144,10 @@ struct AbstractPluginApi::Impl
             "User must not be empty.");
 
       bool isInvalidRequest = false;
+      logging::TraceSpan submitSpan("api.submitJob", in_submitJobRequest->getId());
       Error error = JobSource->submitJob(in_submitJobRequest->getJob(), isInvalidRequest);
+      submitSpan.setJobId(in_submitJobRequest->getJob()->Id);
+      submitSpan.end();
       if (error)
          return sendErrorResponse(
             in_submitJobRequest->getId(),
@@ -191,24 +195,27 @@ struct AbstractPluginApi::Impl
             ErrorResponse::Type::INVALID_REQUEST,
             "Invalid status(es): " + error.getMessage());
 
-      std::vector<std::string> statusesStrSet;
-      std::string statusesStr = "none";
-      if (statuses)
+      if (logging::isLogLevelEnabled(logging::LogLevel::DEBUG))
       {
-         std::transform(
-            statuses.getValueOr({}).begin(),
-            statuses.getValueOr({}).end(),
-            std::back_inserter(statusesStrSet),
-            &Job::stateToString);
-         statusesStr = boost::algorithm::join(statusesStrSet, ", ");
-      }
+         std::vector<std::string> statusesStrSet;
+         std::string statusesStr = "none";
+         if (statuses)
+         {
+            std::transform(
+               statuses.getValueOr({}).begin(),
+               statuses.getValueOr({}).end(),
+               std::back_inserter(statusesStrSet),
+               &Job::stateToString);
+            statusesStr = boost::algorithm::join(statusesStrSet, ", ");
+         }
 
-      logging::logDebugMessage(
-         "Received getJobState request for " + in_getJobRequest->getUser().getUsername() +
-         ": jobID: " + jobId +
-         " startTime: " + (startTime ? startTime.getValueOr(system::DateTime()).toString() : "none") +
-         " endTime: " + (endTime ? endTime.getValueOr(system::DateTime()).toString() : "none") +
-         " statuses: " + statusesStr);
+         logging::logDebugMessage(
+            "Received getJobState request for " + in_getJobRequest->getUser().getUsername() +
+            ": jobID: " + jobId +
+            " startTime: " + (startTime ? startTime.getValueOr(system::DateTime()).toString() : "none") +
+            " endTime: " + (endTime ? endTime.getValueOr(system::DateTime()).toString() : "none") +
+            " statuses: " + statusesStr);
+      }
 
       JobList jobs;
       if (jobId == "*")
@@ -264,7 +271,7 @@ struct AbstractPluginApi::Impl
 
       LOCK_JOB(job)
       {
-         bool opUnsupported = false;
+         bool opSupported = false;
          bool opComplete = false;
          std::string message;
          switch (in_controlJobRequest->getOperation())
@@ -277,7 +284,7 @@ struct AbstractPluginApi::Impl
                      ErrorResponse::Type::INVALID_JOB_STATE,
                      "Job must be running to kill it");
 
-               opUnsupported = JobSource->killJob(job, opComplete, message);
+               opSupported = JobSource->killJob(job, opComplete, message);
                break;
             }
             case ControlJobRequest::Operation::SUSPEND:
@@ -288,7 +295,7 @@ struct AbstractPluginApi::Impl
                      ErrorResponse::Type::INVALID_JOB_STATE,
                      "Job must be running to suspend it");
 
-               opUnsupported = JobSource->suspendJob(job, opComplete, message);
+               opSupported = JobSource->suspendJob(job, opComplete, message);
                break;
             }
             case ControlJobRequest::Operation::RESUME:
@@ -299,7 +306,7 @@ struct AbstractPluginApi::Impl
                      ErrorResponse::Type::INVALID_JOB_STATE,
                      "Job must be suspended to resume it");
 
-               opUnsupported = JobSource->resumeJob(job, opComplete, message);
+               opSupported = JobSource->resumeJob(job, opComplete, message);
                break;
             }
             case ControlJobRequest::Operation::STOP:
@@ -310,7 +317,7 @@ struct AbstractPluginApi::Impl
                      ErrorResponse::Type::INVALID_JOB_STATE,
                      "Job must be running to stop it");
 
-               opUnsupported = JobSource->stopJob(job, opComplete, message);
+               opSupported = JobSource->stopJob(job, opComplete, message);
                break;
             }
             case ControlJobRequest::Operation::CANCEL:
@@ -321,7 +328,7 @@ struct AbstractPluginApi::Impl
                      ErrorResponse::Type::INVALID_JOB_STATE,
                      "Job must be pending to cancel it");
 
-               opUnsupported = JobSource->cancelJob(job, opComplete, message);
+               opSupported = JobSource->cancelJob(job, opComplete, message);
                break;
             }
             default:
@@ -332,23 +339,22 @@ struct AbstractPluginApi::Impl
                   ErrorResponse::Type::UNKNOWN,
                   "Internal server error: unrecognized control job operation.");
             }
+         }
 
-            if (opUnsupported)
-            {
-               std::string opStr = std::to_string(static_cast<int>(in_controlJobRequest->getOperation()));
-               sendErrorResponse(
-                  in_controlJobRequest->getId(),
-                  ErrorResponse::Type::INVALID_REQUEST,
-                  message.empty() ?
-                     "Operation " + opStr + " not supported." :
-                     message);
-            }
-            else
-            {
-               LauncherCommunicator->sendResponse(
-                  ControlJobResponse(in_controlJobRequest->getId(), message, opComplete));
-            }
-            
+         if (!opSupported)
+         {
+            std::string opStr = std::to_string(static_cast<int>(in_controlJobRequest->getOperation()));
+            sendErrorResponse(
+               in_controlJobRequest->getId(),
+               ErrorResponse::Type::INVALID_REQUEST,
+               message.empty() ?
+                  "Operation " + opStr + " not supported." :
+                  message);
+         }
+         else
+         {
+            LauncherCommunicator->sendResponse(
+               ControlJobResponse(in_controlJobRequest->getId(), message, opComplete));
          }
       }
       END_LOCK_JOB
@@ -403,6 +409,8 @@ struct AbstractPluginApi::Impl
     */
    void handleRequest(const std::shared_ptr<Request>& in_request)
    {
+      logging::TraceSpan span("api.handleRequest", in_request->getId());
+
       if (!JobSource)
       {
          logging::logErrorMessage("Request received before JobSource was initialized.", ERROR_LOCATION);
@@ -523,6 +531,22 @@ Error AbstractPluginApi::initialize()
    return doInitialize();
 }
 
+void AbstractPluginApi::shutdown()
+{
+   m_abstractPluginImpl->SendHeartbeatEvent.cancel();
+
+   if (m_abstractPluginImpl->JobRepo)
+      m_abstractPluginImpl->JobRepo->shutdown();
+}
+
+Error AbstractPluginApi::reloadConfiguration()
+{
+   if (m_abstractPluginImpl->JobSource == nullptr)
+      return Success();
+
+   return m_abstractPluginImpl->JobSource->reloadConfiguration();
+}
+
 AbstractPluginApi::AbstractPluginApi(std::shared_ptr<comms::AbstractLauncherCommunicator> in_launcherCommunicator) :
    m_abstractPluginImpl(new Impl(std::move(in_launcherCommunicator)))
 {
@@ -68,6 +68,11 @@ std::atomic_uint64_t Response::Impl::NEXT_RESPONSE_ID { 0 };
 
 PRIVATE_IMPL_DELETER_IMPL(Response)
 
+uint64_t Response::getRequestId() const
+{
+   return m_responseImpl->RequestId;
+}
+
 json::Object Response::toJson() const
 {
    json::Object jsonObject;
@@ -67,14 +67,14 @@ Error fileExistsForUser(const system::FilePath& in_file, const system::User& in_
    if (result.ExitCode == 127)
    {
       // :/bin will be appended to the PATH by the Process.cpp code since PATH is not explicitly set in lsOpts.
-      std::string pathVar = system::posix::getEnvironmentVariable("PATH").append(":/bin");
-      logging::logDebugMessage(
+      LOG_DEBUG_MESSAGE(
          "The 'ls' executable could not be found. Please verify that the 'ls' executable "
-         "exists and has appropriate permissions on the PATH: \"" + pathVar + "\"");
+         "exists and has appropriate permissions on the PATH: \"" +
+         system::posix::getEnvironmentVariable("PATH").append(":/bin") + "\"");
    }
    else if (!out_wasFound)
    {
-      logging::logDebugMessage(
+      LOG_DEBUG_MESSAGE(
          "'ls " +
          in_file.getAbsolutePath() +
          "' failed with error code (" +
@@ -325,9 +325,11 @@ struct FileOutputStream::Impl
 
          callbacks.OnStandardError = [in_sharedThis](const std::string& in_output)
          {
-
-               std::string message = "Stderr output received for OutputStream tail command: " + in_output;
-               logging::logDebugMessage(message, ERROR_LOCATION);
+            LOG_RATE_LIMITED(
+               logging::LogLevel::DEBUG,
+               100,
+               10,
+               "Stderr output received for OutputStream tail command: " + in_output);
          };
 
          callbacks.OnExit = std::bind(FileOutputStream::onExitCallback, WeakThis(in_sharedThis), in_outputType, _1);
@@ -25,6 +25,7 @@
 #include "JobStatusStreamManager.hpp"
 
 #include <api/Request.hpp>
+#include <logging/Trace.hpp>
 
 #include "JobStatusStream.hpp"
 
@@ -212,6 +213,8 @@ JobStatusStreamManager::JobStatusStreamManager(
 
 void JobStatusStreamManager::handleStreamRequest(const std::shared_ptr<JobStatusRequest>& in_jobStatusRequest)
 {
+   logging::TraceSpan span("stream.jobStatus", in_jobStatusRequest->getId(), in_jobStatusRequest->getJobId());
+
    if (in_jobStatusRequest->getJobId() == "*")
    {
       LOCK_MUTEX(m_impl->AllJobsMutex)
@@ -33,6 +33,7 @@
 #include <comms/AbstractLauncherCommunicator.hpp>
 #include <jobs/AbstractJobRepository.hpp>
 #include <jobs/JobStatusNotifier.hpp>
+#include <logging/Trace.hpp>
 
 namespace rstudio {
 namespace launcher_plugins {
@@ -311,6 +312,7 @@ void OutputStreamManager::handleStreamRequest(const std::shared_ptr<OutputStream
    bool isCancel = in_outputStreamRequest->isCancelRequest();
    const std::string& jobId = in_outputStreamRequest->getJobId();
    const system::User& jobUser = in_outputStreamRequest->getUser();
+   logging::TraceSpan span("stream.output", requestId, jobId);
 
    UNIQUE_LOCK_MUTEX(m_impl->Mutex)
    {
@@ -324,7 +326,7 @@ void OutputStreamManager::handleStreamRequest(const std::shared_ptr<OutputStream
          }
          else
          {
-            logging::logDebugMessage(
+            LOG_DEBUG_MESSAGE(
                "Received duplicate output stream request (" +
                std::to_string(requestId) +
                ") for job " +
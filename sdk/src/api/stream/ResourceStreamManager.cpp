@@ -26,6 +26,7 @@
 #include <map>
 
 #include <logging/Logger.hpp>
+#include <logging/Trace.hpp>
 #include <api/IJobSource.hpp>
 #include <api/Request.hpp>
 #include <api/stream/AbstractResourceStream.hpp>
@@ -184,6 +185,7 @@ void ResourceStreamManager::handleStreamRequest(
    uint64_t id = in_resourceUtilStreamRequest->getId();
    const std::string& jobId = in_resourceUtilStreamRequest->getJobId();
    const system::User& user = in_resourceUtilStreamRequest->getUser();
+   logging::TraceSpan span("stream.resourceUtil", id, jobId);
 
    LOCK_MUTEX(m_impl->Mutex)
    {
@@ -32,6 +32,7 @@
 #include <api/Request.hpp>
 #include <api/Response.hpp>
 #include <logging/Logger.hpp>
+#include <logging/Trace.hpp>
 #include <json/Json.hpp>
 #include <system/Asio.hpp>
 #include <utils/MutexUtils.hpp>
@@ -63,9 +64,12 @@ struct AbstractLauncherCommunicator::Impl
 
    static void defaultRequestHandler(const SharedThis& in_sharedThis, const std::shared_ptr<api::Request>& in_request)
    {
-      std::ostringstream msgStream;
-      msgStream << "No request handler found for request type " << in_request->getType() << ".";
-      logging::logDebugMessage(msgStream.str(), ERROR_LOCATION);
+      if (logging::isLogLevelEnabled(logging::LogLevel::DEBUG))
+      {
+         std::ostringstream msgStream;
+         msgStream << "No request handler found for request type " << in_request->getType() << ".";
+         logging::logDebugMessage(msgStream.str(), ERROR_LOCATION);
+      }
 
       // Send an error response to the launcher.
       in_sharedThis->sendResponse(api::ErrorResponse(
@@ -98,10 +102,11 @@ void AbstractLauncherCommunicator::registerRequestHandler(std::unique_ptr<Reques
 
 void AbstractLauncherCommunicator::sendResponse(const api::Response& in_response)
 {
+   logging::TraceSpan span("comms.sendResponse", in_response.getRequestId());
    std::string jsonStr = in_response.toJson().write();
    std::string message = m_baseImpl->MsgHandler.formatMessage(jsonStr);
 
-   logging::logDebugMessage("Sending message to the Launcher: " + jsonStr);
+   LOG_DEBUG_MESSAGE("Sending message to the Launcher: " + jsonStr);
    writeResponse(message);
 }
 
@@ -145,6 +150,9 @@ void AbstractLauncherCommunicator::onDataReceived(const char* in_data, size_t in
          if (!sharedThis)
             return;
 
+         logging::TraceSpan handleSpan("comms.handleMessage");
+         logging::TraceSpan parseSpan("comms.parseRequest");
+
          // Parse the JSON object.
          json::Object jsonRequest;
          Error error = jsonRequest.parse(in_message);
@@ -179,6 +187,10 @@ void AbstractLauncherCommunicator::onDataReceived(const char* in_data, size_t in
             return;
          }
 
+         handleSpan.setRequestId(request->getId());
+         parseSpan.setRequestId(request->getId());
+         parseSpan.end();
+
          // Send the object to the request handler, or send an error to the launcher;
          if (sharedThis->m_baseImpl->RequestHandlerPtr == nullptr)
             Impl::defaultRequestHandler(sharedThis, request);
@@ -27,6 +27,7 @@
 
 #include <Error.hpp>
 #include <jobs/JobPruner.hpp>
+#include <logging/Trace.hpp>
 
 #include "../system/ReaderWriterMutex.hpp"
 
@@ -66,6 +67,8 @@ AbstractJobRepository::AbstractJobRepository(JobStatusNotifierPtr in_jobStatusNo
 
 void AbstractJobRepository::addJob(const JobPtr& in_job)
 {
+   logging::TraceSpan span("jobs.addJob", 0, in_job->Id);
+
    WRITE_LOCK_BEGIN(m_impl->Mutex)
    {
       auto itr = m_impl->JobMap.find(in_job->Id);
@@ -78,6 +81,11 @@ void AbstractJobRepository::addJob(const JobPtr& in_job)
    RW_LOCK_END(true)
 }
 
+void AbstractJobRepository::shutdown()
+{
+   onShutdown();
+}
+
 JobPtr AbstractJobRepository::getJob(const std::string& in_jobId, const system::User& in_user) const
 {
    READ_LOCK_BEGIN(m_impl->Mutex)
@@ -128,7 +136,11 @@ Error AbstractJobRepository::initialize()
    {
       if (SharedThis sharedThis = weakThis.lock())
       {
-         sharedThis->addJob(in_job);
+         // Updates for the same job are serialized by the job lock, so the job can't be added between these calls.
+         if (sharedThis->getJob(in_job->Id) == nullptr)
+            sharedThis->addJob(in_job);
+         else
+            sharedThis->onJobUpdated(in_job);
       }
    };
 
@@ -181,11 +193,21 @@ void AbstractJobRepository::onJobRemoved(const JobPtr&)
    // Do nothing.
 }
 
+void AbstractJobRepository::onJobUpdated(const JobPtr&)
+{
+   // Do nothing.
+}
+
 Error AbstractJobRepository::onInitialize()
 {
    return Success();
 }
 
+void AbstractJobRepository::onShutdown()
+{
+   // Do nothing.
+}
+
 } // namespace jobs
 } // namespace launcher_plugins
 } // namespace rstudio
@@ -48,12 +48,22 @@ struct JobPruner::Impl: public std::enable_shared_from_this<JobPruner::Impl>
    Impl(
       JobRepositoryPtr in_jobRepository,
       JobStatusNotifierPtr in_jobStatusNotifier) :
-         JobExpiryTime(std::move(options::Options::getInstance().getJobExpiryHours())),
          JobRepo(std::move(in_jobRepository)),
          Notifier(std::move(in_jobStatusNotifier))
    {
    }
 
+   /**
+    * @brief Gets the amount of time from the last update of a job until it should be pruned. This is read from the
+    *        options each time, since the job expiry may be changed when the options are reloaded.
+    *
+    * @return The amount of time from the last update of a job until it should be pruned.
+    */
+   static system::TimeDuration getJobExpiryTime()
+   {
+      return options::Options::getInstance().getJobExpiryHours();
+   }
+
    void startPruneTimer(const std::string& in_jobId, system::DateTime in_expiry)
    {
       WeakThis weakThis = shared_from_this();
@@ -94,7 +104,7 @@ struct JobPruner::Impl: public std::enable_shared_from_this<JobPruner::Impl>
          {
             if(job->isCompleted()) {
             // Check if we should remove the job.
-            expiry = job->LastUpdateTime.getValueOr(job->SubmissionTime) + JobExpiryTime;
+            expiry = job->LastUpdateTime.getValueOr(job->SubmissionTime) + getJobExpiryTime();
             removeJob = expiry <= system::DateTime();
             if (removeJob)
                JobRepo->removeJob(in_jobId);
@@ -130,7 +140,9 @@ struct JobPruner::Impl: public std::enable_shared_from_this<JobPruner::Impl>
          LOCK_JOB(in_job)
          {
             if (in_job->isCompleted())
-               startPruneTimer(in_job->Id, in_job->LastUpdateTime.getValueOr(in_job->SubmissionTime) + JobExpiryTime);
+               startPruneTimer(
+                  in_job->Id,
+                  in_job->LastUpdateTime.getValueOr(in_job->SubmissionTime) + getJobExpiryTime());
          }
          END_LOCK_JOB
       }
@@ -162,11 +174,6 @@ struct JobPruner::Impl: public std::enable_shared_from_this<JobPruner::Impl>
     */
    SubscriptionHandle AllJobsSubHandle;
 
-   /**
-    * @brief The amount of time from the last update of a job until it should be pruned.
-    */
-   system::TimeDuration JobExpiryTime;
-
    /**
     * @brief The Job Repository to remove jobs from.
     */
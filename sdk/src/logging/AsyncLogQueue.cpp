@@ -0,0 +1,162 @@
+/*
+ * AsyncLogQueue.cpp
+ * 
+ * Copyright (C) 2022 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "AsyncLogQueue.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace logging {
+
+namespace {
+
+// Size of a cache line, used to keep the producer and consumer positions from sharing one.
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+size_t roundUpToPowerOfTwo(size_t in_value)
+{
+   size_t result = 2;
+   while (result < in_value)
+      result <<= 1;
+   return result;
+}
+
+/**
+ * @brief A slot of the queue.
+ *
+ * While the sequence equals the position that will next be pushed into the slot, the slot is free. Once it equals that
+ * position plus one, the slot holds a record which may be popped.
+ */
+struct Cell
+{
+   std::atomic<size_t> Sequence;
+   QueuedLogRecord Record;
+};
+
+} // anonymous namespace
+
+struct AsyncLogQueue::Impl
+{
+   explicit Impl(size_t in_capacity) :
+      Cells(roundUpToPowerOfTwo(in_capacity)),
+      Mask(Cells.size() - 1),
+      Padding1(),
+      EnqueuePosition(0),
+      Padding2(),
+      DequeuePosition(0)
+   {
+      for (size_t i = 0; i < Cells.size(); ++i)
+         Cells[i].Sequence.store(i, std::memory_order_relaxed);
+   }
+
+   // The slots of the queue.
+   std::vector<Cell> Cells;
+
+   // The mask which converts a position into a slot index.
+   const size_t Mask;
+
+   // Keeps the enqueue position, which every producer writes, off the cache line of the fields above.
+   char Padding1[CACHE_LINE_SIZE];
+
+   // The position of the next record to be pushed.
+   std::atomic<size_t> EnqueuePosition;
+
+   // Keeps the dequeue position off the cache line of the enqueue position.
+   char Padding2[CACHE_LINE_SIZE];
+
+   // The position of the next record to be popped. Only the consumer accesses this.
+   size_t DequeuePosition;
+};
+
+PRIVATE_IMPL_DELETER_IMPL(AsyncLogQueue)
+
+AsyncLogQueue::AsyncLogQueue(size_t in_capacity) :
+   m_impl(new Impl(in_capacity))
+{
+}
+
+size_t AsyncLogQueue::getCapacity() const
+{
+   return m_impl->Cells.size();
+}
+
+bool AsyncLogQueue::isEmpty() const
+{
+   const size_t pos = m_impl->DequeuePosition;
+   return m_impl->Cells[pos & m_impl->Mask].Sequence.load(std::memory_order_acquire) != pos + 1;
+}
+
+bool AsyncLogQueue::tryPop(QueuedLogRecord& out_record)
+{
+   const size_t pos = m_impl->DequeuePosition;
+   Cell& cell = m_impl->Cells[pos & m_impl->Mask];
+   if (cell.Sequence.load(std::memory_order_acquire) != pos + 1)
+      return false;
+
+   out_record = std::move(cell.Record);
+   cell.Record = QueuedLogRecord();
+
+   // Free the slot for the producer which will wrap around to it.
+   cell.Sequence.store(pos + m_impl->Mask + 1, std::memory_order_release);
+   ++m_impl->DequeuePosition;
+   return true;
+}
+
+bool AsyncLogQueue::tryPush(QueuedLogRecord& io_record)
+{
+   size_t pos = m_impl->EnqueuePosition.load(std::memory_order_relaxed);
+   Cell* cell = nullptr;
+   while (true)
+   {
+      cell = &m_impl->Cells[pos & m_impl->Mask];
+      const size_t seq = cell->Sequence.load(std::memory_order_acquire);
+      const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0)
+      {
+         // The slot is free: claim it. On failure pos is reloaded with the current enqueue position.
+         if (m_impl->EnqueuePosition.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            break;
+      }
+      else if (diff < 0)
+      {
+         // The slot still holds the record from the previous lap, so the queue is full.
+         return false;
+      }
+      else
+      {
+         // Another producer claimed this slot.
+         pos = m_impl->EnqueuePosition.load(std::memory_order_relaxed);
+      }
+   }
+
+   cell->Record = std::move(io_record);
+   cell->Sequence.store(pos + 1, std::memory_order_release);
+   return true;
+}
+
+} // namespace logging
+} // namespace launcher_plugins
+} // namespace rstudio
@@ -0,0 +1,126 @@
+/*
+ * AsyncLogQueue.hpp
+ * 
+ * Copyright (C) 2022 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef LAUNCHER_PLUGINS_ASYNC_LOG_QUEUE_HPP
+#define LAUNCHER_PLUGINS_ASYNC_LOG_QUEUE_HPP
+
+#include <Noncopyable.hpp>
+
+#include <string>
+
+#include <PImpl.hpp>
+#include <logging/Logger.hpp>
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace logging {
+
+/**
+ * @brief A log message which has already been formatted and is waiting to be written to the log destinations.
+ */
+struct QueuedLogRecord
+{
+   /**
+    * @brief Constructor.
+    */
+   QueuedLogRecord() :
+      IsPassthrough(false),
+      Level(LogLevel::OFF)
+   {
+   }
+
+   // Whether this record was logged by another source. Passthrough records are written as is to the default log
+   // destinations, and only PrettyMessage is set.
+   bool IsPassthrough;
+
+   // The log level of the message.
+   LogLevel Level;
+
+   // The message formatted for JSON log destinations, if any were registered when the message was logged.
+   std::string JsonMessage;
+
+   // The message formatted for pretty log destinations, if any were registered when the message was logged.
+   std::string PrettyMessage;
+
+   // The section to which the message was logged.
+   std::string Section;
+};
+
+/**
+ * @brief Bounded, lock-free queue of log records with any number of producers and a single consumer.
+ *
+ * Each slot of the queue carries a sequence number which tells producers and the consumer whether the slot is free or
+ * holds a record, so pushing a record only costs a single compare-and-swap on the enqueue position.
+ */
+class AsyncLogQueue : public Noncopyable
+{
+public:
+   /**
+    * @brief Constructor.
+    *
+    * @param in_capacity    The minimum number of records the queue can hold. It will be rounded up to a power of two.
+    */
+   explicit AsyncLogQueue(size_t in_capacity);
+
+   /**
+    * @brief Gets the number of records the queue can hold.
+    *
+    * @return The number of records the queue can hold.
+    */
+   size_t getCapacity() const;
+
+   /**
+    * @brief Checks whether the queue is empty. This method may only be invoked by the consumer.
+    *
+    * @return True if there are no records to pop; false otherwise.
+    */
+   bool isEmpty() const;
+
+   /**
+    * @brief Removes the oldest record from the queue. This method may only be invoked by the consumer.
+    *
+    * @param out_record     The oldest record, if the queue was not empty.
+    *
+    * @return True if a record was removed; false if the queue was empty.
+    */
+   bool tryPop(QueuedLogRecord& out_record);
+
+   /**
+    * @brief Adds a record to the queue. This method may be invoked by any number of threads at once.
+    *
+    * @param io_record      The record to add. It is only moved from if it was added.
+    *
+    * @return True if the record was added; false if the queue was full.
+    */
+   bool tryPush(QueuedLogRecord& io_record);
+
+private:
+   // The private implementation of AsyncLogQueue.
+   PRIVATE_IMPL(m_impl);
+};
+
+} // namespace logging
+} // namespace launcher_plugins
+} // namespace rstudio
+
+#endif
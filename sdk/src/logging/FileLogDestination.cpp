@@ -23,8 +23,15 @@
 
 #include <logging/FileLogDestination.hpp>
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <boost/algorithm/string.hpp>
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
+#include <thread>
 
 #include <vector>
 
@@ -42,6 +49,19 @@ namespace rstudio {
 namespace launcher_plugins {
 namespace logging {
 
+namespace {
+
+// The amount of buffered log data at which the buffer is written to the file right away.
+constexpr size_t MAX_BUFFER_SIZE = 64 * 1024;
+
+// How often buffered log data is written to the file, at most.
+constexpr std::chrono::seconds FLUSH_INTERVAL(1);
+
+// How often to check whether the log file is old enough to be rotated.
+constexpr std::chrono::seconds TIME_ROTATION_CHECK_INTERVAL(60);
+
+} // anonymous namespace
+
 // FileLogOptions ======================================================================================================
 FileLogOptions::FileLogOptions(FilePath in_directory) :
    m_directory(std::move(in_directory)),
@@ -253,7 +273,7 @@ struct FileLogDestination::Impl
 
    ~Impl()
    {
-      closeLogFile();
+      stop();
    }
 
    bool verifyLogFilePath()
@@ -265,18 +285,61 @@ struct FileLogDestination::Impl
       return true;
    }
 
+   // Checks whether the open log file is still the file at the log file path. It won't be if another process rotated or
+   // removed it. The mutex must be locked.
+   void checkLogFile()
+   {
+      if (Fd < 0)
+         return;
+
+      struct stat st;
+      if ((::stat(LogFile.getAbsolutePath().c_str(), &st) != 0) || (st.st_dev != Device) || (st.st_ino != Inode))
+         closeLogFile();
+      else
+         FileSize = static_cast<uintmax_t>(st.st_size); // Other processes may write to the same file.
+   }
+
+   // Closes the log file, without writing buffered data. The mutex must be locked.
    void closeLogFile()
    {
-      if (LogOutputStream)
+      if (Fd >= 0)
+         ::close(Fd);
+
+      Fd = -1;
+   }
+
+   // Writes any buffered data to the log file, rotating it first if necessary. The mutex must be locked.
+   void flush()
+   {
+      if (Buffer.empty())
+         return;
+
+      checkLogFile();
+
+      // If the log file can't be opened or rotated, log nothing.
+      if (!openLogFile() || !rotateLogFile())
       {
-         LogOutputStream->flush();
-         LogOutputStream.reset();
+         Buffer.clear();
+         return;
       }
+
+      // If the write fails, the file might have been closed. Try re-opening it and writing the rest of the data again.
+      if (!writeBuffer())
+      {
+         closeLogFile();
+         if (openLogFile())
+            writeBuffer();
+      }
+
+      Buffer.clear();
    }
 
-   // Returns true if the log file was opened, false otherwise.
+   // Returns true if the log file is open, false otherwise. The mutex must be locked.
    bool openLogFile()
    {
+      if (Fd >= 0)
+         return true;
+
       // We can't safely log in this function.
       Error error = LogFile.ensureFile();
       if (error)
@@ -286,10 +349,111 @@ struct FileLogDestination::Impl
       // the log entry from attempting to be written
       LogFile.changeFileMode(LogOptions.getFileMode());
 
-      error = LogFile.openForWrite(LogOutputStream, false);
-      if (error)
+      Fd = ::open(LogFile.getAbsolutePath().c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+      if (Fd < 0)
+         return false;
+
+      struct stat st;
+      if (::fstat(Fd, &st) != 0)
+      {
+         closeLogFile();
+         return false;
+      }
+
+      Device = st.st_dev;
+      Inode = st.st_ino;
+      FileSize = static_cast<uintmax_t>(st.st_size);
+      return true;
+   }
+
+   // Writes buffered log data to the file periodically, until stopped.
+   void runFlushThread()
+   {
+      try
+      {
+         std::unique_lock<std::mutex> lock(Mutex);
+         while (!IsStopping)
+         {
+            FlushCondition.wait_for(lock, FLUSH_INTERVAL, [this]() { return IsStopping; });
+            flush();
+         }
+      }
+      catch (...)
+      {
+         // Swallow exceptions because we'd trigger recursive logging otherwise.
+      }
+   }
+
+   // Starts the thread which writes buffered data, if it isn't running. The mutex must be locked. Returns true if the
+   // thread is running; false otherwise.
+   bool startFlushThread()
+   {
+      if (FlushThread.joinable())
+         return true;
+
+      if (IsStopping)
          return false;
 
+      FlushThreadPid = ::getpid();
+      FlushThread = std::thread(&Impl::runFlushThread, this);
+      return true;
+   }
+
+   // Stops the thread which writes buffered data and writes anything still buffered.
+   void stop()
+   {
+      try
+      {
+         {
+            std::lock_guard<std::mutex> lock(Mutex);
+            IsStopping = true;
+         }
+
+         FlushCondition.notify_all();
+         if (FlushThread.joinable())
+         {
+            // A forked child only has a copy of the thread object, and the buffered data belongs to the parent.
+            if (FlushThreadPid != ::getpid())
+            {
+               FlushThread.detach();
+               Buffer.clear();
+            }
+            else
+               FlushThread.join();
+         }
+
+         std::lock_guard<std::mutex> lock(Mutex);
+         flush();
+         closeLogFile();
+      }
+      catch (...)
+      {
+         // Swallow exceptions because we'd trigger recursive logging otherwise.
+      }
+   }
+
+   // Returns true if the whole buffer was written; false otherwise. The mutex must be locked.
+   bool writeBuffer()
+   {
+      const char* data = Buffer.data();
+      size_t remaining = Buffer.size();
+      while (remaining > 0)
+      {
+         ssize_t written = ::write(Fd, data, remaining);
+         if ((written < 0) && (errno == EINTR))
+            continue;
+
+         if (written <= 0)
+         {
+            Buffer.erase(0, Buffer.size() - remaining);
+            return false;
+         }
+
+         data += written;
+         remaining -= static_cast<size_t>(written);
+         FileSize += static_cast<uintmax_t>(written);
+      }
+
       return true;
    }
 
@@ -499,39 +663,64 @@ struct FileLogDestination::Impl
       return ((now - FirstLogLineTime.getValueOr({})) >= rotateTime);
    }
 
-   // Returns true if it is safe to log; false otherwise.
+   // Returns true if it is safe to log; false otherwise. The log file must be open and the mutex must be locked.
    bool rotateLogFile()
    {
-      // Calculate the maximum size in bytes.
-      const uintmax_t maxSize = 1048576.0 * LogOptions.getMaxSizeMb();
+      // Only rotate if we're configured to rotate. Otherwise the log file can grow unboundedly large, so it is always
+      // safe to log.
+      if (!LogOptions.doRotation())
+         return true;
 
-      // Only rotate if we're configured to rotate.
-      if (LogOptions.doRotation())
+      // The size of the file is tracked as it is written, so only the age of the file needs to be checked, and only
+      // occasionally.
+      const uintmax_t maxSize = 1048576.0 * LogOptions.getMaxSizeMb();
+      bool shouldRotate = (FileSize >= maxSize);
+      if (!shouldRotate)
       {
-         if (LogFile.getSize() >= maxSize || shouldTimeRotate())
+         std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+         if (now >= NextTimeRotationCheck)
          {
-            if (!rotateLogFileImpl(LogFile))
-               return false;
+            NextTimeRotationCheck = now + TIME_ROTATION_CHECK_INTERVAL;
+            shouldRotate = shouldTimeRotate();
          }
-
-         // successfully rotated the log (no errors while performing rotation)
-         return true;
       }
-      else
-      {
-         // we are configured not to rotate logs, which means the log file can grow unboundedly large
-         // thus, we are safe to log
+
+      if (!shouldRotate)
          return true;
-      }
+
+      closeLogFile();
+      if (!rotateLogFileImpl(LogFile))
+         return false;
+
+      // The rotated file may have been replaced by a file that is also due for rotation by time.
+      NextTimeRotationCheck = std::chrono::steady_clock::time_point();
+      return openLogFile();
    }
 
    FileLogOptions LogOptions;
    FilePath LogFile;
    std::string LogName;
    std::mutex Mutex;
-   std::shared_ptr<std::ostream> LogOutputStream;
    Optional<DateTime> FirstLogLineTime;
 
+   // The open log file, and the identity and size of the file it refers to.
+   int Fd = -1;
+   dev_t Device = 0;
+   ino_t Inode = 0;
+   uintmax_t FileSize = 0;
+
+   // Log data which has not been written to the file yet.
+   std::string Buffer;
+
+   // When the age of the log file should next be checked.
+   std::chrono::steady_clock::time_point NextTimeRotationCheck;
+
+   // The thread which periodically writes buffered log data to the file.
+   std::thread FlushThread;
+   std::condition_variable FlushCondition;
+   pid_t FlushThreadPid = 0;
+   bool IsStopping = false;
+
    std::shared_ptr<launcher_plugins::logging::SyslogDestination> SyslogDest;
 };
 
@@ -557,8 +746,7 @@ FileLogDestination::FileLogDestination(
 
 FileLogDestination::~FileLogDestination()
 {
-   if (m_impl->LogOutputStream.get())
-      m_impl->LogOutputStream->flush();
+   m_impl->stop();
 }
 
 std::string FileLogDestination::path()
@@ -569,7 +757,16 @@ std::string FileLogDestination::path()
 void FileLogDestination::refresh(const RefreshParams& in_refreshParams)
 {
    // Close the log file to ensure that if we just forked old FDs are cleared out
-   m_impl->closeLogFile();
+   try
+   {
+      std::lock_guard<std::mutex> lock(m_impl->Mutex);
+      m_impl->flush();
+      m_impl->closeLogFile();
+   }
+   catch (...)
+   {
+      // Swallow exceptions because we'd trigger recursive logging otherwise.
+   }
 
    if (in_refreshParams.newUser)
    {
@@ -591,48 +788,26 @@ void FileLogDestination::writeLog(LogLevel in_logLevel, const std::string& in_me
    if (in_logLevel > m_logLevel)
       return;
 
+   // First write to syslog if configured. This never blocks, but don't hold the file's mutex while doing it anyway.
+   if (in_logLevel <= LogLevel::WARN && m_impl->SyslogDest)
+      m_impl->SyslogDest->writeLog(in_logLevel, in_message);
+
    // Lock the mutex before attempting to write.
    try
    {
       std::lock_guard<std::mutex> lock(m_impl->Mutex);
 
-         // First write to syslog if configured
-         if (in_logLevel <= LogLevel::WARN && m_impl->SyslogDest)
-            m_impl->SyslogDest->writeLog(in_logLevel, in_message);
-
       // Check to make sure path to file is valid. If not, log nothing.
-      if (!m_impl->verifyLogFilePath())
-         return;
-
-      // Rotate the log file if necessary. If it fails to rotate, log nothing.
-      if (!m_impl->rotateLogFile())
-         return;
-
-      // Open the log file. If it fails to open, log nothing.
-      if (!m_impl->openLogFile())
-      {
-         m_impl->closeLogFile();
+      if (m_impl->LogFile.isEmpty() && !m_impl->verifyLogFilePath())
          return;
-      }
-
-      (*m_impl->LogOutputStream) << in_message;
-      m_impl->LogOutputStream->flush();
 
-      // If the output stream has bad state after writing, it might have been closed. Try re-opening it and writing the
-      // message again. Often it is not possible to tell that a stream has failed until a write is attempted.
-      if (!m_impl->LogOutputStream->good())
-      {
-         if (!m_impl->openLogFile())
-         {
-            m_impl->closeLogFile();
-            return;
-         }
-
-         (*m_impl->LogOutputStream) << in_message;
-         m_impl->LogOutputStream->flush();
-      }
-
-      m_impl->closeLogFile();
+      // Buffer the message. Warnings and errors are written right away so they aren't lost if the process crashes;
+      // anything else is written once enough has been buffered, or by the flush thread shortly after.
+      m_impl->Buffer.append(in_message);
+      if ((in_logLevel <= LogLevel::WARN) ||
+         (m_impl->Buffer.size() >= MAX_BUFFER_SIZE) ||
+         !m_impl->startFlushThread())
+         m_impl->flush();
    }
    catch (...)
    {
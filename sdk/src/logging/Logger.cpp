@@ -23,16 +23,26 @@
 
 #include <logging/Logger.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
-#include <sstream>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <mutex>
+#include <set>
+#include <thread>
 #include <typeindex>
 #include <unordered_map>
 
+#include <pthread.h>
+#include <unistd.h>
+
 #include <boost/algorithm/string.hpp>
 #include <Noncopyable.hpp>
 #include <Optional.hpp>
 
-#include <system/DateTime.hpp>
 #include <Error.hpp>
 #include <logging/FileLogDestination.hpp>
 #include <json/Json.hpp>
@@ -40,6 +50,8 @@
 #include <SafeConvert.hpp>
 #include <logging/StderrLogDestination.hpp>
 
+#include "AsyncLogQueue.hpp"
+
 namespace rstudio {
 namespace launcher_plugins {
 namespace logging {
@@ -51,46 +63,26 @@ namespace {
 
 constexpr const char* s_loggedFrom = "LOGGED FROM";
 
-std::ostream& operator<<(std::ostream& io_ostream, LogLevel in_logLevel)
+const char* logLevelToString(LogLevel in_logLevel)
 {
    switch (in_logLevel)
    {
       case LogLevel::ERR:
-      {
-         io_ostream << "ERROR";
-         break;
-      }
+         return "ERROR";
       case LogLevel::WARN:
-      {
-         io_ostream << "WARNING";
-         break;
-      }
+         return "WARNING";
       case LogLevel::DEBUG:
-      {
-         io_ostream << "DEBUG";
-         break;
-      }
+         return "DEBUG";
       case LogLevel::INFO:
-      {
-         io_ostream << "INFO";
-         break;
-      }
+         return "INFO";
       case LogLevel::OFF:
-      {
-         io_ostream << "OFF";
-         break;
-      }
+         return "OFF";
       default:
       {
          assert(false); // This shouldn't be possible
-         if (in_logLevel > LogLevel::INFO)
-            io_ostream << "INFO";
-         else
-            io_ostream << "OFF";
+         return (in_logLevel > LogLevel::INFO) ? "INFO" : "OFF";
       }
    }
-
-   return io_ostream;
 }
 
 LogLevel logLevelFromStr(const std::string& in_str)
@@ -234,71 +226,494 @@ std::string logMessagePropertiesToString(const LogMessageProperties& in_properti
    return "[" + boost::join(properties, ", ") + "]";
 }
 
-std::string formatLogMessage(
+/**
+ * @brief Appends the current time, in the same ISO 8601 format as system::DateTime::toString, to a buffer.
+ *
+ * The date and time of day are only formatted once per second on each thread.
+ *
+ * @param io_buffer     The buffer to append to.
+ */
+void appendTimestamp(std::string& io_buffer)
+{
+   struct TimestampCache
+   {
+      TimestampCache() : Second(-1), PrefixLength(0) { Prefix[0] = '\0'; }
+
+      std::time_t Second;
+      char Prefix[32];
+      size_t PrefixLength;
+   };
+   thread_local TimestampCache cache;
+
+   timespec now;
+   ::clock_gettime(CLOCK_REALTIME, &now);
+   if (now.tv_sec != cache.Second)
+   {
+      std::tm utcTime;
+      ::gmtime_r(&now.tv_sec, &utcTime);
+      cache.PrefixLength = std::strftime(cache.Prefix, sizeof(cache.Prefix), "%Y-%m-%dT%H:%M:%S", &utcTime);
+      cache.Second = now.tv_sec;
+   }
+
+   io_buffer.append(cache.Prefix, cache.PrefixLength);
+
+   // Like the %F format flag, fractional seconds are only written when they are not zero.
+   long microseconds = now.tv_nsec / 1000;
+   if (microseconds != 0)
+   {
+      char fraction[7] = { '.' };
+      for (int i = 6; i > 0; --i, microseconds /= 10)
+         fraction[i] = static_cast<char>('0' + (microseconds % 10));
+      io_buffer.append(fraction, sizeof(fraction));
+   }
+
+   io_buffer.push_back('Z');
+}
+
+/**
+ * @brief Appends a message to a buffer without trailing whitespace and with newlines replaced by "|||", since each log
+ *        message should be one distinct line.
+ *
+ * @param in_message    The message to append.
+ * @param io_buffer     The buffer to append to.
+ */
+void appendMessage(const std::string& in_message, std::string& io_buffer)
+{
+   size_t end = in_message.size();
+   while ((end > 0) && std::isspace(static_cast<unsigned char>(in_message[end - 1])))
+      --end;
+
+   size_t start = 0;
+   size_t newline = in_message.find('\n');
+   while (newline < end)
+   {
+      io_buffer.append(in_message, start, newline - start).append("|||");
+      start = newline + 1;
+      newline = in_message.find('\n', start);
+   }
+
+   io_buffer.append(in_message, start, end - start);
+}
+
+/**
+ * @brief Appends a string to a buffer as a quoted JSON string, escaping it the same way json::Value::write does.
+ *
+ * @param in_str        The string to append.
+ * @param io_buffer     The buffer to append to.
+ */
+void appendJsonString(const std::string& in_str, std::string& io_buffer)
+{
+   static const char* const s_hexDigits = "0123456789ABCDEF";
+
+   io_buffer.push_back('"');
+
+   size_t start = 0;
+   for (size_t i = 0; i < in_str.size(); ++i)
+   {
+      const unsigned char c = static_cast<unsigned char>(in_str[i]);
+      if ((c >= 0x20) && (c != '"') && (c != '\\'))
+         continue;
+
+      io_buffer.append(in_str, start, i - start);
+      start = i + 1;
+
+      io_buffer.push_back('\\');
+      switch (c)
+      {
+         case '"':
+         case '\\':
+            io_buffer.push_back(static_cast<char>(c));
+            break;
+         case '\b':
+            io_buffer.push_back('b');
+            break;
+         case '\f':
+            io_buffer.push_back('f');
+            break;
+         case '\n':
+            io_buffer.push_back('n');
+            break;
+         case '\r':
+            io_buffer.push_back('r');
+            break;
+         case '\t':
+            io_buffer.push_back('t');
+            break;
+         default:
+         {
+            const char escape[] = { 'u', '0', '0', s_hexDigits[c >> 4], s_hexDigits[c & 0xF] };
+            io_buffer.append(escape, sizeof(escape));
+         }
+      }
+   }
+
+   io_buffer.append(in_str, start, std::string::npos);
+   io_buffer.push_back('"');
+}
+
+/**
+ * @brief Formats a log message as a single line.
+ *
+ * @param in_logLevel           The log level of the message.
+ * @param in_message            The message to log, if no error is being logged.
+ * @param in_programId          The ID of the program which is logging the message.
+ * @param humanReadableFormat   Whether to format the message for pretty log destinations or JSON log destinations.
+ * @param in_properties         The LogMessageProperties to log with the message.
+ * @param out_formattedMessage  The formatted message. Any previous contents are replaced, but its storage is reused.
+ * @param in_loggedFrom         The location from which the message was logged.
+ * @param in_error              The error (if any) to log.
+ */
+void formatLogMessage(
    LogLevel in_logLevel,
    const std::string& in_message,
    const std::string& in_programId,
    bool humanReadableFormat,
    const Optional<LogMessageProperties>& in_properties,
+   std::string& out_formattedMessage,
    const ErrorLocation& in_loggedFrom = ErrorLocation(),
    const Error& in_error = Success())
 {
-   system::DateTime time;
-
-   // Don't allow newlines in messages since each log message should be one distinct line
-   std::string message = boost::algorithm::trim_right_copy(in_message);
-   boost::algorithm::replace_all(message, "\n", "|||");
+   std::string& buffer = out_formattedMessage;
+   buffer.clear();
 
    if (humanReadableFormat)
    {
-      std::ostringstream oss;
-
-      oss << time.toString()
-          << " [" << in_programId << "] ";
+      appendTimestamp(buffer);
+      buffer.append(" [").append(in_programId).append("] ").append(logLevelToString(in_logLevel)).push_back(' ');
 
       if (in_error)
-         oss << in_logLevel << " " << in_error.asString();
+         buffer.append(in_error.asString());
       else
-         oss << in_logLevel << " " << message;
+         appendMessage(in_message, buffer);
 
       if (in_properties)
       {
-          std::string properties = logMessagePropertiesToString(in_properties.getValueOr(LogMessageProperties()));
-          oss << " " << properties;
+         buffer.push_back(' ');
+         buffer.append(logMessagePropertiesToString(in_properties.getValueOr(LogMessageProperties())));
       }
 
       if (in_loggedFrom.hasLocation())
-         oss << s_delim << " " << s_loggedFrom << ": " << cleanDelimiters(in_loggedFrom.asString());
-
-      oss << std::endl;
-
-      return oss.str();
+      {
+         buffer.push_back(s_delim);
+         buffer.append(" ").append(s_loggedFrom).append(": ").append(cleanDelimiters(in_loggedFrom.asString()));
+      }
    }
    else
    {
-      json::Object logObject;
-      logObject["time"] = time.toString();
-      logObject["service"] = in_programId;
-
-      std::ostringstream logLevel;
-      logLevel << in_logLevel;
-      logObject["level"] = logLevel.str();
+      // Write the object directly rather than building a json::Object, in the same field order.
+      buffer.append("{\"time\":\"");
+      appendTimestamp(buffer);
+      buffer.append("\",\"service\":");
+      appendJsonString(in_programId, buffer);
+      buffer.append(",\"level\":\"").append(logLevelToString(in_logLevel)).push_back('"');
 
       if (in_error)
-         logObject["error"] = errorToJson(in_error);
+      {
+         buffer.append(",\"error\":").append(errorToJson(in_error).write());
+      }
       else
-         logObject["message"] = message;
+      {
+         thread_local std::string message;
+         message.clear();
+         appendMessage(in_message, message);
+
+         buffer.append(",\"message\":");
+         appendJsonString(message, buffer);
+      }
 
       if (in_properties)
       {
-         json::Object properties = logMessagePropertiesToJson(in_properties.getValueOr(LogMessageProperties()));
-         logObject["properties"] = properties;
+         buffer.append(",\"properties\":");
+         buffer.append(logMessagePropertiesToJson(in_properties.getValueOr(LogMessageProperties())).write());
       }
 
-      return logObject.write() + "\n";
+      buffer.push_back('}');
    }
+
+   buffer.push_back('\n');
 }
 
+/**
+ * @brief Buffers into which a thread formats log messages, so their storage can be reused.
+ */
+struct FormatBuffers
+{
+   FormatBuffers() : IsInUse(false) { }
+
+   // Whether a message is currently being formatted into or written from these buffers.
+   bool IsInUse;
+
+   // The message formatted for JSON log destinations.
+   std::string JsonMessage;
+
+   // The message formatted for pretty log destinations.
+   std::string PrettyMessage;
+};
+
+thread_local FormatBuffers s_formatBuffers;
+
+/**
+ * @brief Marks format buffers as in use for the lifetime of this object.
+ */
+struct FormatBuffersLease : Noncopyable
+{
+   explicit FormatBuffersLease(FormatBuffers& io_buffers) : Buffers(io_buffers) { Buffers.IsInUse = true; }
+
+   ~FormatBuffersLease() { Buffers.IsInUse = false; }
+
+   FormatBuffers& Buffers;
+};
+
+// The maximum number of records the log writer thread writes to the destinations per acquisition of the logger's lock.
+constexpr size_t ASYNC_LOG_BATCH_SIZE = 256;
+
+// How long a producer waits for room in a full queue before checking again.
+constexpr std::chrono::milliseconds ASYNC_LOG_BLOCK_WAIT(10);
+
+// How long the log writer thread waits for new records before checking again.
+constexpr std::chrono::milliseconds ASYNC_LOG_IDLE_WAIT(1000);
+
+// The minimum amount of time between warnings about dropped log messages.
+constexpr std::chrono::seconds DROPPED_LOG_REPORT_INTERVAL(10);
+
+/**
+ * @brief Function which writes a batch of log records to the log destinations.
+ */
+typedef std::function<void(const std::vector<QueuedLogRecord>&)> WriteLogRecords;
+
+/**
+ * @brief Thread which writes queued log records to the log destinations.
+ */
+struct AsyncLogWriter : Noncopyable
+{
+   /**
+    * @brief Constructor.
+    *
+    * @param in_queueCapacity       The maximum number of records which may be queued.
+    * @param in_overflowPolicy      What to do with a record that is pushed while the queue is full.
+    * @param io_droppedCount        The count of dropped records, which this writer increments.
+    * @param in_writeRecords        Function which writes a batch of records to the log destinations.
+    */
+   AsyncLogWriter(
+      size_t in_queueCapacity,
+      AsyncLogOverflowPolicy in_overflowPolicy,
+      std::atomic<uint64_t>& io_droppedCount,
+      const WriteLogRecords& in_writeRecords) :
+         BlockedProducers(0),
+         DroppedCount(io_droppedCount),
+         IsStopping(false),
+         IsWaiting(false),
+         OverflowPolicy(in_overflowPolicy),
+         Queue(in_queueCapacity),
+         ReportedDroppedCount(io_droppedCount.load()),
+         WriterPid(0),
+         WriteRecords(in_writeRecords)
+   {
+   }
+
+   /**
+    * @brief Checks whether the calling thread is the log writer thread.
+    *
+    * @return True if the calling thread is the log writer thread; false otherwise.
+    */
+   bool isWriterThread() const
+   {
+      return std::this_thread::get_id() == WriterThreadId;
+   }
+
+   /**
+    * @brief Queues a record, applying the overflow policy if the queue is full.
+    *
+    * @param io_record      The record to queue.
+    */
+   void push(QueuedLogRecord& io_record)
+   {
+      if (!Queue.tryPush(io_record))
+      {
+         if ((OverflowPolicy == AsyncLogOverflowPolicy::DROP) ||
+            ((OverflowPolicy == AsyncLogOverflowPolicy::DROP_DEBUG) && (io_record.Level >= LogLevel::DEBUG)))
+         {
+            DroppedCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+         }
+
+         BlockedProducers.fetch_add(1);
+         while (!Queue.tryPush(io_record))
+         {
+            wake();
+            std::unique_lock<std::mutex> lock(Mutex);
+            SpaceCondition.wait_for(lock, ASYNC_LOG_BLOCK_WAIT);
+         }
+         BlockedProducers.fetch_sub(1);
+      }
+
+      // Pairs with the fence in run, so either the writer sees the new record or this thread sees that it is waiting.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (IsWaiting.load(std::memory_order_relaxed))
+         wake();
+   }
+
+   /**
+    * @brief Warns about any records that were dropped since the last warning, if enough time has passed.
+    *
+    * @param in_force       Whether to warn regardless of how long ago the last warning was.
+    */
+   void reportDroppedRecords(bool in_force)
+   {
+      const uint64_t droppedCount = DroppedCount.load(std::memory_order_relaxed);
+      if (droppedCount == ReportedDroppedCount)
+         return;
+
+      const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+      if (!in_force && (now - LastReportTime < DROPPED_LOG_REPORT_INTERVAL))
+         return;
+
+      // This thread logs synchronously, so this can't recurse into the queue.
+      logWarningMessage(
+         "Dropped " + std::to_string(droppedCount - ReportedDroppedCount) +
+         " log messages because the asynchronous log queue was full.");
+      ReportedDroppedCount = droppedCount;
+      LastReportTime = now;
+   }
+
+   /**
+    * @brief The main loop of the log writer thread.
+    */
+   void run()
+   {
+      std::vector<QueuedLogRecord> batch;
+      batch.reserve(ASYNC_LOG_BATCH_SIZE);
+
+      QueuedLogRecord record;
+      while (true)
+      {
+         while ((batch.size() < ASYNC_LOG_BATCH_SIZE) && Queue.tryPop(record))
+            batch.push_back(std::move(record));
+
+         if (!batch.empty())
+         {
+            WriteRecords(batch);
+            batch.clear();
+
+            if (BlockedProducers.load() > 0)
+            {
+               std::lock_guard<std::mutex> lock(Mutex);
+               SpaceCondition.notify_all();
+            }
+
+            reportDroppedRecords(false);
+            continue;
+         }
+
+         reportDroppedRecords(false);
+
+         std::unique_lock<std::mutex> lock(Mutex);
+         IsWaiting.store(true, std::memory_order_relaxed);
+         std::atomic_thread_fence(std::memory_order_seq_cst);
+         if (Queue.isEmpty())
+         {
+            // Stop is only requested once no more records can be pushed, so the queue is fully drained here.
+            if (IsStopping)
+               break;
+
+            WakeCondition.wait_for(lock, ASYNC_LOG_IDLE_WAIT);
+         }
+         IsWaiting.store(false, std::memory_order_relaxed);
+      }
+
+      reportDroppedRecords(true);
+   }
+
+   /**
+    * @brief Starts the log writer thread.
+    */
+   void start()
+   {
+      WriterPid = ::getpid();
+      WriterThread = std::thread(&AsyncLogWriter::run, this);
+      WriterThreadId = WriterThread.get_id();
+   }
+
+   /**
+    * @brief Stops the log writer thread after all queued records have been written. No records may be pushed after
+    *        this method is invoked.
+    */
+   void stop()
+   {
+      if (!WriterThread.joinable())
+         return;
+
+      // The log writer thread does not exist in a forked child process.
+      if (WriterPid != ::getpid())
+      {
+         WriterThread.detach();
+         return;
+      }
+
+      {
+         std::lock_guard<std::mutex> lock(Mutex);
+         IsStopping = true;
+         WakeCondition.notify_all();
+      }
+
+      WriterThread.join();
+   }
+
+   /**
+    * @brief Wakes the log writer thread.
+    */
+   void wake()
+   {
+      std::lock_guard<std::mutex> lock(Mutex);
+      WakeCondition.notify_one();
+   }
+
+   // The number of producers waiting for room in the queue.
+   std::atomic<size_t> BlockedProducers;
+
+   // The count of dropped records.
+   std::atomic<uint64_t>& DroppedCount;
+
+   // Whether the log writer thread has been asked to stop.
+   bool IsStopping;
+
+   // Whether the log writer thread is waiting for new records.
+   std::atomic<bool> IsWaiting;
+
+   // The last time a warning about dropped records was logged.
+   std::chrono::steady_clock::time_point LastReportTime;
+
+   // Mutex which protects IsStopping and is used with the condition variables.
+   std::mutex Mutex;
+
+   // What to do with a record that is pushed while the queue is full.
+   const AsyncLogOverflowPolicy OverflowPolicy;
+
+   // The queue of records waiting to be written.
+   AsyncLogQueue Queue;
+
+   // The count of dropped records when the last warning about dropped records was logged.
+   uint64_t ReportedDroppedCount;
+
+   // Notifies blocked producers that there is room in the queue.
+   std::condition_variable SpaceCondition;
+
+   // Notifies the log writer thread that there are new records or that it should stop.
+   std::condition_variable WakeCondition;
+
+   // The process in which the log writer thread was started.
+   pid_t WriterPid;
+
+   // The log writer thread.
+   std::thread WriterThread;
+
+   // The ID of the log writer thread.
+   std::thread::id WriterThreadId;
+
+   // Function which writes a batch of records to the log destinations.
+   const WriteLogRecords WriteRecords;
+};
+
 } // anonymous namespace
 
 // Logger Object =======================================================================================================
@@ -355,16 +770,117 @@ public:
    void writePassthroughMessageToDestinations(const std::string& in_source,
                                               const std::string& in_message);
 
+   /**
+    * @brief Stops the log writer thread, if any, after writing all queued records.
+    */
+   void disableAsyncLogging();
+
+   /**
+    * @brief Starts a log writer thread with a new queue.
+    *
+    * @param in_queueCapacity       The maximum number of records which may be queued.
+    * @param in_overflowPolicy      What to do with a record that is logged while the queue is full.
+    */
+   void enableAsyncLogging(size_t in_queueCapacity, AsyncLogOverflowPolicy in_overflowPolicy);
+
+   /**
+    * @brief Queues a record for the log writer thread, if asynchronous logging is enabled.
+    *
+    * Records logged by the log writer thread itself are never queued, since it may be the only thread that can make
+    * room in the queue.
+    *
+    * @param io_record      The record to queue.
+    *
+    * @return True if the record was queued or dropped; false if it should be written synchronously.
+    */
+   bool tryQueueRecord(QueuedLogRecord& io_record);
+
+   /**
+    * @brief Writes a record to the log destinations which were registered for its section. The caller must hold at
+    *        least a read lock on Mutex.
+    *
+    * @param in_record      The record to write.
+    */
+   void writeRecordToDestinations(const QueuedLogRecord& in_record);
+
+   /**
+    * @brief Writes a batch of records to the log destinations under a single read lock.
+    *
+    * @param in_records     The records to write.
+    */
+   void writeRecordsToDestinations(const std::vector<QueuedLogRecord>& in_records);
+
+   /**
+    * @brief Checks, without locking, whether a message could be written by any registered log destination.
+    *
+    * @param in_logLevel    The log level of the message.
+    * @param in_section     The section to which the message would be logged.
+    *
+    * @return True if a message of the specified level could be written; false otherwise.
+    */
+   bool isLevelEnabled(LogLevel in_logLevel, const std::string& in_section) const
+   {
+      if (in_logLevel > MaxLogLevel.load(std::memory_order_relaxed))
+         return false;
+
+      // A message to a section with its own destinations may be more detailed than the default destinations accept.
+      if (!in_section.empty() && HasSections.load(std::memory_order_relaxed))
+         return true;
+
+      return in_logLevel <= DefaultMaxLogLevel.load(std::memory_order_relaxed);
+   }
+
+   /**
+    * @brief Recomputes the maximum log levels after a log destination was added or removed. The caller must hold the
+    *        write lock on Mutex.
+    */
+   void updateMaxLogLevels()
+   {
+      LogLevel defaultMax = LogLevel::OFF;
+      for (const auto& dest: DefaultLogDestinations)
+         defaultMax = std::max(defaultMax, dest.second->getLogLevel());
+
+      LogLevel max = defaultMax;
+      for (const auto& section: SectionedLogDestinations)
+      {
+         for (const auto& dest: section.second)
+            max = std::max(max, dest.second->getLogLevel());
+      }
+
+      DefaultMaxLogLevel.store(defaultMax, std::memory_order_relaxed);
+      HasSections.store(!SectionedLogDestinations.empty(), std::memory_order_relaxed);
+      MaxLogLevel.store(max, std::memory_order_relaxed);
+   }
+
    /**
     * @brief Constructor to prevent multiple instances of Logger.
     */
    Logger() :
+      DefaultMaxLogLevel(LogLevel::OFF),
+      HasSections(false),
       MaxLogLevel(LogLevel::OFF),
-      ProgramId("")
+      ProgramId(""),
+      AsyncProducers(0),
+      DroppedMessageCount(0),
+      IsAsync(false)
    { };
 
+   /**
+    * @brief Destructor. Writes any queued records.
+    */
+   ~Logger()
+   {
+      disableAsyncLogging();
+   }
+
+   // The maximum level of message to write to the default log destinations.
+   std::atomic<LogLevel> DefaultMaxLogLevel;
+
+   // Whether any sectioned log destinations are registered.
+   std::atomic<bool> HasSections;
+
    // The maximum level of message to write across all log sections.
-   LogLevel MaxLogLevel;
+   std::atomic<LogLevel> MaxLogLevel;
 
    // The ID of the program fr which to write logs.
    std::string ProgramId;
@@ -379,6 +895,21 @@ public:
 
    // The read-write mutex to protect the maps.
    system::ReaderWriterMutex Mutex;
+
+   // The mutex which serializes enabling and disabling asynchronous logging.
+   std::mutex AsyncMutex;
+
+   // The number of threads which may currently be using AsyncWriter.
+   std::atomic<size_t> AsyncProducers;
+
+   // The log writer thread, if asynchronous logging is enabled.
+   std::unique_ptr<AsyncLogWriter> AsyncWriter;
+
+   // The number of records dropped because the queue was full.
+   std::atomic<uint64_t> DroppedMessageCount;
+
+   // Whether asynchronous logging is enabled.
+   std::atomic<bool> IsAsync;
 };
 
 Logger& logger()
@@ -394,14 +925,10 @@ void Logger::writeMessageToDestinations(
    const ErrorLocation& in_loggedFrom,
    const Error& in_error)
 {
-   READ_LOCK_BEGIN(Mutex)
-
    // Don't log this message, it's too detailed for any of the logs.
-   if (in_logLevel > MaxLogLevel)
+   if (!isLevelEnabled(in_logLevel, in_section))
       return;
 
-   RW_LOCK_END(false)
-
    Optional<LogMessageProperties> props ={};
    std::string message = in_action(&props);
    writeMessageToDestinations(in_logLevel, message, in_section, props, in_loggedFrom, in_error);
@@ -415,12 +942,15 @@ void Logger::writeMessageToDestinations(
    const ErrorLocation& in_loggedFrom,
    const Error& in_error)
 {
-   READ_LOCK_BEGIN(Mutex)
-
    // Don't log this message, it's too detailed for any of the logs.
-   if (in_logLevel > MaxLogLevel)
+   if (!isLevelEnabled(in_logLevel, in_section))
       return;
 
+   QueuedLogRecord record;
+   bool shouldQueue = false;
+
+   READ_LOCK_BEGIN(Mutex)
+
    LogMap* logMap = &DefaultLogDestinations;
    if (!in_section.empty())
    {
@@ -444,20 +974,49 @@ void Logger::writeMessageToDestinations(
          prettyFormat = true;
    }
 
-   std::string prettyMessage, jsonMessage;
+   // Reuse this thread's format buffers, unless a destination is logging from within writeLog.
+   FormatBuffers localBuffers;
+   FormatBuffers& buffers = s_formatBuffers.IsInUse ? localBuffers : s_formatBuffers;
+   FormatBuffersLease lease(buffers);
+
+   std::string& prettyMessage = buffers.PrettyMessage;
+   std::string& jsonMessage = buffers.JsonMessage;
+   prettyMessage.clear();
+   jsonMessage.clear();
    if (prettyFormat)
-      prettyMessage = formatLogMessage(in_logLevel, in_message, ProgramId, true, in_properties, in_loggedFrom, in_error);
+      formatLogMessage(in_logLevel, in_message, ProgramId, true, in_properties, prettyMessage, in_loggedFrom, in_error);
    if (jsonFormat)
-      jsonMessage = formatLogMessage(in_logLevel, in_message, ProgramId, false, in_properties, in_loggedFrom, in_error);
+      formatLogMessage(in_logLevel, in_message, ProgramId, false, in_properties, jsonMessage, in_loggedFrom, in_error);
 
-   for (auto iter = logMap->begin(); iter != destEnd; ++iter)
+   if (!IsAsync.load(std::memory_order_relaxed))
    {
-      std::string& messageToWrite = iter->second->getLogMessageFormatType() == LogMessageFormatType::PRETTY ?
-               prettyMessage : jsonMessage;
-      iter->second->writeLog(in_logLevel, messageToWrite);
+      for (auto iter = logMap->begin(); iter != destEnd; ++iter)
+      {
+         std::string& messageToWrite = iter->second->getLogMessageFormatType() == LogMessageFormatType::PRETTY ?
+                  prettyMessage : jsonMessage;
+         iter->second->writeLog(in_logLevel, messageToWrite);
+      }
+
+      return;
    }
 
+   // Hand the formatted message to the log writer thread once the lock has been released.
+   record.Level = in_logLevel;
+   record.Section = in_section;
+   record.PrettyMessage = prettyMessage;
+   record.JsonMessage = jsonMessage;
+   shouldQueue = true;
+
    RW_LOCK_END(false)
+
+   if (shouldQueue && !tryQueueRecord(record))
+   {
+      READ_LOCK_BEGIN(Mutex)
+      {
+         writeRecordToDestinations(record);
+      }
+      RW_LOCK_END(false)
+   }
 }
 
 void Logger::writePassthroughMessageToDestinations(const std::string& in_source,
@@ -504,20 +1063,297 @@ void Logger::writePassthroughMessageToDestinations(const std::string& in_source,
       }
    }
 
-   LogLevel level = logLevelFromStr(logLevel);
+   QueuedLogRecord record;
+   record.IsPassthrough = true;
+   record.Level = logLevelFromStr(logLevel);
+   record.PrettyMessage = std::move(logMessage);
+   if (tryQueueRecord(record))
+      return;
 
    READ_LOCK_BEGIN(Mutex)
+   {
+      writeRecordToDestinations(record);
+   }
+   RW_LOCK_END(false)
+}
 
-   LogMap* logMap = &DefaultLogDestinations;
-   const auto destEnd = logMap->end();
-   for (auto iter = logMap->begin(); iter != destEnd; ++iter)
+void Logger::disableAsyncLogging()
+{
+   std::lock_guard<std::mutex> asyncLock(AsyncMutex);
+   if (AsyncWriter == nullptr)
+      return;
+
+   // Once no producer can still be using the writer, every record that will ever be queued has been queued.
+   IsAsync.store(false);
+   while (AsyncProducers.load() != 0)
+      std::this_thread::yield();
+
+   AsyncWriter->stop();
+   AsyncWriter.reset();
+}
+
+void Logger::enableAsyncLogging(size_t in_queueCapacity, AsyncLogOverflowPolicy in_overflowPolicy)
+{
+   // The log writer thread does not exist in a forked child process, so the child must log synchronously.
+   static std::once_flag forkHandlerFlag;
+   std::call_once(
+      forkHandlerFlag,
+      []()
+      {
+         ::pthread_atfork(
+            nullptr,
+            nullptr,
+            []()
+            {
+               logger().IsAsync.store(false);
+               logger().AsyncProducers.store(0);
+            });
+      });
+
+   disableAsyncLogging();
+
+   std::lock_guard<std::mutex> asyncLock(AsyncMutex);
+   AsyncWriter.reset(
+      new AsyncLogWriter(
+         in_queueCapacity,
+         in_overflowPolicy,
+         DroppedMessageCount,
+         [this](const std::vector<QueuedLogRecord>& in_records)
+         {
+            writeRecordsToDestinations(in_records);
+         }));
+   AsyncWriter->start();
+   IsAsync.store(true);
+}
+
+bool Logger::tryQueueRecord(QueuedLogRecord& io_record)
+{
+   AsyncProducers.fetch_add(1);
+
+   bool isQueued = false;
+   if (IsAsync.load() && !AsyncWriter->isWriterThread())
+   {
+      AsyncWriter->push(io_record);
+      isQueued = true;
+   }
+
+   AsyncProducers.fetch_sub(1);
+   return isQueued;
+}
+
+void Logger::writeRecordToDestinations(const QueuedLogRecord& in_record)
+{
+   if (in_record.IsPassthrough)
+   {
+      for (const auto& dest: DefaultLogDestinations)
+         dest.second->writeLog(in_record.Level, in_record.PrettyMessage);
+
+      return;
+   }
+
+   const LogMap* logMap = &DefaultLogDestinations;
+   if (!in_record.Section.empty())
+   {
+      auto logDestIter = SectionedLogDestinations.find(in_record.Section);
+      if (logDestIter != SectionedLogDestinations.end())
+         logMap = &logDestIter->second;
+   }
+
+   for (const auto& dest: *logMap)
    {
-      iter->second->writeLog(level, logMessage);
+      // Skip destinations of a format that was not registered when the message was formatted.
+      const std::string& message = dest.second->getLogMessageFormatType() == LogMessageFormatType::PRETTY ?
+         in_record.PrettyMessage : in_record.JsonMessage;
+      if (!message.empty())
+         dest.second->writeLog(in_record.Level, message);
    }
+}
 
+void Logger::writeRecordsToDestinations(const std::vector<QueuedLogRecord>& in_records)
+{
+   READ_LOCK_BEGIN(Mutex)
+   {
+      for (const QueuedLogRecord& record: in_records)
+         writeRecordToDestinations(record);
+   }
    RW_LOCK_END(false)
 }
 
+// LogRateLimiter ======================================================================================================
+namespace {
+
+/**
+ * @brief The rate limiters which currently exist, so that their suppressed messages can be reported.
+ */
+struct RateLimiterRegistry
+{
+   // The mutex which protects the set of rate limiters.
+   std::mutex Mutex;
+
+   // The rate limiters which currently exist.
+   std::set<LogRateLimiter*> RateLimiters;
+};
+
+RateLimiterRegistry& rateLimiterRegistry()
+{
+   // Rate limiters register themselves on construction, so the registry outlives function-local static ones.
+   static RateLimiterRegistry registry;
+   return registry;
+}
+
+} // anonymous namespace
+
+struct LogRateLimiter::Impl
+{
+   Impl(
+      size_t in_maxMessages,
+      int64_t in_intervalMicroseconds,
+      size_t in_sampleRate,
+      LogLevel in_logLevel,
+      const ErrorLocation& in_location) :
+         IntervalCount(0),
+         IntervalMicroseconds(in_intervalMicroseconds),
+         IntervalStart(now()),
+         Level(in_logLevel),
+         Location(in_location),
+         MaxMessages(in_maxMessages),
+         SampleRate(in_sampleRate),
+         SuppressedCount(0)
+   {
+   }
+
+   static int64_t now()
+   {
+      return std::chrono::duration_cast<std::chrono::microseconds>(
+         std::chrono::steady_clock::now().time_since_epoch()).count();
+   }
+
+   // The number of messages seen in the current interval.
+   std::atomic<uint64_t> IntervalCount;
+
+   // The length of an interval.
+   const int64_t IntervalMicroseconds;
+
+   // The time at which the current interval started.
+   std::atomic<int64_t> IntervalStart;
+
+   // The log level at which to report suppressed messages on their own.
+   const LogLevel Level;
+
+   // The location of the rate limited call site.
+   const ErrorLocation Location;
+
+   // The maximum number of messages to write in each interval.
+   const uint64_t MaxMessages;
+
+   // If not 0, one of every SampleRate messages beyond the maximum is written.
+   const uint64_t SampleRate;
+
+   // The number of messages suppressed since the last message that was written.
+   std::atomic<uint64_t> SuppressedCount;
+};
+
+PRIVATE_IMPL_DELETER_IMPL(LogRateLimiter)
+
+LogRateLimiter::LogRateLimiter(size_t in_maxMessages, const system::TimeDuration& in_interval, size_t in_sampleRate) :
+   LogRateLimiter(in_maxMessages, in_interval, in_sampleRate, LogLevel::ERR, ErrorLocation())
+{
+}
+
+LogRateLimiter::LogRateLimiter(
+   size_t in_maxMessages,
+   const system::TimeDuration& in_interval,
+   size_t in_sampleRate,
+   LogLevel in_logLevel,
+   const ErrorLocation& in_location) :
+      m_impl(
+         new Impl(
+            in_maxMessages,
+            std::chrono::duration_cast<std::chrono::microseconds>(in_interval.toSteadyDuration()).count(),
+            in_sampleRate,
+            in_logLevel,
+            in_location))
+{
+   RateLimiterRegistry& registry = rateLimiterRegistry();
+   std::lock_guard<std::mutex> lock(registry.Mutex);
+   registry.RateLimiters.insert(this);
+}
+
+LogRateLimiter::~LogRateLimiter()
+{
+   RateLimiterRegistry& registry = rateLimiterRegistry();
+   std::lock_guard<std::mutex> lock(registry.Mutex);
+   registry.RateLimiters.erase(this);
+}
+
+void LogRateLimiter::reportSuppressedMessages(bool in_force)
+{
+   struct SuppressedReport
+   {
+      LogLevel Level;
+      ErrorLocation Location;
+      uint64_t Count;
+   };
+
+   // Collect the counts under the lock, but write them without it, since writing may construct another rate limiter.
+   std::vector<SuppressedReport> reports;
+   const int64_t now = Impl::now();
+   {
+      RateLimiterRegistry& registry = rateLimiterRegistry();
+      std::lock_guard<std::mutex> lock(registry.Mutex);
+      for (LogRateLimiter* rateLimiter: registry.RateLimiters)
+      {
+         Impl& impl = *rateLimiter->m_impl;
+         if (impl.SuppressedCount.load(std::memory_order_relaxed) == 0)
+            continue;
+
+         // While the interval lasts, the count may still be reported with the next message that is written.
+         if (!in_force && (now - impl.IntervalStart.load(std::memory_order_relaxed) < impl.IntervalMicroseconds))
+            continue;
+
+         const uint64_t count = impl.SuppressedCount.exchange(0, std::memory_order_relaxed);
+         if (count != 0)
+            reports.push_back(SuppressedReport{ impl.Level, impl.Location, count });
+      }
+   }
+
+   for (const SuppressedReport& report: reports)
+   {
+      logger().writeMessageToDestinations(
+         report.Level,
+         std::to_string(report.Count) + " similar messages suppressed",
+         "",
+         Optional<LogMessageProperties>(LogMessageProperties{ { "suppressedMessages", report.Count } }),
+         report.Location);
+   }
+}
+
+bool LogRateLimiter::tryAcquire(uint64_t& out_suppressedCount)
+{
+   // Only one caller can move the interval forward, but another caller may be counted against the old interval.
+   const int64_t now = Impl::now();
+   int64_t intervalStart = m_impl->IntervalStart.load(std::memory_order_relaxed);
+   if ((now - intervalStart >= m_impl->IntervalMicroseconds) &&
+      m_impl->IntervalStart.compare_exchange_strong(intervalStart, now, std::memory_order_relaxed))
+   {
+      m_impl->IntervalCount.store(0, std::memory_order_relaxed);
+   }
+
+   const uint64_t count = m_impl->IntervalCount.fetch_add(1, std::memory_order_relaxed);
+   if (count >= m_impl->MaxMessages)
+   {
+      const bool isSampled = (m_impl->SampleRate != 0) && ((count - m_impl->MaxMessages + 1) % m_impl->SampleRate == 0);
+      if (!isSampled)
+      {
+         m_impl->SuppressedCount.fetch_add(1, std::memory_order_relaxed);
+         return false;
+      }
+   }
+
+   out_suppressedCount = m_impl->SuppressedCount.exchange(0, std::memory_order_relaxed);
+   return true;
+}
+
 // Logging functions
 void setProgramId(const std::string& in_programId)
 {
@@ -539,8 +1375,7 @@ void addLogDestination(const std::shared_ptr<ILogDestination>& in_destination)
       if (logMap.find(in_destination->getId()) == logMap.end())
       {
          logMap.insert(std::make_pair(in_destination->getId(), in_destination));
-         if (in_destination->getLogLevel() > logger().MaxLogLevel)
-            logger().MaxLogLevel = in_destination->getLogLevel();
+         logger().updateMaxLogLevels();
          return;
       }
    }
@@ -565,9 +1400,7 @@ void addLogDestination(const std::shared_ptr<ILogDestination>& in_destination, c
       if (logMap.find(in_destination->getId()) == logMap.end())
       {
          logMap.insert(std::make_pair(in_destination->getId(), in_destination));
-         if (log.MaxLogLevel < in_destination->getLogLevel())
-            log.MaxLogLevel = in_destination->getLogLevel();
-
+         log.updateMaxLogLevels();
          return;
       }
    }
@@ -587,6 +1420,21 @@ std::string cleanDelimiters(const std::string& in_str)
    return toClean;
 }
 
+void disableAsyncLogging()
+{
+   logger().disableAsyncLogging();
+}
+
+void enableAsyncLogging(size_t in_queueCapacity, AsyncLogOverflowPolicy in_overflowPolicy)
+{
+   logger().enableAsyncLogging(in_queueCapacity, in_overflowPolicy);
+}
+
+uint64_t getDroppedLogMessageCount()
+{
+   return logger().DroppedMessageCount.load();
+}
+
 void logError(const Error& in_error)
 {
    if (!in_error.isExpected())
@@ -632,9 +1480,7 @@ void logErrorMessage(const std::string& in_message,
                      const Optional<LogMessageProperties>& in_properties,
                      const ErrorLocation& in_loggedFrom)
 {
-   Logger& log = logger();
-   if (log.MaxLogLevel >= LogLevel::ERR)
-      log.writeMessageToDestinations(LogLevel::ERR, in_message, in_section, in_properties, in_loggedFrom);
+   logger().writeMessageToDestinations(LogLevel::ERR, in_message, in_section, in_properties, in_loggedFrom);
 }
 
 void logWarningMessage(const std::string& in_message, const std::string& in_section)
@@ -652,9 +1498,7 @@ void logWarningMessage(const std::string& in_message,
                        const Optional<LogMessageProperties>& in_properties,
                        const ErrorLocation& in_loggedFrom)
 {
-   Logger& log = logger();
-   if (log.MaxLogLevel >= LogLevel::WARN)
-      log.writeMessageToDestinations(LogLevel::WARN, in_message, in_section, in_properties, in_loggedFrom);
+   logger().writeMessageToDestinations(LogLevel::WARN, in_message, in_section, in_properties, in_loggedFrom);
 }
 
 void logDebugMessage(const std::string& in_message, const std::string& in_section)
@@ -699,6 +1543,39 @@ void logInfoMessage(const std::string& in_message,
    logger().writeMessageToDestinations(LogLevel::INFO, in_message, in_section, in_properties, in_loggedFrom);
 }
 
+void logErrorRateLimited(LogRateLimiter& io_rateLimiter, const Error& in_error)
+{
+   if (in_error.isExpected() || !isLogLevelEnabled(LogLevel::ERR))
+      return;
+
+   uint64_t suppressedCount = 0;
+   if (!io_rateLimiter.tryAcquire(suppressedCount))
+      return;
+
+   if (suppressedCount == 0)
+   {
+      logError(in_error);
+      return;
+   }
+
+   Error error = in_error;
+   error.addOrUpdateProperty("suppressedErrors", std::to_string(suppressedCount));
+   logError(error);
+}
+
+void logRateLimitedMessage(
+   LogLevel in_logLevel,
+   const std::string& in_message,
+   uint64_t in_suppressedCount,
+   const ErrorLocation& in_loggedFrom)
+{
+   Optional<LogMessageProperties> properties;
+   if (in_suppressedCount != 0)
+      properties = LogMessageProperties{ { "suppressedMessages", in_suppressedCount } };
+
+   logger().writeMessageToDestinations(in_logLevel, in_message, "", properties, in_loggedFrom);
+}
+
 void logPassthroughMessage(const std::string& in_source, const std::string& in_message)
 {
    logger().writePassthroughMessageToDestinations(in_source, in_message);
@@ -706,7 +1583,12 @@ void logPassthroughMessage(const std::string& in_source, const std::string& in_m
 
 bool isLogLevel(LogLevel in_logLevel)
 {
-   return logger().MaxLogLevel >= in_logLevel;
+   return logger().MaxLogLevel.load(std::memory_order_relaxed) >= in_logLevel;
+}
+
+bool isLogLevelEnabled(LogLevel in_logLevel, const std::string& in_section)
+{
+   return logger().isLevelEnabled(in_logLevel, in_section);
 }
 
 void refreshAllLogDestinations(const logging::RefreshParams& in_refreshParams)
@@ -746,7 +1628,7 @@ void removeLogDestination(const std::string& in_destinationId, const std::string
 
          // Remove it from any sections it may have been registered to.
          std::vector<std::string> sectionsToRemove;
-         for (auto secIter: log.SectionedLogDestinations)
+         for (auto& secIter: log.SectionedLogDestinations)
          {
             iter = secIter.second.find(in_destinationId);
             if (iter != secIter.second.end())
@@ -762,6 +1644,8 @@ void removeLogDestination(const std::string& in_destinationId, const std::string
          // Clean up any empty sections.
          for (const std::string& toRemove: sectionsToRemove)
             log.SectionedLogDestinations.erase(log.SectionedLogDestinations.find(toRemove));
+
+         log.updateMaxLogLevels();
       }
       RW_LOCK_END(false);
 
@@ -785,6 +1669,7 @@ void removeLogDestination(const std::string& in_destinationId, const std::string
             if (secIter->second.empty())
                log.SectionedLogDestinations.erase(secIter);
 
+            log.updateMaxLogLevels();
             return;
          }
       }
@@ -828,12 +1713,49 @@ void removeReloadableLogDestinations()
                ++sectionIter;
          }
       }
+
+      logger().updateMaxLogLevels();
    }
    RW_LOCK_END(false)
 
    logDebugMessage("Cleared all previously registered log destinations marked as reloadable");
 }
 
+void setLogDestinationLevel(const std::string& in_destinationId, LogLevel in_logLevel)
+{
+   Logger& log = logger();
+
+   // Log destinations only read their level while the read lock is held, so changing it under the write lock is safe.
+   bool found = false;
+   WRITE_LOCK_BEGIN(log.Mutex)
+   {
+      auto iter = log.DefaultLogDestinations.find(in_destinationId);
+      if (iter != log.DefaultLogDestinations.end())
+      {
+         found = true;
+         iter->second->setLogLevel(in_logLevel);
+      }
+
+      for (auto& section: log.SectionedLogDestinations)
+      {
+         iter = section.second.find(in_destinationId);
+         if (iter != section.second.end())
+         {
+            found = true;
+            iter->second->setLogLevel(in_logLevel);
+         }
+      }
+
+      log.updateMaxLogLevels();
+   }
+   RW_LOCK_END(false)
+
+   if (!found)
+      logDebugMessage(
+         "Attempted to change the log level of a log destination that has not been registered with id " +
+         in_destinationId);
+}
+
 std::ostream& writeError(const Error& in_error, std::ostream& io_os)
 {
    return io_os << writeError(in_error);
@@ -841,7 +1763,9 @@ std::ostream& writeError(const Error& in_error, std::ostream& io_os)
 
 std::string writeError(const Error& in_error)
 {
-   return formatLogMessage(LogLevel::ERR, in_error.asString(), logger().ProgramId, true,{});
+   std::string message;
+   formatLogMessage(LogLevel::ERR, in_error.asString(), logger().ProgramId, true, {}, message);
+   return message;
 }
 
 namespace {
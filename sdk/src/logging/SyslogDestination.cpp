@@ -24,11 +24,22 @@
 #include "SyslogDestination.hpp"
 
 #include <cassert>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
 #include <iostream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <syslog.h>
+#include <unistd.h>
 
-#include <boost/algorithm/string.hpp>
-#include <boost/regex.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 #include <logging/Logger.hpp>
 
@@ -38,6 +49,28 @@ namespace logging {
 
 namespace {
 
+// The socket on which the system logger receives messages by default.
+constexpr const char* SYSLOG_SOCKET_PATH = "/dev/log";
+
+// The maximum number of messages which may wait for the system logger to accept them. Any more are dropped.
+constexpr size_t MAX_QUEUED_MESSAGES = 1024;
+
+// How long to wait before retrying to send queued messages when the system logger isn't accepting them.
+constexpr std::chrono::milliseconds RETRY_INTERVAL(100);
+
+// How long to wait between attempts to connect to the system logger.
+constexpr std::chrono::seconds RECONNECT_INTERVAL(1);
+
+/**
+ * @brief The result of an attempt to send a datagram to the system logger.
+ */
+enum class SendResult
+{
+   SENT,       // The system logger accepted the datagram.
+   RETRY,      // The system logger isn't accepting datagrams right now, so the datagram should be sent again later.
+   REJECTED    // The datagram can never be sent, such as because it is too large, so it should be dropped.
+};
+
 int logLevelToLogPriority(logging::LogLevel in_logLevel)
 {
    switch(in_logLevel)
@@ -67,14 +100,301 @@ struct SyslogDestination::Impl
     * @brief Constructor.
     *
     * param in_programId        The ID of the program for which system logs should be written.
+    * param in_socketPath       The socket on which the system logger receives messages.
+    */
+   Impl(const std::string& in_programId, const system::FilePath& in_socketPath) :
+      DroppedMessageCount(0),
+      IsStopping(false),
+      ProgramId(in_programId),
+      SenderThreadPid(0),
+      Socket(-1),
+      SocketPath(in_socketPath.getAbsolutePath()),
+      UnreportedDropCount(0)
+   {
+   }
+
+   /**
+    * @brief Closes the connection to the system logger, if it is open. The mutex must be locked.
+    */
+   void closeSocket()
+   {
+      if (Socket >= 0)
+      {
+         ::close(Socket);
+         Socket = -1;
+      }
+   }
+
+   /**
+    * @brief Connects to the system logger, if it has been long enough since the last attempt. The mutex must be locked.
+    *
+    * @return True if the connection is open; false otherwise.
+    */
+   bool connectSocket()
+   {
+      if (Socket >= 0)
+         return true;
+
+      std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+      if (now < NextConnectTime)
+         return false;
+
+      NextConnectTime = now + RECONNECT_INTERVAL;
+
+      int fd = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+      if (fd < 0)
+         return false;
+
+      struct sockaddr_un address;
+      std::memset(&address, 0, sizeof(address));
+      address.sun_family = AF_UNIX;
+      std::strncpy(address.sun_path, SocketPath.c_str(), sizeof(address.sun_path) - 1);
+      if (::connect(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0)
+      {
+         ::close(fd);
+         return false;
+      }
+
+      Socket = fd;
+      return true;
+   }
+
+   /**
+    * @brief Formats a message as a system logger datagram.
+    *
+    * @param in_priority    The syslog priority of the message.
+    * @param in_message     The message to format.
+    *
+    * @return The datagram to send to the system logger.
+    */
+   std::string formatDatagram(int in_priority, const std::string& in_message) const
+   {
+      // Remove the leading date and program ID, since those are set by syslog directly.
+      size_t messageStart = in_message.find(']');
+      if ((messageStart == std::string::npos) ||
+         (messageStart + 1 >= in_message.size()) ||
+         !std::isspace(static_cast<unsigned char>(in_message[messageStart + 1])))
+         messageStart = 0;
+      else
+         messageStart += 2;
+
+      size_t messageEnd = in_message.size();
+      while ((messageEnd > messageStart) && (in_message[messageEnd - 1] == '\n'))
+         --messageEnd;
+
+      char timestamp[32];
+      std::time_t now = std::time(nullptr);
+      struct tm localTime;
+      ::localtime_r(&now, &localTime);
+      size_t timestampLength = std::strftime(timestamp, sizeof(timestamp), "%h %e %T ", &localTime);
+
+      std::string datagram;
+      datagram.reserve(ProgramId.size() + timestampLength + (messageEnd - messageStart) + 24);
+      datagram.append("<").append(std::to_string(LOG_USER | in_priority)).append(">");
+      datagram.append(timestamp, timestampLength);
+      datagram.append(ProgramId).append("[").append(std::to_string(::getpid())).append("]: ");
+      datagram.append(in_message, messageStart, messageEnd - messageStart);
+      return datagram;
+   }
+
+   /**
+    * @brief Sends as many queued messages as the system logger will accept without blocking. The mutex must be locked.
+    */
+   void sendQueued()
+   {
+      while (!Queue.empty())
+      {
+         SendResult result = trySend(Queue.front());
+         if (result == SendResult::RETRY)
+            return;
+
+         if (result == SendResult::REJECTED)
+         {
+            ++DroppedMessageCount;
+            ++UnreportedDropCount;
+         }
+
+         Queue.pop_front();
+      }
+
+      if (UnreportedDropCount > 0)
+      {
+         std::string report = formatDatagram(
+            LOG_WARNING,
+            std::to_string(UnreportedDropCount) +
+               " messages were not written to the system log because it was not accepting them.");
+
+         // If even the report is rejected, retrying it would never succeed.
+         if (trySend(report) != SendResult::RETRY)
+            UnreportedDropCount = 0;
+      }
+   }
+
+   /**
+    * @brief Sends queued messages until stopped.
+    */
+   void runSenderThread()
+   {
+      try
+      {
+         std::unique_lock<std::mutex> lock(Mutex);
+         while (!IsStopping)
+         {
+            sendQueued();
+            if (Queue.empty() && (UnreportedDropCount == 0))
+               SenderCondition.wait(
+                  lock,
+                  [this]() { return IsStopping || !Queue.empty() || (UnreportedDropCount > 0); });
+            else if (Socket < 0)
+               SenderCondition.wait_for(lock, RETRY_INTERVAL, [this]() { return IsStopping; });
+            else
+            {
+               // Wait for the system logger to have room for more messages, without blocking writers.
+               struct pollfd pollFd = { Socket, POLLOUT, 0 };
+               lock.unlock();
+               ::poll(&pollFd, 1, static_cast<int>(RETRY_INTERVAL.count()));
+               lock.lock();
+            }
+         }
+
+         sendQueued();
+      }
+      catch (...)
+      {
+         // Swallow exceptions because we'd trigger recursive logging otherwise.
+      }
+   }
+
+   /**
+    * @brief Starts the thread which sends queued messages, if it isn't running. The mutex must be locked.
+    *
+    * @return True if the thread is running; false otherwise.
     */
-   explicit Impl(const std::string& in_programId) :
-      ProgramId(in_programId)
+   bool startSenderThread()
    {
+      if (SenderThread.joinable())
+      {
+         if (SenderThreadPid == ::getpid())
+            return true;
+
+         // A forked child only has a copy of the thread object, and the queued messages belong to the parent.
+         SenderThread.detach();
+         Queue.clear();
+         UnreportedDropCount = 0;
+      }
+
+      if (IsStopping)
+         return false;
+
+      SenderThreadPid = ::getpid();
+      SenderThread = std::thread(&Impl::runSenderThread, this);
+      return true;
+   }
+
+   /**
+    * @brief Stops the thread which sends queued messages, after making a last attempt to send them.
+    */
+   void stop()
+   {
+      try
+      {
+         {
+            std::lock_guard<std::mutex> lock(Mutex);
+            IsStopping = true;
+         }
+
+         SenderCondition.notify_all();
+         if (SenderThread.joinable())
+         {
+            if (SenderThreadPid != ::getpid())
+               SenderThread.detach();
+            else
+               SenderThread.join();
+         }
+
+         std::lock_guard<std::mutex> lock(Mutex);
+         closeSocket();
+      }
+      catch (...)
+      {
+         // Swallow exceptions because we'd trigger recursive logging otherwise.
+      }
+   }
+
+   /**
+    * @brief Sends a datagram to the system logger without blocking. The mutex must be locked.
+    *
+    * @param in_datagram    The datagram to send.
+    *
+    * @return Whether the datagram was sent, should be sent again later, or can never be sent.
+    */
+   SendResult trySend(const std::string& in_datagram)
+   {
+      if (!connectSocket())
+         return SendResult::RETRY;
+
+      if (::send(Socket, in_datagram.data(), in_datagram.size(), MSG_DONTWAIT | MSG_NOSIGNAL) >= 0)
+         return SendResult::SENT;
+
+      switch (errno)
+      {
+         case EAGAIN:
+#if EWOULDBLOCK != EAGAIN
+         case EWOULDBLOCK:
+#endif
+         case ENOBUFS:
+         case EINTR:
+            return SendResult::RETRY;
+         case ECONNREFUSED:
+         case ECONNRESET:
+         case ENOTCONN:
+         case EPIPE:
+         {
+            // The system logger went away, so reconnect on the next attempt.
+            closeSocket();
+            return SendResult::RETRY;
+         }
+         default:
+            // Any other error, such as EMSGSIZE, is about this datagram, so sending it again would fail the same way.
+            return SendResult::REJECTED;
+      }
    }
 
-   /** The program ID. It must be persisted. */
+   /** The total number of messages which were dropped because the queue was full or the system logger rejected them. */
+   uint64_t DroppedMessageCount;
+
+   /** Whether this destination is being destroyed. */
+   bool IsStopping;
+
+   /** Mutex to protect the members of this destination. It is never held while waiting on the system logger. */
+   std::mutex Mutex;
+
+   /** The next time at which a connection to the system logger may be attempted. */
+   std::chrono::steady_clock::time_point NextConnectTime;
+
+   /** The program ID. */
    std::string ProgramId;
+
+   /** The datagrams which are waiting to be accepted by the system logger. */
+   std::deque<std::string> Queue;
+
+   /** Condition variable to wake the sender thread. */
+   std::condition_variable SenderCondition;
+
+   /** The thread which sends queued messages once the system logger accepts them again. */
+   std::thread SenderThread;
+
+   /** The process which started the sender thread. */
+   pid_t SenderThreadPid;
+
+   /** The connection to the system logger, or -1 if it isn't connected. */
+   int Socket;
+
+   /** The socket on which the system logger receives messages. */
+   const std::string SocketPath;
+
+   /** The number of dropped messages which have not yet been reported to the system logger. */
+   uint64_t UnreportedDropCount;
 };
 
 PRIVATE_IMPL_DELETER_IMPL(SyslogDestination);
@@ -84,30 +404,61 @@ SyslogDestination::SyslogDestination(const std::string& in_id,
                                      logging::LogMessageFormatType in_formatType,
                                      const std::string& in_programId,
                                      bool in_reloadable) :
+   SyslogDestination(
+      in_id,
+      in_logLevel,
+      in_formatType,
+      in_programId,
+      in_reloadable,
+      system::FilePath(SYSLOG_SOCKET_PATH))
+{
+}
+
+SyslogDestination::SyslogDestination(const std::string& in_id,
+                                     logging::LogLevel in_logLevel,
+                                     logging::LogMessageFormatType in_formatType,
+                                     const std::string& in_programId,
+                                     bool in_reloadable,
+                                     const system::FilePath& in_socketPath) :
    ILogDestination(in_id, in_logLevel, in_formatType, in_reloadable),
-   m_impl(new Impl(in_programId))
+   m_impl(new Impl(in_programId, in_socketPath))
 {
-   // Open the system log. Don't set a mask because filtering is done at a higher level.
-   ::openlog(m_impl->ProgramId.c_str(), LOG_CONS | LOG_PID, LOG_USER);
+   std::lock_guard<std::mutex> lock(m_impl->Mutex);
+   m_impl->connectSocket();
 }
 
 SyslogDestination::~SyslogDestination()
+{
+   m_impl->stop();
+}
+
+uint64_t SyslogDestination::getDroppedMessageCount() const
 {
    try
    {
-      ::closelog();
+      std::lock_guard<std::mutex> lock(m_impl->Mutex);
+      return m_impl->DroppedMessageCount;
    }
-   catch(...)
+   catch (...)
    {
-      // Ignore if we fail to close the log.
+      return 0;
    }
 }
 
 void SyslogDestination::refresh(const logging::RefreshParams&)
 {
-   // Close and re-open the log.
-   ::closelog();
-   ::openlog(m_impl->ProgramId.c_str(), LOG_CONS | LOG_PID, LOG_USER);
+   // Reconnect to the system log, in case we have forked or the system logger has restarted.
+   try
+   {
+      std::lock_guard<std::mutex> lock(m_impl->Mutex);
+      m_impl->closeSocket();
+      m_impl->NextConnectTime = std::chrono::steady_clock::time_point();
+      m_impl->connectSocket();
+   }
+   catch (...)
+   {
+      // Swallow exceptions because we'd trigger recursive logging otherwise.
+   }
 }
 
 void SyslogDestination::writeLog(
@@ -118,9 +469,42 @@ void SyslogDestination::writeLog(
    if (in_logLevel > m_logLevel)
       return;
 
-   // Remove the leading date and program ID, since those are set by syslog directly.
-   std::string message = boost::regex_replace(in_message, boost::regex("^[^\\]]*\\]\\s"), "");
-   ::syslog(logLevelToLogPriority(in_logLevel), "%s", message.c_str());
+   try
+   {
+      std::string datagram = m_impl->formatDatagram(logLevelToLogPriority(in_logLevel), in_message);
+
+      std::lock_guard<std::mutex> lock(m_impl->Mutex);
+
+      // Send the message right away unless earlier messages are still waiting, so messages stay in order.
+      SendResult result = SendResult::RETRY;
+      if (m_impl->Queue.empty() && (m_impl->UnreportedDropCount == 0))
+         result = m_impl->trySend(datagram);
+
+      if (result == SendResult::REJECTED)
+      {
+         ++m_impl->DroppedMessageCount;
+         ++m_impl->UnreportedDropCount;
+         if (m_impl->startSenderThread())
+            m_impl->SenderCondition.notify_one();
+      }
+      else if (result == SendResult::RETRY)
+      {
+         if (m_impl->Queue.size() >= MAX_QUEUED_MESSAGES)
+         {
+            ++m_impl->DroppedMessageCount;
+            ++m_impl->UnreportedDropCount;
+         }
+         else
+            m_impl->Queue.push_back(std::move(datagram));
+
+         if (m_impl->startSenderThread())
+            m_impl->SenderCondition.notify_one();
+      }
+   }
+   catch (...)
+   {
+      // Swallow exceptions because we'd trigger recursive logging otherwise.
+   }
 
    // Also log to stderr if there is a tty attached.
    if (::isatty(STDERR_FILENO) == 1)
@@ -130,4 +514,3 @@ void SyslogDestination::writeLog(
 } // namespace logging
 } // namespace launcher_plugins
 } // namespace rstudio
-
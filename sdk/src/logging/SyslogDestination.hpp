@@ -24,9 +24,12 @@
 #ifndef LAUNCHER_PLUGINS_SYS_LOG_DESTINATION_HPP
 #define LAUNCHER_PLUGINS_SYS_LOG_DESTINATION_HPP
 
+#include <cstdint>
+
 #include <logging/ILogDestination.hpp>
 
 #include <PImpl.hpp>
+#include <system/FilePath.hpp>
 
 namespace rstudio {
 namespace launcher_plugins {
@@ -35,7 +38,11 @@ namespace logging {
 /**
  * @brief A class which logs messages to syslog.
  *
- * Only one of these should be created per program.
+ * Messages are sent to the system logger over a non-blocking datagram socket, so a stalled system logger never blocks
+ * the caller. Messages which the system logger does not accept right away are queued and sent by a background thread.
+ * If too many messages are queued, further messages are dropped, and the number of dropped messages is reported to the
+ * system log once it accepts messages again. Messages which the system logger can never accept, such as ones which are
+ * too large, are dropped and reported the same way.
  */
 class SyslogDestination : public logging::ILogDestination
 {
@@ -57,13 +64,40 @@ public:
                      const std::string& in_programId,
                      bool in_reloadable = false);
 
+   /**
+    * @brief Constructor.
+    *
+    * @param in_id              The unique ID of this log destination.
+    * @param in_logLevel        The most detailed level of log to be written to syslog.
+    * @param in_formatType      The format type for log messages.
+    * @param in_programId       The ID of this program.
+    * @param in_reloadable      Whether or not the destination is reloadable. If so, reloading of logging configuration
+    *                           will cause the log destination to be removed. Set this to true only for log destinations
+    *                           that are intended to be hot-reconfigurable, such as the global default logger.
+    * @param in_socketPath      The datagram socket on which the system logger receives messages.
+    */
+   SyslogDestination(const std::string& in_id,
+                     logging::LogLevel in_logLevel,
+                     logging::LogMessageFormatType in_formatType,
+                     const std::string& in_programId,
+                     bool in_reloadable,
+                     const system::FilePath& in_socketPath);
+
    /**
     * @brief Destructor.
     */
    ~SyslogDestination() override;
 
    /**
-    * @brief Refreshes the log destintation. Ensures that the log does not have any stale file handles.
+    * @brief Gets the number of messages which were dropped because the system logger was not accepting them, or
+    *        rejected them.
+    *
+    * @return The number of messages which were dropped.
+    */
+   uint64_t getDroppedMessageCount() const;
+
+   /**
+    * @brief Refreshes the log destintation. Reconnects to the system logger, so no stale socket is used.
     *
     * @param in_refreshParams   Refresh params to use when refreshing the log destinations (if applicable).
     */
@@ -0,0 +1,381 @@
+/*
+ * Trace.cpp
+ * 
+ * Copyright (C) 2022 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <logging/Trace.hpp>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include <Error.hpp>
+#include <json/Json.hpp>
+#include <system/FilePath.hpp>
+#include <utils/FileUtils.hpp>
+#include <utils/MutexUtils.hpp>
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace logging {
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * @brief A completed trace span.
+ */
+struct TraceEvent
+{
+   /** The duration of the span, in microseconds. */
+   uint64_t DurationUs;
+
+   /** The ID of the job for which the span was recorded, if any. */
+   std::string JobId;
+
+   /** The name of the span. */
+   const char* Name;
+
+   /** The ID of the request for which the span was recorded, or 0. */
+   uint64_t RequestId;
+
+   /** The time at which the span started, in microseconds since the epoch of the steady clock. */
+   uint64_t StartUs;
+};
+
+/**
+ * @brief The ring buffer of completed spans of a single thread.
+ */
+struct ThreadTraceBuffer
+{
+   /**
+    * @brief Constructor.
+    *
+    * @param in_threadId    The ID of the thread which owns this buffer.
+    */
+   explicit ThreadTraceBuffer(pid_t in_threadId) :
+      Capacity(0),
+      Generation(0),
+      NextEvent(0),
+      ThreadId(in_threadId)
+   {
+   }
+
+   /** The maximum number of completed spans to keep. */
+   size_t Capacity;
+
+   /** The completed spans of the thread. Once the buffer is full, NextEvent is the oldest span. */
+   std::vector<TraceEvent> Events;
+
+   /** The tracing generation to which Events belong. Events from an older generation are discarded. */
+   uint64_t Generation;
+
+   /** Mutex to protect this buffer. It is only contended while the trace is being written. */
+   std::mutex Mutex;
+
+   /** The index at which the next completed span will be stored. */
+   size_t NextEvent;
+
+   /** The ID of the thread which owns this buffer. */
+   const pid_t ThreadId;
+};
+
+typedef std::shared_ptr<ThreadTraceBuffer> ThreadTraceBufferPtr;
+
+/**
+ * @brief The global tracing state.
+ */
+struct TraceState
+{
+   /**
+    * @brief Constructor.
+    */
+   TraceState() :
+      Generation(1),
+      SpansPerThread(0)
+   {
+   }
+
+   /**
+    * @brief Removes the buffers of threads which have exited. The mutex must be held by the caller.
+    */
+   void removeExitedThreadBuffers()
+   {
+      std::vector<ThreadTraceBufferPtr> buffers;
+      buffers.reserve(Buffers.size());
+      for (ThreadTraceBufferPtr& buffer: Buffers)
+      {
+         // The registry holds the only reference once the owning thread has exited.
+         if (buffer.use_count() > 1)
+            buffers.push_back(std::move(buffer));
+      }
+
+      Buffers.swap(buffers);
+   }
+
+   /** The buffers of every thread which has recorded a span. */
+   std::vector<ThreadTraceBufferPtr> Buffers;
+
+   /** The current tracing generation, which changes whenever recorded spans should be discarded. */
+   std::atomic<uint64_t> Generation;
+
+   /** Mutex to protect Buffers and serialize changes to the tracing configuration. */
+   std::mutex Mutex;
+
+   /** The maximum number of completed spans to keep for each thread, or 0 if tracing is disabled. */
+   std::atomic<size_t> SpansPerThread;
+};
+
+TraceState& getTraceState()
+{
+   static TraceState traceState;
+   return traceState;
+}
+
+ThreadTraceBuffer& getThreadBuffer()
+{
+   thread_local ThreadTraceBufferPtr threadBuffer;
+   if (!threadBuffer)
+   {
+      threadBuffer.reset(new ThreadTraceBuffer(static_cast<pid_t>(::syscall(SYS_gettid))));
+
+      TraceState& traceState = getTraceState();
+      LOCK_MUTEX(traceState.Mutex)
+      {
+         traceState.Buffers.push_back(threadBuffer);
+      }
+      END_LOCK_MUTEX
+   }
+
+   return *threadBuffer;
+}
+
+uint64_t toMicroseconds(const Clock::time_point& in_time)
+{
+   return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(in_time.time_since_epoch()).count());
+}
+
+void recordEvent(TraceEvent&& in_event)
+{
+   TraceState& traceState = getTraceState();
+   const uint64_t generation = traceState.Generation.load(std::memory_order_acquire);
+   const size_t spansPerThread = traceState.SpansPerThread.load(std::memory_order_relaxed);
+   if (spansPerThread == 0)
+      return;
+
+   ThreadTraceBuffer& buffer = getThreadBuffer();
+   LOCK_MUTEX(buffer.Mutex)
+   {
+      if (buffer.Generation != generation)
+      {
+         buffer.Events.clear();
+         buffer.Events.shrink_to_fit();
+         buffer.Events.reserve(spansPerThread);
+         buffer.Capacity = spansPerThread;
+         buffer.Generation = generation;
+         buffer.NextEvent = 0;
+      }
+
+      if (buffer.Events.size() < buffer.Capacity)
+         buffer.Events.push_back(std::move(in_event));
+      else
+         buffer.Events[buffer.NextEvent] = std::move(in_event);
+
+      buffer.NextEvent = (buffer.NextEvent + 1) % buffer.Capacity;
+   }
+   END_LOCK_MUTEX
+}
+
+} // anonymous namespace
+
+// Trace Span ==========================================================================================================
+struct TraceSpan::Impl
+{
+   /**
+    * @brief Constructor.
+    *
+    * @param in_name        The name of the span.
+    * @param in_requestId   The ID of the request for which the span is being recorded, or 0.
+    * @param in_jobId       The ID of the job for which the span is being recorded, if any.
+    */
+   Impl(const char* in_name, uint64_t in_requestId, const std::string& in_jobId) :
+      JobId(in_jobId),
+      Name(in_name),
+      RequestId(in_requestId),
+      StartTime(Clock::now())
+   {
+   }
+
+   /** The ID of the job for which the span is being recorded, if any. */
+   std::string JobId;
+
+   /** The name of the span. */
+   const char* Name;
+
+   /** The ID of the request for which the span is being recorded, or 0. */
+   uint64_t RequestId;
+
+   /** The time at which the span started. */
+   Clock::time_point StartTime;
+};
+
+PRIVATE_IMPL_DELETER_IMPL(TraceSpan)
+
+TraceSpan::TraceSpan(const char* in_name, uint64_t in_requestId, const std::string& in_jobId)
+{
+   if (isTracingEnabled())
+      m_impl.reset(new Impl(in_name, in_requestId, in_jobId));
+}
+
+TraceSpan::~TraceSpan()
+{
+   end();
+}
+
+void TraceSpan::end()
+{
+   if (!m_impl)
+      return;
+
+   const Clock::time_point endTime = Clock::now();
+   recordEvent(
+      TraceEvent{
+         toMicroseconds(endTime) - toMicroseconds(m_impl->StartTime),
+         std::move(m_impl->JobId),
+         m_impl->Name,
+         m_impl->RequestId,
+         toMicroseconds(m_impl->StartTime) });
+
+   m_impl.reset();
+}
+
+void TraceSpan::setJobId(const std::string& in_jobId)
+{
+   if (m_impl)
+      m_impl->JobId = in_jobId;
+}
+
+void TraceSpan::setRequestId(uint64_t in_requestId)
+{
+   if (m_impl)
+      m_impl->RequestId = in_requestId;
+}
+
+// Tracing Functions ===================================================================================================
+void disableTracing()
+{
+   TraceState& traceState = getTraceState();
+   LOCK_MUTEX(traceState.Mutex)
+   {
+      traceState.SpansPerThread.store(0, std::memory_order_relaxed);
+      traceState.Generation.fetch_add(1, std::memory_order_release);
+      traceState.removeExitedThreadBuffers();
+   }
+   END_LOCK_MUTEX
+}
+
+void enableTracing(size_t in_spansPerThread)
+{
+   TraceState& traceState = getTraceState();
+   LOCK_MUTEX(traceState.Mutex)
+   {
+      if (traceState.SpansPerThread.load(std::memory_order_relaxed) == in_spansPerThread)
+         return;
+
+      traceState.SpansPerThread.store(in_spansPerThread, std::memory_order_relaxed);
+      traceState.Generation.fetch_add(1, std::memory_order_release);
+      traceState.removeExitedThreadBuffers();
+   }
+   END_LOCK_MUTEX
+}
+
+bool isTracingEnabled()
+{
+   return getTraceState().SpansPerThread.load(std::memory_order_relaxed) > 0;
+}
+
+Error writeTrace(const system::FilePath& in_traceFile)
+{
+   TraceState& traceState = getTraceState();
+   const json::Value processId(static_cast<int>(::getpid()));
+
+   json::Array traceEvents;
+   LOCK_MUTEX(traceState.Mutex)
+   {
+      const uint64_t generation = traceState.Generation.load(std::memory_order_acquire);
+      for (const ThreadTraceBufferPtr& buffer: traceState.Buffers)
+      {
+         // Copy the spans so the thread isn't blocked while they are converted to JSON.
+         std::vector<TraceEvent> events;
+         size_t firstEvent = 0;
+         LOCK_MUTEX(buffer->Mutex)
+         {
+            if (buffer->Generation == generation)
+            {
+               events = buffer->Events;
+               if (events.size() == buffer->Capacity)
+                  firstEvent = buffer->NextEvent;
+            }
+         }
+         END_LOCK_MUTEX
+
+         const json::Value threadId(static_cast<int>(buffer->ThreadId));
+         for (size_t i = 0; i < events.size(); ++i)
+         {
+            const TraceEvent& event = events[(firstEvent + i) % events.size()];
+
+            json::Object args;
+            if (event.RequestId != 0)
+               args.insert("requestId", event.RequestId);
+            if (!event.JobId.empty())
+               args.insert("jobId", event.JobId);
+
+            json::Object traceEvent;
+            traceEvent.insert("name", event.Name);
+            traceEvent.insert("cat", "rlps");
+            traceEvent.insert("ph", "X");
+            traceEvent.insert("ts", event.StartUs);
+            traceEvent.insert("dur", event.DurationUs);
+            traceEvent.insert("pid", processId);
+            traceEvent.insert("tid", threadId);
+            traceEvent.insert("args", args);
+            traceEvents.push_back(traceEvent);
+         }
+      }
+   }
+   END_LOCK_MUTEX
+
+   json::Object trace;
+   trace.insert("traceEvents", traceEvents);
+   trace.insert("displayTimeUnit", "ms");
+
+   return utils::writeStringToFileAtomically(trace.write(), in_traceFile, utils::FileSyncMode::NONE);
+}
+
+} // namespace logging
+} // namespace launcher_plugins
+} // namespace rstudio
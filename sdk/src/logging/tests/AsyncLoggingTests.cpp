@@ -0,0 +1,266 @@
+/*
+ * AsyncLoggingTests.cpp
+ *
+ * Copyright (C) 2020 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <TestMain.hpp>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <logging/ILogDestination.hpp>
+#include <logging/Logger.hpp>
+
+#include "../AsyncLogQueue.hpp"
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace logging {
+
+namespace {
+
+/**
+ * @brief Log destination which records the messages written to it, and which can hold the log writer thread inside
+ *        writeLog until it is released.
+ */
+class GatedLogDestination : public ILogDestination
+{
+public:
+   explicit GatedLogDestination(const std::string& in_id) :
+      ILogDestination(in_id, LogLevel::DEBUG, LogMessageFormatType::PRETTY, false),
+      m_isBlocked(false),
+      m_isClosed(false)
+   {
+   }
+
+   void close()
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_isClosed = true;
+   }
+
+   std::vector<std::string> getMessages()
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_messages;
+   }
+
+   void open()
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_isClosed = false;
+      m_condition.notify_all();
+   }
+
+   void refresh(const RefreshParams&) override
+   {
+   }
+
+   void waitUntilBlocked()
+   {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_condition.wait(lock, [this]{ return m_isBlocked; });
+   }
+
+   void writeLog(LogLevel, const std::string& in_message) override
+   {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_messages.push_back(in_message);
+
+      m_isBlocked = m_isClosed;
+      m_condition.notify_all();
+      m_condition.wait(lock, [this]{ return !m_isClosed; });
+      m_isBlocked = false;
+   }
+
+private:
+   std::condition_variable m_condition;
+   bool m_isBlocked;
+   bool m_isClosed;
+   std::vector<std::string> m_messages;
+   std::mutex m_mutex;
+};
+
+bool endsWith(const std::string& in_str, const std::string& in_suffix)
+{
+   return (in_str.size() >= in_suffix.size()) &&
+      (in_str.compare(in_str.size() - in_suffix.size(), in_suffix.size(), in_suffix) == 0);
+}
+
+size_t indexOf(const std::vector<std::string>& in_messages, const std::string& in_text)
+{
+   for (size_t i = 0; i < in_messages.size(); ++i)
+   {
+      if (in_messages[i].find(in_text) != std::string::npos)
+         return i;
+   }
+
+   return in_messages.size();
+}
+
+} // anonymous namespace
+
+TEST_CASE("Async log queue")
+{
+   AsyncLogQueue queue(5);
+   REQUIRE(queue.getCapacity() == 8);
+   CHECK(queue.isEmpty());
+
+   for (int i = 0; i < 8; ++i)
+   {
+      QueuedLogRecord record;
+      record.PrettyMessage = std::to_string(i);
+      REQUIRE(queue.tryPush(record));
+      CHECK(record.PrettyMessage.empty());
+   }
+
+   QueuedLogRecord overflow;
+   overflow.PrettyMessage = "overflow";
+   CHECK_FALSE(queue.tryPush(overflow));
+   CHECK(overflow.PrettyMessage == "overflow");
+
+   for (int i = 0; i < 8; ++i)
+   {
+      QueuedLogRecord record;
+      REQUIRE(queue.tryPop(record));
+      CHECK(record.PrettyMessage == std::to_string(i));
+   }
+
+   QueuedLogRecord record;
+   CHECK_FALSE(queue.tryPop(record));
+   CHECK(queue.isEmpty());
+   CHECK(queue.tryPush(overflow));
+   CHECK_FALSE(queue.isEmpty());
+}
+
+TEST_CASE("Async logging")
+{
+   std::shared_ptr<GatedLogDestination> dest(new GatedLogDestination("async-test-dest"));
+   addLogDestination(dest);
+
+   SECTION("All messages are written in order for each thread")
+   {
+      enableAsyncLogging(64, AsyncLogOverflowPolicy::BLOCK);
+
+      constexpr int threadCount = 4, messageCount = 1000;
+      std::vector<std::thread> threads;
+      for (int t = 0; t < threadCount; ++t)
+      {
+         threads.emplace_back([t]()
+         {
+            for (int i = 0; i < messageCount; ++i)
+               logInfoMessage(std::to_string(t) + ":" + std::to_string(i));
+         });
+      }
+
+      for (std::thread& thread: threads)
+         thread.join();
+
+      disableAsyncLogging();
+
+      std::vector<std::string> messages = dest->getMessages();
+      REQUIRE(messages.size() == threadCount * messageCount);
+
+      std::vector<int> next(threadCount, 0);
+      for (const std::string& message: messages)
+      {
+         for (int t = 0; t < threadCount; ++t)
+         {
+            if (endsWith(message, " " + std::to_string(t) + ":" + std::to_string(next[t]) + "\n"))
+            {
+               ++next[t];
+               break;
+            }
+         }
+      }
+
+      for (int t = 0; t < threadCount; ++t)
+         CHECK(next[t] == messageCount);
+   }
+
+   SECTION("Messages are dropped and counted when the queue is full")
+   {
+      enableAsyncLogging(2, AsyncLogOverflowPolicy::DROP);
+      const uint64_t droppedBefore = getDroppedLogMessageCount();
+
+      dest->close();
+      logErrorMessage("first");
+      dest->waitUntilBlocked();
+
+      for (int i = 0; i < 10; ++i)
+         logErrorMessage("queued " + std::to_string(i));
+
+      CHECK(getDroppedLogMessageCount() - droppedBefore == 8);
+
+      dest->open();
+      disableAsyncLogging();
+
+      std::vector<std::string> messages = dest->getMessages();
+      REQUIRE(messages.size() == 4);
+      CHECK(endsWith(messages[0], " first\n"));
+      CHECK(indexOf(messages, " queued 0\n") < indexOf(messages, " queued 1\n"));
+      CHECK(indexOf(messages, " queued 1\n") < messages.size());
+      CHECK(indexOf(messages, "Dropped 8 log messages") < messages.size());
+   }
+
+   SECTION("Only debug messages are dropped by the drop-debug policy")
+   {
+      enableAsyncLogging(2, AsyncLogOverflowPolicy::DROP_DEBUG);
+      const uint64_t droppedBefore = getDroppedLogMessageCount();
+
+      dest->close();
+      logErrorMessage("first");
+      dest->waitUntilBlocked();
+
+      for (int i = 0; i < 4; ++i)
+         logDebugMessage("debug " + std::to_string(i));
+
+      CHECK(getDroppedLogMessageCount() - droppedBefore == 2);
+
+      // This waits for room in the queue, which is only made once the destination is opened.
+      std::thread opener([&dest]()
+      {
+         std::this_thread::sleep_for(std::chrono::milliseconds(50));
+         dest->open();
+      });
+      logErrorMessage("error");
+      opener.join();
+
+      disableAsyncLogging();
+      CHECK(getDroppedLogMessageCount() - droppedBefore == 2);
+
+      std::vector<std::string> messages = dest->getMessages();
+      REQUIRE(messages.size() == 5);
+      CHECK(endsWith(messages[0], " first\n"));
+      CHECK(indexOf(messages, " debug 0\n") < indexOf(messages, " debug 1\n"));
+      CHECK(indexOf(messages, " debug 1\n") < indexOf(messages, " error\n"));
+      CHECK(indexOf(messages, " error\n") < messages.size());
+      CHECK(indexOf(messages, "Dropped 2 log messages") < messages.size());
+   }
+
+   removeLogDestination(dest->getId());
+}
+
+} // namespace logging
+} // namespace launcher_plugins
+} // namespace rstudio
@@ -0,0 +1,173 @@
+/*
+ * FileLogDestinationTests.cpp
+ *
+ * Copyright (C) 2020 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <TestMain.hpp>
+
+#include <chrono>
+#include <thread>
+
+#include <Error.hpp>
+#include <logging/FileLogDestination.hpp>
+#include <system/FilePath.hpp>
+#include <utils/FileUtils.hpp>
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace logging {
+
+namespace {
+
+constexpr const char* s_programId = "rlps-file-log-tests";
+
+system::FilePath getLogDirectory()
+{
+   system::FilePath logDir =
+      system::FilePath::safeCurrentPath(system::FilePath("/tmp")).completeChildPath("file-log-test-logs");
+   REQUIRE_FALSE(logDir.removeIfExists());
+   REQUIRE_FALSE(logDir.ensureDirectory());
+   return logDir;
+}
+
+FileLogOptions getOptions(const system::FilePath& in_logDir, double in_maxSizeMb = 2)
+{
+   return FileLogOptions(in_logDir, "600", in_maxSizeMb, 1, 100, 30, true, false, false, false);
+}
+
+std::string readLog(const system::FilePath& in_logFile)
+{
+   std::string contents;
+   Error error = utils::readFileIntoString(in_logFile, contents);
+   return error ? "" : contents;
+}
+
+} // anonymous namespace
+
+TEST_CASE("File log destination writes")
+{
+   system::FilePath logDir = getLogDirectory();
+   system::FilePath logFile = logDir.completeChildPath(std::string(s_programId) + ".log");
+
+   SECTION("Errors are written immediately")
+   {
+      FileLogDestination dest("1", LogLevel::DEBUG, LogMessageFormatType::PRETTY, s_programId, getOptions(logDir));
+      dest.writeLog(LogLevel::ERR, "first error\n");
+      dest.writeLog(LogLevel::WARN, "first warning\n");
+
+      CHECK(readLog(logFile) == "first error\nfirst warning\n");
+   }
+
+   SECTION("Buffered messages are written in order")
+   {
+      {
+         FileLogDestination dest("2", LogLevel::DEBUG, LogMessageFormatType::PRETTY, s_programId, getOptions(logDir));
+         dest.writeLog(LogLevel::DEBUG, "debug\n");
+         dest.writeLog(LogLevel::INFO, "info\n");
+         dest.writeLog(LogLevel::ERR, "error\n");
+         dest.writeLog(LogLevel::INFO, "last\n");
+      }
+
+      CHECK(readLog(logFile) == "debug\ninfo\nerror\nlast\n");
+   }
+
+   SECTION("Buffered messages are written periodically")
+   {
+      FileLogDestination dest("3", LogLevel::DEBUG, LogMessageFormatType::PRETTY, s_programId, getOptions(logDir));
+      dest.writeLog(LogLevel::INFO, "info\n");
+
+      std::string contents;
+      for (int i = 0; (i < 50) && contents.empty(); ++i)
+      {
+         std::this_thread::sleep_for(std::chrono::milliseconds(100));
+         contents = readLog(logFile);
+      }
+
+      CHECK(contents == "info\n");
+   }
+
+   SECTION("Messages above the log level are not written")
+   {
+      {
+         FileLogDestination dest("4", LogLevel::WARN, LogMessageFormatType::PRETTY, s_programId, getOptions(logDir));
+         dest.writeLog(LogLevel::INFO, "info\n");
+         dest.writeLog(LogLevel::WARN, "warning\n");
+      }
+
+      CHECK(readLog(logFile) == "warning\n");
+   }
+}
+
+TEST_CASE("File log destination rotation")
+{
+   system::FilePath logDir = getLogDirectory();
+   system::FilePath logFile = logDir.completeChildPath(std::string(s_programId) + ".log");
+   system::FilePath rotatedFile = logDir.completeChildPath(std::string(s_programId) + ".1.log");
+
+   SECTION("Rotates by size")
+   {
+      // 1 KB maximum.
+      FileLogDestination dest(
+         "5",
+         LogLevel::DEBUG,
+         LogMessageFormatType::PRETTY,
+         s_programId,
+         getOptions(logDir, 1.0 / 1024));
+
+      const std::string message(600, 'a');
+      dest.writeLog(LogLevel::ERR, message + "\n");
+      dest.writeLog(LogLevel::ERR, message + "\n");
+      CHECK_FALSE(rotatedFile.exists());
+
+      dest.writeLog(LogLevel::ERR, "after rotation\n");
+      REQUIRE(rotatedFile.exists());
+      CHECK(readLog(rotatedFile) == message + "\n" + message + "\n");
+      CHECK(readLog(logFile) == "after rotation\n");
+   }
+
+   SECTION("Detects external rotation")
+   {
+      FileLogDestination dest("6", LogLevel::DEBUG, LogMessageFormatType::PRETTY, s_programId, getOptions(logDir));
+      dest.writeLog(LogLevel::ERR, "before\n");
+
+      system::FilePath movedFile = logDir.completeChildPath("moved.log");
+      REQUIRE_FALSE(logFile.move(movedFile));
+
+      dest.writeLog(LogLevel::ERR, "after\n");
+      CHECK(readLog(movedFile) == "before\n");
+      CHECK(readLog(logFile) == "after\n");
+   }
+
+   SECTION("Detects external removal")
+   {
+      FileLogDestination dest("7", LogLevel::DEBUG, LogMessageFormatType::PRETTY, s_programId, getOptions(logDir));
+      dest.writeLog(LogLevel::ERR, "before\n");
+
+      REQUIRE_FALSE(logFile.remove());
+
+      dest.writeLog(LogLevel::ERR, "after\n");
+      CHECK(readLog(logFile) == "after\n");
+   }
+}
+
+} // namespace logging
+} // namespace launcher_plugins
+} // namespace rstudio
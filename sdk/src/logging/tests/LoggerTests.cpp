@@ -0,0 +1,300 @@
+/*
+ * LoggerTests.cpp
+ *
+ * Copyright (C) 2020 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <TestMain.hpp>
+
+#include <thread>
+
+#include <boost/regex.hpp>
+
+#include <Error.hpp>
+#include <json/Json.hpp>
+#include <logging/Logger.hpp>
+#include <system/DateTime.hpp>
+
+#include <MockLogDestination.hpp>
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace logging {
+
+namespace {
+
+constexpr const char* s_programId = "rlps-logger-tests";
+
+/**
+ * @brief Log destination which keeps the last message written to it.
+ */
+class LastMessageLogDestination : public ILogDestination
+{
+public:
+   LastMessageLogDestination(
+      const std::string& in_id,
+      LogLevel in_logLevel = LogLevel::DEBUG,
+      LogMessageFormatType in_formatType = LogMessageFormatType::JSON) :
+         ILogDestination(in_id, in_logLevel, in_formatType, false)
+   {
+   }
+
+   void refresh(const RefreshParams&) override
+   {
+   }
+
+   void writeLog(LogLevel, const std::string& in_message) override
+   {
+      LastMessage = in_message;
+   }
+
+   std::string LastMessage;
+};
+
+std::string countEvaluation(int& io_count)
+{
+   ++io_count;
+   return "evaluated";
+}
+
+} // anonymous namespace
+
+// This must run before any test case that registers the mock log destination, which logs all levels.
+TEST_CASE("Log level checks")
+{
+   std::shared_ptr<LastMessageLogDestination> warnDest(new LastMessageLogDestination("warn-dest", LogLevel::WARN));
+   addLogDestination(warnDest);
+
+   CHECK(isLogLevelEnabled(LogLevel::ERR));
+   CHECK(isLogLevelEnabled(LogLevel::WARN));
+   CHECK_FALSE(isLogLevelEnabled(LogLevel::INFO));
+   CHECK_FALSE(isLogLevelEnabled(LogLevel::DEBUG, "some-section"));
+
+   SECTION("Macro arguments are only evaluated when the level is enabled")
+   {
+      int count = 0;
+      LOG_DEBUG_MESSAGE(countEvaluation(count));
+      LOG_INFO_MESSAGE(countEvaluation(count));
+      CHECK(count == 0);
+
+      std::shared_ptr<LastMessageLogDestination> infoDest(new LastMessageLogDestination("info-dest", LogLevel::INFO));
+      addLogDestination(infoDest);
+
+      LOG_DEBUG_MESSAGE(countEvaluation(count));
+      LOG_INFO_MESSAGE(countEvaluation(count));
+      CHECK(count == 1);
+      CHECK(infoDest->LastMessage.find("evaluated") != std::string::npos);
+
+      // Removing the destination lowers the level again.
+      removeLogDestination(infoDest->getId());
+      CHECK_FALSE(isLogLevelEnabled(LogLevel::INFO));
+   }
+
+   SECTION("Sectioned destinations only enable their own sections")
+   {
+      std::shared_ptr<LastMessageLogDestination> sectionDest(
+         new LastMessageLogDestination("section-dest", LogLevel::DEBUG));
+      addLogDestination(sectionDest, "debug-section");
+
+      CHECK(isLogLevelEnabled(LogLevel::DEBUG, "debug-section"));
+      CHECK_FALSE(isLogLevelEnabled(LogLevel::DEBUG));
+
+      logDebugMessage("to the section", "debug-section");
+      CHECK(sectionDest->LastMessage.find("to the section") != std::string::npos);
+
+      logDebugMessage("to the default destinations");
+      CHECK(warnDest->LastMessage.empty());
+
+      removeLogDestination(sectionDest->getId(), "debug-section");
+      CHECK_FALSE(isLogLevelEnabled(LogLevel::DEBUG, "debug-section"));
+   }
+
+   removeLogDestination(warnDest->getId());
+   CHECK_FALSE(isLogLevelEnabled(LogLevel::ERR));
+}
+
+TEST_CASE("Log message formatting")
+{
+   setProgramId(s_programId);
+   MockLogPtr prettyDest = getMockLogDest();
+   std::shared_ptr<LastMessageLogDestination> jsonDest(new LastMessageLogDestination("json-test-dest"));
+   addLogDestination(jsonDest);
+
+   SECTION("Pretty messages are one line")
+   {
+      logInfoMessage("first line\nsecond line \n\t");
+
+      REQUIRE(prettyDest->getSize() == 1);
+      const std::string message = prettyDest->pop().Message;
+
+      boost::regex expected(
+         "\\d{4}-\\d{2}-\\d{2}T\\d{2}:\\d{2}:\\d{2}(\\.\\d{6})?Z \\[rlps-logger-tests\\] INFO "
+         "first line\\|\\|\\|second line\\n");
+      CHECK(boost::regex_match(message, expected));
+
+      // The timestamp is the current time.
+      system::DateTime time;
+      REQUIRE_FALSE(system::DateTime::fromString(message.substr(0, message.find(' ')), time));
+      CHECK(system::DateTime() - time < system::TimeDuration::Seconds(5));
+   }
+
+   SECTION("Pretty messages include properties and location")
+   {
+      Optional<LogMessageProperties> properties(LogMessageProperties{ { "count", 3 } });
+      logWarningMessage("warn", "", properties, ERROR_LOCATION);
+
+      REQUIRE(prettyDest->getSize() == 1);
+      const std::string message = prettyDest->pop().Message;
+      CHECK(message.find(" WARNING warn [count: 3]; LOGGED FROM: ") != std::string::npos);
+      CHECK(message.back() == '\n');
+   }
+
+   SECTION("JSON messages are escaped")
+   {
+      const std::string text = "quote \" backslash \\ tab \t bell \x07 unicode \xC3\xA9\nnext";
+      Optional<LogMessageProperties> properties(LogMessageProperties{ { "name", std::string("a\"b") } });
+      logErrorMessage(text, "", properties, ErrorLocation());
+
+      const std::string& line = jsonDest->LastMessage;
+      REQUIRE(!line.empty());
+      CHECK(line.back() == '\n');
+      CHECK(line.find('\n') == line.size() - 1);
+
+      json::Object obj;
+      REQUIRE_FALSE(obj.parse(line));
+      CHECK(obj["service"].getString() == s_programId);
+      CHECK(obj["level"].getString() == "ERROR");
+      CHECK(obj["message"].getString() == "quote \" backslash \\ tab \t bell \x07 unicode \xC3\xA9|||next");
+      CHECK(obj["properties"].getObject()["name"].getString() == "a\"b");
+      CHECK_FALSE(obj["time"].getString().empty());
+   }
+
+   SECTION("JSON messages include errors")
+   {
+      logError(unknownError("it failed", ERROR_LOCATION));
+
+      json::Object obj;
+      REQUIRE_FALSE(obj.parse(jsonDest->LastMessage));
+      REQUIRE(obj["error"].isObject());
+      CHECK(obj["error"].getObject()["message"].getString() == "it failed");
+      CHECK(obj.find("message") == obj.end());
+   }
+
+   removeLogDestination(jsonDest->getId());
+}
+
+TEST_CASE("Rate limited logging")
+{
+   SECTION("Messages beyond the limit are suppressed")
+   {
+      LogRateLimiter limiter(2, system::TimeDuration::Hours(1));
+
+      uint64_t suppressed = 99;
+      CHECK(limiter.tryAcquire(suppressed));
+      CHECK(suppressed == 0);
+      CHECK(limiter.tryAcquire(suppressed));
+      for (int i = 0; i < 5; ++i)
+         CHECK_FALSE(limiter.tryAcquire(suppressed));
+   }
+
+   SECTION("Suppressed messages are sampled")
+   {
+      LogRateLimiter limiter(1, system::TimeDuration::Hours(1), 3);
+
+      uint64_t suppressed = 0;
+      CHECK(limiter.tryAcquire(suppressed));
+      CHECK_FALSE(limiter.tryAcquire(suppressed));
+      CHECK_FALSE(limiter.tryAcquire(suppressed));
+      CHECK(limiter.tryAcquire(suppressed));
+      CHECK(suppressed == 2);
+      CHECK_FALSE(limiter.tryAcquire(suppressed));
+   }
+
+   SECTION("The limit is reset each interval")
+   {
+      LogRateLimiter limiter(1, system::TimeDuration::Microseconds(20000));
+
+      uint64_t suppressed = 0;
+      CHECK(limiter.tryAcquire(suppressed));
+      CHECK_FALSE(limiter.tryAcquire(suppressed));
+      CHECK_FALSE(limiter.tryAcquire(suppressed));
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(30));
+      CHECK(limiter.tryAcquire(suppressed));
+      CHECK(suppressed == 2);
+   }
+
+   SECTION("The suppressed count is logged")
+   {
+      MockLogPtr logDest = getMockLogDest();
+
+      for (int i = 0; i < 5; ++i)
+         LOG_RATE_LIMITED(LogLevel::INFO, 2, 3600, "repeated " + std::to_string(i));
+
+      REQUIRE(logDest->getSize() == 2);
+      CHECK(logDest->pop().Message.find("repeated 0") != std::string::npos);
+      CHECK(logDest->pop().Message.find("repeated 1") != std::string::npos);
+
+      logRateLimitedMessage(LogLevel::WARN, "again", 3, ErrorLocation());
+      REQUIRE(logDest->getSize() == 1);
+      CHECK(logDest->pop().Message.find(" WARNING again [suppressedMessages: 3]") != std::string::npos);
+
+      LogRateLimiter limiter(1, system::TimeDuration::Hours(1), 2);
+      for (int i = 0; i < 3; ++i)
+         logErrorRateLimited(limiter, unknownError("failure " + std::to_string(i), ERROR_LOCATION));
+
+      REQUIRE(logDest->getSize() == 2);
+      CHECK(logDest->pop().Message.find("failure 0") != std::string::npos);
+      const std::string message = logDest->pop().Message;
+      CHECK(message.find("failure 2") != std::string::npos);
+      CHECK(message.find("suppressedErrors: 1") != std::string::npos);
+   }
+
+   SECTION("Suppressed messages are reported once the interval ends")
+   {
+      MockLogPtr logDest = getMockLogDest();
+
+      LogRateLimiter limiter(1, system::TimeDuration::Microseconds(20000), 0, LogLevel::WARN, ERROR_LOCATION);
+      uint64_t suppressed = 0;
+      CHECK(limiter.tryAcquire(suppressed));
+      for (int i = 0; i < 3; ++i)
+         CHECK_FALSE(limiter.tryAcquire(suppressed));
+
+      // Not until the interval in which they were suppressed has ended.
+      LogRateLimiter::reportSuppressedMessages();
+      CHECK(logDest->getSize() == 0);
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(30));
+      LogRateLimiter::reportSuppressedMessages();
+      REQUIRE(logDest->getSize() == 1);
+      CHECK(logDest->pop().Message.find(" WARNING 3 similar messages suppressed [suppressedMessages: 3]") !=
+         std::string::npos);
+
+      // Each suppressed message is only reported once.
+      LogRateLimiter::reportSuppressedMessages();
+      CHECK(logDest->getSize() == 0);
+      CHECK(limiter.tryAcquire(suppressed));
+      CHECK(suppressed == 0);
+   }
+}
+
+} // namespace logging
+} // namespace launcher_plugins
+} // namespace rstudio
@@ -0,0 +1,220 @@
+/*
+ * SyslogDestinationTests.cpp
+ *
+ * Copyright (C) 2020 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <TestMain.hpp>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <Error.hpp>
+#include <system/FilePath.hpp>
+
+#include "../SyslogDestination.hpp"
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace logging {
+
+namespace {
+
+constexpr const char* s_programId = "rlps-syslog-tests";
+
+/**
+ * @brief Datagram socket which stands in for the system logger.
+ */
+class SyslogReceiver
+{
+public:
+   explicit SyslogReceiver(const system::FilePath& in_socketPath) :
+      m_socket(-1),
+      m_socketPath(in_socketPath.getAbsolutePath())
+   {
+      open();
+   }
+
+   ~SyslogReceiver()
+   {
+      close();
+   }
+
+   void close()
+   {
+      if (m_socket >= 0)
+      {
+         ::close(m_socket);
+         ::unlink(m_socketPath.c_str());
+         m_socket = -1;
+      }
+   }
+
+   void open()
+   {
+      m_socket = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+      REQUIRE(m_socket >= 0);
+
+      struct sockaddr_un address;
+      std::memset(&address, 0, sizeof(address));
+      address.sun_family = AF_UNIX;
+      std::strncpy(address.sun_path, m_socketPath.c_str(), sizeof(address.sun_path) - 1);
+      REQUIRE(::bind(m_socket, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0);
+   }
+
+   bool receive(std::string& out_datagram, int in_timeoutMs = 5000)
+   {
+      struct pollfd pollFd = { m_socket, POLLIN, 0 };
+      if (::poll(&pollFd, 1, in_timeoutMs) <= 0)
+         return false;
+
+      char buffer[4096];
+      ssize_t size = ::recv(m_socket, buffer, sizeof(buffer), 0);
+      if (size < 0)
+         return false;
+
+      out_datagram.assign(buffer, static_cast<size_t>(size));
+      return true;
+   }
+
+private:
+   int m_socket;
+   const std::string m_socketPath;
+};
+
+size_t getSequenceNumber(const std::string& in_datagram)
+{
+   size_t pos = in_datagram.rfind("message ");
+   return (pos == std::string::npos) ? std::string::npos : std::stoul(in_datagram.substr(pos + 8));
+}
+
+} // anonymous namespace
+
+TEST_CASE("Syslog destination")
+{
+   system::FilePath socketPath;
+   REQUIRE_FALSE(system::FilePath::tempFilePath(socketPath));
+
+   SyslogReceiver receiver(socketPath);
+   SyslogDestination dest(
+      "syslog-test-dest",
+      LogLevel::DEBUG,
+      LogMessageFormatType::PRETTY,
+      s_programId,
+      false,
+      socketPath);
+
+   SECTION("Messages are sent in order")
+   {
+      for (size_t i = 0; i < 5; ++i)
+         dest.writeLog(LogLevel::INFO, "message " + std::to_string(i));
+
+      for (size_t i = 0; i < 5; ++i)
+      {
+         std::string datagram;
+         REQUIRE(receiver.receive(datagram));
+         CHECK(datagram.find("<14>") == 0);
+         CHECK(datagram.find(std::string(s_programId) + "[") != std::string::npos);
+         CHECK(getSequenceNumber(datagram) == i);
+      }
+
+      CHECK(dest.getDroppedMessageCount() == 0);
+   }
+
+   SECTION("Messages beyond the queue are dropped and reported")
+   {
+      // The receiver isn't reading, so the socket fills up first and then the queue.
+      constexpr size_t messageCount = 3000;
+      for (size_t i = 0; i < messageCount; ++i)
+         dest.writeLog(LogLevel::INFO, "message " + std::to_string(i));
+
+      const uint64_t droppedCount = dest.getDroppedMessageCount();
+      CHECK(droppedCount > 0);
+
+      size_t received = 0;
+      std::string datagram;
+      while (receiver.receive(datagram))
+      {
+         if (datagram.find("messages were not written to the system log") != std::string::npos)
+         {
+            CHECK(datagram.find("<12>") == 0);
+            CHECK(datagram.find(": " + std::to_string(droppedCount) + " messages") != std::string::npos);
+            break;
+         }
+
+         CHECK(getSequenceNumber(datagram) == received);
+         ++received;
+      }
+
+      // Only the newest messages are dropped, and the report is sent after all the queued messages.
+      CHECK(received + droppedCount == messageCount);
+   }
+
+   SECTION("Messages which are too large are dropped and reported")
+   {
+      dest.writeLog(LogLevel::INFO, std::string(1024 * 1024, 'x'));
+      dest.writeLog(LogLevel::INFO, "message 0");
+
+      // The report may be sent before or after the next message, depending on when the sender thread runs.
+      std::string first, second;
+      REQUIRE(receiver.receive(first));
+      REQUIRE(receiver.receive(second));
+      if (getSequenceNumber(first) != 0)
+         std::swap(first, second);
+
+      CHECK(getSequenceNumber(first) == 0);
+      CHECK(second.find(": 1 messages were not written to the system log") != std::string::npos);
+      CHECK(dest.getDroppedMessageCount() == 1);
+   }
+
+   SECTION("Reconnects when the system logger restarts")
+   {
+      dest.writeLog(LogLevel::INFO, "message 0");
+
+      std::string datagram;
+      REQUIRE(receiver.receive(datagram));
+      CHECK(getSequenceNumber(datagram) == 0);
+
+      // Messages written while the system logger is down are queued until it is back.
+      receiver.close();
+      dest.writeLog(LogLevel::INFO, "message 1");
+      dest.writeLog(LogLevel::INFO, "message 2");
+      receiver.open();
+
+      for (size_t i = 1; i <= 2; ++i)
+      {
+         REQUIRE(receiver.receive(datagram));
+         CHECK(getSequenceNumber(datagram) == i);
+      }
+
+      CHECK(dest.getDroppedMessageCount() == 0);
+   }
+}
+
+} // namespace logging
+} // namespace launcher_plugins
+} // namespace rstudio
@@ -0,0 +1,207 @@
+/*
+ * TraceTests.cpp
+ * 
+ * Copyright (C) 2022 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <TestMain.hpp>
+
+#include <unistd.h>
+
+#include <thread>
+#include <vector>
+
+#include <Error.hpp>
+#include <json/Json.hpp>
+#include <logging/Trace.hpp>
+#include <system/FilePath.hpp>
+#include <utils/FileUtils.hpp>
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace logging {
+
+namespace {
+
+/**
+ * @brief A span read back from a written trace file.
+ */
+struct WrittenSpan
+{
+   std::string JobId;
+   std::string Name;
+   uint64_t RequestId;
+   int ThreadId;
+};
+
+system::FilePath getTraceFile()
+{
+   return system::FilePath::safeCurrentPath(system::FilePath("/tmp")).completeChildPath("rlps-trace-tests.json");
+}
+
+std::vector<WrittenSpan> readTrace()
+{
+   const system::FilePath traceFile = getTraceFile();
+   REQUIRE_FALSE(writeTrace(traceFile));
+
+   std::string contents;
+   REQUIRE_FALSE(utils::readFileIntoString(traceFile, contents));
+
+   json::Object trace;
+   REQUIRE_FALSE(trace.parse(contents));
+
+   std::string displayTimeUnit;
+   REQUIRE_FALSE(json::readObject(trace, "displayTimeUnit", displayTimeUnit));
+   CHECK(displayTimeUnit == "ms");
+
+   json::Array traceEvents;
+   REQUIRE_FALSE(json::readObject(trace, "traceEvents", traceEvents));
+
+   std::vector<WrittenSpan> spans;
+   for (size_t i = 0, n = traceEvents.getSize(); i < n; ++i)
+   {
+      REQUIRE(traceEvents[i].isObject());
+      const json::Object traceEvent = traceEvents[i].getObject();
+
+      std::string category, phase;
+      uint64_t duration = 0, timestamp = 0;
+      int processId = 0;
+      WrittenSpan span = { "", "", 0, 0 };
+      REQUIRE_FALSE(json::readObject(traceEvent, "name", span.Name));
+      REQUIRE_FALSE(json::readObject(traceEvent, "cat", category));
+      REQUIRE_FALSE(json::readObject(traceEvent, "ph", phase));
+      REQUIRE_FALSE(json::readObject(traceEvent, "ts", timestamp));
+      REQUIRE_FALSE(json::readObject(traceEvent, "dur", duration));
+      REQUIRE_FALSE(json::readObject(traceEvent, "pid", processId));
+      REQUIRE_FALSE(json::readObject(traceEvent, "tid", span.ThreadId));
+      CHECK(category == "rlps");
+      CHECK(phase == "X");
+      CHECK(processId == ::getpid());
+
+      json::Object args;
+      REQUIRE_FALSE(json::readObject(traceEvent, "args", args));
+      json::readObject(args, "jobId", span.JobId);
+      json::readObject(args, "requestId", span.RequestId);
+
+      spans.push_back(span);
+   }
+
+   return spans;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Spans are not recorded when tracing is disabled")
+{
+   disableTracing();
+   CHECK_FALSE(isTracingEnabled());
+
+   {
+      TraceSpan span("disabled", 1, "job-1");
+   }
+
+   CHECK(readTrace().empty());
+}
+
+TEST_CASE("Spans are recorded with their request and job IDs")
+{
+   enableTracing(10);
+   CHECK(isTracingEnabled());
+
+   {
+      TraceSpan outer("outer", 42);
+      TraceSpan inner("inner");
+      inner.setRequestId(42);
+      inner.setJobId("job-42");
+   }
+
+   TraceSpan ended("ended", 7, "job-7");
+   ended.end();
+   ended.end();
+
+   std::vector<WrittenSpan> spans = readTrace();
+   REQUIRE(spans.size() == 3);
+
+   // Spans are recorded when they end, so the inner span comes first.
+   CHECK(spans[0].Name == "inner");
+   CHECK(spans[0].RequestId == 42);
+   CHECK(spans[0].JobId == "job-42");
+   CHECK(spans[1].Name == "outer");
+   CHECK(spans[1].RequestId == 42);
+   CHECK(spans[1].JobId.empty());
+   CHECK(spans[2].Name == "ended");
+   CHECK(spans[2].RequestId == 7);
+   CHECK(spans[2].JobId == "job-7");
+
+   disableTracing();
+   CHECK(readTrace().empty());
+}
+
+TEST_CASE("Only the newest spans of each thread are kept")
+{
+   enableTracing(3);
+
+   for (uint64_t i = 1; i <= 5; ++i)
+      TraceSpan span("span", i);
+
+   std::vector<WrittenSpan> spans = readTrace();
+   REQUIRE(spans.size() == 3);
+   CHECK(spans[0].RequestId == 3);
+   CHECK(spans[1].RequestId == 4);
+   CHECK(spans[2].RequestId == 5);
+
+   // Changing the buffer size discards the recorded spans.
+   enableTracing(4);
+   CHECK(readTrace().empty());
+
+   disableTracing();
+}
+
+TEST_CASE("Spans are recorded for each thread")
+{
+   enableTracing(10);
+
+   std::vector<std::thread> threads;
+   for (uint64_t i = 1; i <= 4; ++i)
+      threads.emplace_back([i]() { TraceSpan span("thread", i); });
+
+   for (std::thread& thread: threads)
+      thread.join();
+
+   // The spans of threads which have exited are still written.
+   std::vector<WrittenSpan> spans = readTrace();
+   REQUIRE(spans.size() == 4);
+
+   uint64_t requestIdSum = 0;
+   for (size_t i = 0; i < spans.size(); ++i)
+   {
+      requestIdSum += spans[i].RequestId;
+      for (size_t j = i + 1; j < spans.size(); ++j)
+         CHECK(spans[i].ThreadId != spans[j].ThreadId);
+   }
+
+   CHECK(requestIdSum == 10);
+
+   disableTracing();
+}
+
+} // namespace logging
+} // namespace launcher_plugins
+} // namespace rstudio
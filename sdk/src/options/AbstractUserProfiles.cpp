@@ -24,13 +24,18 @@
 #include <options/AbstractUserProfiles.hpp>
 
 #include <cassert>
+#include <cctype>
+#include <cstring>
 #include <grp.h>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
 
-#include <boost/regex.hpp>
 #include <boost/algorithm/string.hpp>
-#include <boost/algorithm/string_regex.hpp>
 #include <boost/property_tree/ini_parser.hpp>
 
 #include <Error.hpp>
@@ -38,6 +43,7 @@
 #include <system/User.hpp>
 #include <system/FilePath.hpp>
 #include <utils/FileUtils.hpp>
+#include <utils/MutexUtils.hpp>
 
 namespace rstudio {
 namespace launcher_plugins {
@@ -128,17 +134,64 @@ Error parseValue(const std::string& in_value, std::string& out_parsedValue)
    return Success();
 }
 
+// The delimiter between elements of a list or set.
+constexpr const char* LIST_DELIMITER = ",";
+
+// The delimiter between entries of a map.
+constexpr const char* MAP_ENTRY_DELIMITER = "\\;";
+
+// The delimiter between the key and the value of a map entry.
+constexpr const char* MAP_KEY_DELIMITER = "\\=";
+
+/**
+ * @brief Splits a value on each occurrence of a delimiter and trims the whitespace from each element.
+ *
+ * An empty value has no elements, and an empty element after a trailing delimiter is ignored.
+ *
+ * @param in_value          The value to split.
+ * @param in_delimiter      The delimiter between elements.
+ * @param out_elements      The trimmed elements of the value.
+ */
+void splitValue(const std::string& in_value, const char* in_delimiter, std::vector<std::string>& out_elements)
+{
+   if (in_value.empty())
+      return;
+
+   const size_t delimiterLength = std::strlen(in_delimiter);
+   size_t start = 0;
+   while (true)
+   {
+      const size_t end = in_value.find(in_delimiter, start);
+      const size_t elementEnd = (end == std::string::npos) ? in_value.size() : end;
+
+      size_t first = start, last = elementEnd;
+      while ((first < last) && std::isspace(static_cast<unsigned char>(in_value[first])))
+         ++first;
+      while ((last > first) && std::isspace(static_cast<unsigned char>(in_value[last - 1])))
+         --last;
+
+      if (end == std::string::npos)
+      {
+         if ((first < last) || (start == 0))
+            out_elements.emplace_back(in_value, first, last - first);
+         return;
+      }
+
+      out_elements.emplace_back(in_value, first, last - first);
+      start = end + delimiterLength;
+   }
+}
+
 template <typename U>
 Error parseValue(const std::string& in_value, std::set<U>& out_parsedValues)
 {
-   const boost::regex splitExpr("\\s*,\\s*");
-   boost::sregex_token_iterator itr(in_value.begin(), in_value.end(), splitExpr, -1);
-   boost::sregex_token_iterator end;
+   std::vector<std::string> elements;
+   splitValue(in_value, LIST_DELIMITER, elements);
 
-   for (; itr != end; ++itr)
+   for (const std::string& element: elements)
    {
       U value;
-      Error error = parseValue(*itr, value);
+      Error error = parseValue(element, value);
       if (error)
       {
          error.addOrUpdateProperty("full-value", in_value);
@@ -154,14 +207,14 @@ Error parseValue(const std::string& in_value, std::set<U>& out_parsedValues)
 template <typename U>
 Error parseValue(const std::string& in_value, std::vector<U>& out_parsedValues)
 {
-   const boost::regex splitExpr("\\s*,\\s*");
-   boost::sregex_token_iterator itr(in_value.begin(), in_value.end(), splitExpr, -1);
-   boost::sregex_token_iterator end;
+   std::vector<std::string> elements;
+   splitValue(in_value, LIST_DELIMITER, elements);
 
-   for (; itr != end; ++itr)
+   out_parsedValues.reserve(out_parsedValues.size() + elements.size());
+   for (const std::string& element: elements)
    {
       U value;
-      Error error = parseValue(*itr, value);
+      Error error = parseValue(element, value);
       if (error)
       {
          error.addOrUpdateProperty("full-value", in_value);
@@ -177,39 +230,44 @@ Error parseValue(const std::string& in_value, std::vector<U>& out_parsedValues)
 template <typename U, typename V>
 Error parseValue(const std::string& in_value, std::map<U, V>& out_parsedValues)
 {
-   const boost::regex splitExpr("\\s*\\\\;\\s*");
-   boost::sregex_token_iterator itr(in_value.begin(), in_value.end(), splitExpr, -1);
-   boost::sregex_token_iterator end;
+   std::vector<std::string> entries;
+   splitValue(in_value, MAP_ENTRY_DELIMITER, entries);
 
-   for (; itr != end; ++itr)
+   const size_t keyDelimiterLength = std::strlen(MAP_KEY_DELIMITER);
+   for (const std::string& entry: entries)
    {
-      std::string currVal(itr->first, itr->second);
-      std::vector<std::string> keyValStrs;
-      boost::algorithm::split_regex(keyValStrs, currVal, boost::regex("\\\\="));
-
-      if (keyValStrs.size() < 2)
+      const size_t keyEnd = entry.find(MAP_KEY_DELIMITER);
+      if (keyEnd == std::string::npos)
       {
          Error error = userProfileError(
             UserProfileError::VALUE_PARSE_ERROR,
-            "Map value \"" + *itr + R"(" does not contain ":" delimiter. Expected exactly 1)",
+            "Map value \"" + entry + R"(" does not contain ":" delimiter. Expected exactly 1)",
             ERROR_LOCATION);
          error.addOrUpdateProperty("full-value", in_value);
          return error;
       }
-      else if (keyValStrs.size() > 2)
+
+      size_t delimiterCount = 1;
+      for (size_t pos = entry.find(MAP_KEY_DELIMITER, keyEnd + keyDelimiterLength);
+           pos != std::string::npos;
+           pos = entry.find(MAP_KEY_DELIMITER, pos + keyDelimiterLength))
+         ++delimiterCount;
+
+      if (delimiterCount > 1)
       {
          Error error = userProfileError(
             UserProfileError::VALUE_PARSE_ERROR,
-            "Map value \"" + *itr + "\" contains " +
-               std::to_string(keyValStrs.size() - 1) + " \":\" delimiters. Expected exactly 1.",
+            "Map value \"" + entry + "\" contains " +
+               std::to_string(delimiterCount) + " \":\" delimiters. Expected exactly 1.",
             ERROR_LOCATION);
          error.addOrUpdateProperty("full-value", in_value);
          return error;
       }
 
-      // Exactly 2 values in the vector if we get here.
+      // Exactly one delimiter in the entry if we get here.
+      const std::string keyStr = entry.substr(0, keyEnd);
       U key;
-      Error error = parseValue(keyValStrs[0], key);
+      Error error = parseValue(keyStr, key);
       if (error)
       {
          error.addOrUpdateProperty("full-value", in_value);
@@ -217,11 +275,11 @@ Error parseValue(const std::string& in_value, std::map<U, V>& out_parsedValues)
       }
 
       V value;
-      error = parseValue(keyValStrs[1], value);
+      error = parseValue(entry.substr(keyEnd + keyDelimiterLength), value);
       if (error)
       {
          error.addOrUpdateProperty("full-value", in_value);
-         error.addOrUpdateProperty("key-value", keyValStrs[0]);
+         error.addOrUpdateProperty("key-value", keyStr);
          return error;
       }
 
@@ -289,9 +347,46 @@ struct Group
 typedef std::set<std::string> GroupMembers;
 typedef std::map<Group, GroupMembers> GroupLookupMap;
 
+// The maximum number of users whose resolved values are cached.
+constexpr size_t MAX_RESOLVED_USERS = 4096;
+
+/**
+ * @brief A value from the profiles configuration file, along with the typed values it has been parsed into.
+ */
+struct ProfileValue
+{
+   /**
+    * @brief Constructor.
+    *
+    * @param in_raw     The value as it was written in the profiles configuration file.
+    */
+   explicit ProfileValue(std::string in_raw) : Raw(std::move(in_raw)) {}
+
+   /** The value as it was written in the profiles configuration file. */
+   const std::string Raw;
+
+   /** The parsed values, by the type they were parsed into. Guarded by the mutex of AbstractUserProfiles::Impl. */
+   std::unordered_map<std::type_index, std::shared_ptr<void> > Parsed;
+};
+
 // Level Typedefs
-typedef std::map<std::string, std::string> ValueMap;
+typedef std::shared_ptr<ProfileValue> ProfileValuePtr;
+typedef std::map<std::string, ProfileValuePtr> ValueMap;
 typedef std::pair<Level, ValueMap> LevelValue;
+typedef std::shared_ptr<const std::vector<LevelValue> > LevelValueListPtr;
+
+/**
+ * @brief The values which apply to a particular user, resolved from all the sections of the profiles configuration
+ *        file.
+ */
+struct ResolvedUser
+{
+   /** The primary group of the user when the values were resolved. */
+   system::GidType GroupId;
+
+   /** The most specific instance of each value which applies to the user, by value name. */
+   std::unordered_map<std::string, ProfileValuePtr> Values;
+};
 
 // Impl Struct =========================================================================================================
 struct AbstractUserProfiles::Impl
@@ -299,13 +394,28 @@ struct AbstractUserProfiles::Impl
    /**
     * @brief Gets the most specific instance of a value for the given user.
     *
+    * The values for a user are resolved the first time any value is requested for that user, and cached until the
+    * profiles configuration file is parsed again.
+    *
     * @param in_valueName       The name of the value to retrieve.
     * @param in_user            The user for whom to retrieve the value.
-    * @param out_value          The value, if any was found.
     *
-    * @return True if a value was found with the given name for the user; Error otherwise.
+    * @return The value, if any was found; nullptr otherwise.
     */
-   bool getValueForUser(const std::string& in_valueName, const system::User& in_user, std::string& out_value) const;
+   ProfileValuePtr getValueForUser(const std::string& in_valueName, const system::User& in_user) const;
+
+   /**
+    * @brief Gets a value parsed as the specified type. Each value is only parsed once for each type.
+    *
+    * @tparam T     The type of the value.
+    *
+    * @param in_value       The value to parse.
+    * @param out_value      The parsed value, if no error occurred.
+    *
+    * @return Success if the value could be parsed as type T; Error otherwise.
+    */
+   template <typename T>
+   Error getParsedValue(ProfileValue& in_value, T& out_value) const;
 
    /**
     * @brief Checks whether the specified user is in the specified group.
@@ -320,6 +430,9 @@ struct AbstractUserProfiles::Impl
    /**
     * @brief Iterates all sections of the ini and applies the in_onValueFound function to any values that were found.
     *
+    * While newly parsed sections are waiting to be validated, those sections are iterated instead of the sections in
+    * use.
+    *
     * @param in_valueName       The value to be validated.
     * @param in_onValueFound    The function to be invoked for each occurrence of in_valueName.
     *
@@ -327,11 +440,11 @@ struct AbstractUserProfiles::Impl
     */
    Error iterateValues(
       const std::string& in_valueName,
-      const std::function<Error(const std::string&)>& in_onValueFound) const;
+      const std::function<Error(ProfileValue&)>& in_onValueFound) const;
 
    /**
     * @brief Parses the sections from ini file data. Also gathers group information for any groups specified in the
-    *        file.
+    *        file. The parsed sections and groups are not used until applyPendingLevels is invoked.
     *
     * @param in_levelData       The string data from the ini file.
     * @param in_fieldNames      The names of valid fields.
@@ -341,19 +454,54 @@ struct AbstractUserProfiles::Impl
    Error parseLevels(const std::string& in_levelData, const std::set<std::string>& in_fieldNames);
 
    /**
-    * @brief Populates the Groups member with unix group information from the list of requested group names.
+    * @brief Starts using the sections and groups from the last call to parseLevels. Any values previously resolved
+    *        for users are discarded.
+    */
+   void applyPendingLevels();
+
+   /**
+    * @brief Discards the sections and groups from the last call to parseLevels.
+    */
+   void discardPendingLevels();
+
+   /**
+    * @brief Populates the lookup map with unix group information from the list of requested group names.
     *
     * @param in_groupNames      The list of group names for which to retrieve group information.
+    * @param out_groups         The group information.
     *
     * @return Success if all the group information could be populated; Error otherwise.
     */
-   Error populateGroups(const std::set<std::string>& in_groupNames);
+   static Error populateGroups(const std::set<std::string>& in_groupNames, GroupLookupMap& out_groups);
+
+   /**
+    * @brief Resolves the most specific instance of every value which applies to the given user.
+    *
+    * This method must be invoked while the mutex is locked.
+    *
+    * @param in_user            The user for whom to resolve the values.
+    * @param out_resolvedUser   The resolved values.
+    */
+   void resolveUser(const system::User& in_user, ResolvedUser& out_resolvedUser) const;
 
    /** Cached unix group information so we don't need to get it each time. */
    GroupLookupMap Groups;
 
    /** The parsed sections of the ini file. */
-   std::vector<LevelValue> LevelValues;
+   LevelValueListPtr LevelValues = std::make_shared<const std::vector<LevelValue> >();
+
+   /** The newly parsed sections and groups of the ini file which are being validated. */
+   LevelValueListPtr PendingLevelValues;
+   GroupLookupMap PendingGroups;
+
+   /** The resolved values of each user who has requested a value, by username. */
+   mutable std::unordered_map<std::string, ResolvedUser> ResolvedUsers;
+
+   /** Mutex which protects the sections, groups, resolved users and parsed values. */
+   mutable std::mutex Mutex;
+
+   /** Mutex which ensures the ini file is only parsed and validated by one thread at a time. */
+   std::mutex ReloadMutex;
 
    /** The configuration file. */
    system::FilePath ConfigurationFile;
@@ -361,18 +509,78 @@ struct AbstractUserProfiles::Impl
 
 PRIVATE_IMPL_DELETER_IMPL(AbstractUserProfiles)
 
-bool AbstractUserProfiles::Impl::getValueForUser(
+ProfileValuePtr AbstractUserProfiles::Impl::getValueForUser(
    const std::string& in_valueName,
-   const system::User& in_user,
-   std::string& out_value) const
+   const system::User& in_user) const
+{
+   ProfileValuePtr value;
+   LOCK_MUTEX(Mutex)
+   {
+      auto userItr = ResolvedUsers.find(in_user.getUsername());
+      if ((userItr == ResolvedUsers.end()) || (userItr->second.GroupId != in_user.getGroupId()))
+      {
+         // Users are rarely removed, so there is no need for anything smarter than starting over when the cache fills.
+         if (ResolvedUsers.size() >= MAX_RESOLVED_USERS)
+            ResolvedUsers.clear();
+
+         ResolvedUser& resolvedUser = ResolvedUsers[in_user.getUsername()];
+         resolveUser(in_user, resolvedUser);
+         userItr = ResolvedUsers.find(in_user.getUsername());
+      }
+
+      const auto valueItr = userItr->second.Values.find(in_valueName);
+      if (valueItr != userItr->second.Values.end())
+         value = valueItr->second;
+   }
+   END_LOCK_MUTEX
+
+   return value;
+}
+
+template <typename T>
+Error AbstractUserProfiles::Impl::getParsedValue(ProfileValue& in_value, T& out_value) const
 {
+   const std::type_index type(typeid(T));
+   std::shared_ptr<void> parsed;
+   LOCK_MUTEX(Mutex)
+   {
+      const auto itr = in_value.Parsed.find(type);
+      if (itr != in_value.Parsed.end())
+         parsed = itr->second;
+   }
+   END_LOCK_MUTEX
+
+   if (parsed == nullptr)
+   {
+      // Parse outside of the lock. If two threads race to parse the same value, they will get the same result.
+      std::shared_ptr<T> parsedValue(new T());
+      Error error = parseValue(in_value.Raw, *parsedValue);
+      if (error)
+         return error;
+
+      parsed = parsedValue;
+      LOCK_MUTEX(Mutex)
+      {
+         in_value.Parsed[type] = parsed;
+      }
+      END_LOCK_MUTEX
+   }
+
+   out_value = *static_cast<const T*>(parsed.get());
+   return Success();
+}
+
+void AbstractUserProfiles::Impl::resolveUser(const system::User& in_user, ResolvedUser& out_resolvedUser) const
+{
+   out_resolvedUser.GroupId = in_user.getGroupId();
+   out_resolvedUser.Values.clear();
+
    LevelType specificity = LevelType::NONE;
-   const std::string* value = nullptr;
 
    // Within the same category (e.g. if a user belongs to multiple groups) the last matching entry will be applied.
-   for (const LevelValue& levelValue : LevelValues)
+   for (const LevelValue& levelValue : *LevelValues)
    {
-      // If the level is less specific than the most recently found value, skip this entry.
+      // If the level is less specific than the most recently applied level, skip this entry.
       if (levelValue.first.Type < specificity)
          continue;
 
@@ -386,17 +594,10 @@ bool AbstractUserProfiles::Impl::getValueForUser(
 
       specificity = levelValue.first.Type;
 
-      // Otherwise this level applies to the user. Try to find the value
-      const auto itr = levelValue.second.find(in_valueName);
-      if (itr != levelValue.second.end())
-         value = &(itr->second);
+      // Otherwise this level applies to the user, so its values replace any less specific ones.
+      for (const auto& value: levelValue.second)
+         out_resolvedUser.Values[value.first] = value.second;
    }
-
-   if (value == nullptr)
-      return false;
-
-   out_value = *value;
-   return true;
 }
 
 bool AbstractUserProfiles::Impl::isInGroup(const system::User& in_user, const std::string& in_groupName) const
@@ -415,14 +616,21 @@ bool AbstractUserProfiles::Impl::isInGroup(const system::User& in_user, const st
 
 Error AbstractUserProfiles::Impl::iterateValues(
    const std::string& in_valueName,
-   const std::function<Error (const std::string&)>& in_onValueFound) const
+   const std::function<Error (ProfileValue&)>& in_onValueFound) const
 {
-   for (const LevelValue& levelValue: LevelValues)
+   LevelValueListPtr levelValues;
+   LOCK_MUTEX(Mutex)
+   {
+      levelValues = (PendingLevelValues != nullptr) ? PendingLevelValues : LevelValues;
+   }
+   END_LOCK_MUTEX
+
+   for (const LevelValue& levelValue: *levelValues)
    {
       const auto itr = levelValue.second.find(in_valueName);
       if (itr != levelValue.second.end())
       {
-         Error error = in_onValueFound(itr->second);
+         Error error = in_onValueFound(*itr->second);
          if (error)
          {
             error.addProperty("section-name", levelValue.first.Name);
@@ -459,6 +667,7 @@ Error AbstractUserProfiles::Impl::parseLevels(
    }
 
    std::set<std::string> groups;
+   std::vector<LevelValue> levelValues;
    for (const ptree::value_type& sectionNode: profileTree)
    {
       Level section;
@@ -501,16 +710,53 @@ Error AbstractUserProfiles::Impl::parseLevels(
                "Unknown value (" + sectionValue.first + ") in section [" + sectionNode.first + "]",
                ERROR_LOCATION);
 
-         values[sectionValue.first] = sectionValue.second.get_value<std::string>();
+         values[sectionValue.first].reset(new ProfileValue(sectionValue.second.get_value<std::string>()));
       }
 
-      LevelValues.emplace_back(section, values);
+      levelValues.emplace_back(section, values);
+   }
+
+   GroupLookupMap groupLookupMap;
+   Error error = populateGroups(groups, groupLookupMap);
+   if (error)
+      return error;
+
+   LOCK_MUTEX(Mutex)
+   {
+      PendingLevelValues = std::make_shared<const std::vector<LevelValue> >(std::move(levelValues));
+      PendingGroups.swap(groupLookupMap);
    }
+   END_LOCK_MUTEX
 
-   return populateGroups(groups);
+   return Success();
 }
 
-Error AbstractUserProfiles::Impl::populateGroups(const std::set<std::string>& in_groupNames)
+void AbstractUserProfiles::Impl::applyPendingLevels()
+{
+   LOCK_MUTEX(Mutex)
+   {
+      LevelValues = std::move(PendingLevelValues);
+      PendingLevelValues.reset();
+      Groups.swap(PendingGroups);
+      PendingGroups.clear();
+      ResolvedUsers.clear();
+   }
+   END_LOCK_MUTEX
+}
+
+void AbstractUserProfiles::Impl::discardPendingLevels()
+{
+   LOCK_MUTEX(Mutex)
+   {
+      PendingLevelValues.reset();
+      PendingGroups.clear();
+   }
+   END_LOCK_MUTEX
+}
+
+Error AbstractUserProfiles::Impl::populateGroups(
+   const std::set<std::string>& in_groupNames,
+   GroupLookupMap& out_groups)
 {
    // Get the buffer size - but set a conservative value if the system returns -1.
    long int bufferSize = ::sysconf(_SC_GETGR_R_SIZE_MAX);
@@ -550,11 +796,11 @@ Error AbstractUserProfiles::Impl::populateGroups(const std::set<std::string>& in
 
       // Success! Create an entry in the look-up map, and iterate through the members to add them to the set.
       Group grpStruct(grp.gr_gid, groupName);
-      Groups[grpStruct] = std::set<std::string>();
+      out_groups[grpStruct] = std::set<std::string>();
       char** usersItr = grp.gr_mem;
       while(*usersItr)
       {
-         Groups[grpStruct].insert(*(usersItr++));
+         out_groups[grpStruct].insert(*(usersItr++));
       }
    }
 
@@ -564,6 +810,9 @@ Error AbstractUserProfiles::Impl::populateGroups(const std::set<std::string>& in
 // AbstractUserProfiles ================================================================================================
 Error AbstractUserProfiles::initialize()
 {
+   // Lookups keep using the current values until the new ones have been parsed and validated.
+   std::lock_guard<std::mutex> lock(m_impl->ReloadMutex);
+
    std::string iniFileContents;
    Error error = utils::readFileIntoString(getConfigurationFile(), iniFileContents);
    if (error)
@@ -577,10 +826,17 @@ Error AbstractUserProfiles::initialize()
    }
 
    error = m_impl->parseLevels(iniFileContents, getValidFieldNames());
+   if (!error)
+      error = validateValues();
+
    if (error)
+   {
+      m_impl->discardPendingLevels();
       return error;
+   }
 
-   return validateValues();
+   m_impl->applyPendingLevels();
+   return Success();
 }
 
 AbstractUserProfiles::AbstractUserProfiles() :
@@ -608,14 +864,14 @@ Error AbstractUserProfiles::getValueForUser(
          "The requested value \"" + in_valueName + "\" is not supported.",
          ERROR_LOCATION);
 
-   std::string strValue;
-   if (!m_impl->getValueForUser(in_valueName, in_user, strValue))
+   ProfileValuePtr value = m_impl->getValueForUser(in_valueName, in_user);
+   if (value == nullptr)
       return userProfileError(
          UserProfileError::VALUE_NOT_FOUND_ERROR,
          "The value \"" + in_valueName + "\" could not be found for the user \"" + in_user.getUsername() + "\".",
          ERROR_LOCATION);
 
-   return parseValue(strValue, out_value);
+   return m_impl->getParsedValue(*value, out_value);
 }
 
 bool AbstractUserProfiles::isValueNotFoundError(const Error& in_error)
@@ -626,20 +882,35 @@ bool AbstractUserProfiles::isValueNotFoundError(const Error& in_error)
 template <typename T>
 Error AbstractUserProfiles::validateValue(const std::string& in_valueName) const
 {
-   return validateValue(
+   // Parsing through the implementation keeps the parsed values, so later lookups of this type don't parse again.
+   const Impl& impl = *m_impl;
+   Error error = impl.iterateValues(
       in_valueName,
-      [](const std::string& in_value)
+      [&impl](ProfileValue& in_value)
       {
          T parsedVal;
-         return parseValue(in_value, parsedVal);
+         return impl.getParsedValue(in_value, parsedVal);
       });
+   if (error)
+      return userProfileError(
+         UserProfileError::CONF_PARSE_ERROR,
+         "Invalid value(s) in " + getConfigurationFile().getAbsolutePath(),
+         error,
+         ERROR_LOCATION);
+
+   return Success();
 }
 
 Error AbstractUserProfiles::validateValue(
    const std::string& in_valueName,
    const CustomValueValidator& in_validator) const
 {
-   Error error = m_impl->iterateValues(in_valueName, in_validator);
+   Error error = m_impl->iterateValues(
+      in_valueName,
+      [&in_validator](ProfileValue& in_value)
+      {
+         return in_validator(in_value.Raw);
+      });
    if (error)
       return userProfileError(
          UserProfileError::CONF_PARSE_ERROR,
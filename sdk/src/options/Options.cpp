@@ -20,6 +20,7 @@
 
 #include <options/Options.hpp>
 
+#include <atomic>
 #include <mutex>
 #include <thread>
 
@@ -113,6 +114,53 @@ std::ostream& operator<<(std::ostream& in_stream, const LogLevel& in_logLevel)
    return in_stream;
 }
 
+// Overload operator>> and operator<< for AsyncLogOverflowPolicy for parsing the config file.
+std::istream& operator>>(std::istream& in_stream, AsyncLogOverflowPolicy& out_policy)
+{
+   std::string policyStr;
+   in_stream >> policyStr;
+   if (boost::iequals(policyStr, "block"))
+      out_policy = AsyncLogOverflowPolicy::BLOCK;
+   else if (boost::iequals(policyStr, "drop-debug"))
+      out_policy = AsyncLogOverflowPolicy::DROP_DEBUG;
+   else if (boost::iequals(policyStr, "drop"))
+      out_policy = AsyncLogOverflowPolicy::DROP;
+   else
+      in_stream.setstate(std::ios_base::failbit);
+
+   return in_stream;
+}
+
+std::ostream& operator<<(std::ostream& in_stream, const AsyncLogOverflowPolicy& in_policy)
+{
+   switch (in_policy)
+   {
+      case AsyncLogOverflowPolicy::BLOCK:
+      {
+         in_stream << "block";
+         break;
+      }
+      case AsyncLogOverflowPolicy::DROP_DEBUG:
+      {
+         in_stream << "drop-debug";
+         break;
+      }
+      case AsyncLogOverflowPolicy::DROP:
+      {
+         in_stream << "drop";
+         break;
+      }
+      default:
+      {
+         assert(false);
+         in_stream.setstate(std::ostream::failbit);
+         break;
+      }
+   }
+
+   return in_stream;
+}
+
 } // namespace logging
 
 namespace system {
@@ -225,6 +273,17 @@ Error validateOptions(
    return Success();
 }
 
+/**
+ * @brief The options which may be changed by reloading the configuration file. A published snapshot is never modified.
+ */
+struct ReloadableOptions
+{
+   bool EnableDebugLogging = false;
+   unsigned int JobExpiryHours = 0;
+   logging::LogLevel MaxLogLevel = logging::LogLevel::OFF;
+   unsigned int UserCacheTtlSeconds = 0;
+};
+
 } // anonymous namespace
 
 // Value ===============================================================================================================
@@ -270,6 +329,8 @@ struct Options::Impl
    Impl() :
       OptionsDescription("program"),
       IsInitialized(false),
+      AsyncLogOverflowPolicy(logging::AsyncLogOverflowPolicy::BLOCK),
+      AsyncLogQueueSize(0),
       EnableDebugLogging(false),
       JobExpiryHours(0),
       HeartbeatIntervalSeconds(0),
@@ -278,8 +339,50 @@ struct Options::Impl
       ScratchPath(""),
       ServerUser(),
       LoggingDir(""),
-      ThreadPoolSize(0)
-   { };
+      ThreadPoolSize(0),
+      TraceBufferSize(0),
+      TraceDumpIntervalSeconds(0),
+      UserCacheTtlSeconds(0),
+      UseIoContextPerThread(false),
+      Reloadable(nullptr)
+   {
+      publish(std::unique_ptr<const ReloadableOptions>(new ReloadableOptions()));
+   };
+
+   /**
+    * @brief Gets the current snapshot of the reloadable options without locking.
+    *
+    * @return The current snapshot of the reloadable options.
+    */
+   const ReloadableOptions& getReloadable() const
+   {
+      return *Reloadable.load(std::memory_order_acquire);
+   }
+
+   /**
+    * @brief Makes the specified snapshot of the reloadable options the current one.
+    *
+    * Snapshots are kept until the options are destroyed, so a reader never needs to protect the snapshot it is
+    * reading. Each is only a few bytes and the options are rarely reloaded.
+    *
+    * @param in_snapshot    The new snapshot of the reloadable options.
+    */
+   void publish(std::unique_ptr<const ReloadableOptions> in_snapshot)
+   {
+      Reloadable.store(in_snapshot.get(), std::memory_order_release);
+      Snapshots.push_back(std::move(in_snapshot));
+   }
+
+   /**
+    * @brief Parses the configuration file and then the command line arguments which were passed to readOptions.
+    *
+    * @param in_storeValues     Whether to store the parsed values to the option members and to the storage objects of
+    *                           the registered options.
+    * @param out_vm             The parsed option values.
+    *
+    * @return Success if all required options were read and no parsing errors occurred; Error otherwise.
+    */
+   Error parseOptions(bool in_storeValues, variables_map& out_vm) const;
 
    void initialize()
    {
@@ -288,9 +391,21 @@ struct Options::Impl
       if (!IsInitialized)
       {
          OptionsDescription.add_options()
+            ("async-log-overflow-policy",
+               value<logging::AsyncLogOverflowPolicy>(&AsyncLogOverflowPolicy)->default_value(
+                  logging::AsyncLogOverflowPolicy::BLOCK),
+               "what to do with a log message when the asynchronous log queue is full - block, drop-debug, or drop")
+            ("async-log-queue-size",
+               value<size_t>(&AsyncLogQueueSize)->default_value(0),
+               "the maximum number of log messages waiting to be written by the log writer thread - 0 to write log "
+               "messages synchronously")
             ("enable-debug-logging",
                value<bool>(&EnableDebugLogging)->default_value(false),
                "whether to enable debug logging or not - if true, enforces a log-level of at least DEBUG")
+            ("io-context-per-thread",
+               value<bool>(&UseIoContextPerThread)->default_value(false),
+               "whether each thread in the thread pool should run work from its own queue, rather than all threads "
+               "sharing a single queue")
             ("job-expiry-hours",
                value<unsigned int>(&JobExpiryHours)->default_value(24),
                "amount of hours before completed jobs are removed from the system")
@@ -321,9 +436,19 @@ struct Options::Impl
             ("thread-pool-size",
                value<size_t>(&ThreadPoolSize)->default_value(std::max<size_t>(4, std::thread::hardware_concurrency())),
                "the number of threads in the thread pool")
+            ("trace-buffer-size",
+               value<size_t>(&TraceBufferSize)->default_value(0),
+               "the number of completed trace spans to keep for each thread - 0 to disable tracing")
+            ("trace-dump-interval-seconds",
+               value<unsigned int>(&TraceDumpIntervalSeconds)->default_value(0),
+               "the amount of seconds between writes of the trace file, if tracing is enabled - 0 to only write the "
+               "trace file on SIGUSR1 and on exit")
             ("unprivileged",
                value<bool>(&UseUnprivilegedMode)->default_value(false),
                "special unprivileged mode - does not change user, runs without root, no impersonation, single user")
+            ("user-cache-ttl-seconds",
+               value<unsigned int>(&UserCacheTtlSeconds)->default_value(60),
+               "the amount of seconds to cache looked up system users - 0 to disable")
             ("logging-dir",
                value<system::FilePath>(&LoggingDir)->default_value(system::FilePath(s_defaultLoggingDir)),
                "specifies path where debug logs should be written");
@@ -338,10 +463,16 @@ struct Options::Impl
    // Boost program options.
    options_description OptionsDescription;
 
+   // The configuration file and command line arguments, without the program name, from which the options were read.
+   system::FilePath ConfigFile;
+   std::vector<std::string> CommandLineArgs;
+
    // Whether the initialize method has been called yet.
    bool IsInitialized;
 
    // Option Members.
+   logging::AsyncLogOverflowPolicy AsyncLogOverflowPolicy;
+   size_t AsyncLogQueueSize;
    bool EnableDebugLogging;
    unsigned int JobExpiryHours;
    unsigned int HeartbeatIntervalSeconds;
@@ -354,7 +485,15 @@ struct Options::Impl
    system::FilePath LoggingDir;
    std::string ServerUser;
    size_t ThreadPoolSize;
+   size_t TraceBufferSize;
+   unsigned int TraceDumpIntervalSeconds;
+   unsigned int UserCacheTtlSeconds;
+   bool UseIoContextPerThread;
    bool UseUnprivilegedMode;
+
+   // The current snapshot of the reloadable options, and every snapshot which has been published.
+   std::atomic<const ReloadableOptions*> Reloadable;
+   std::vector<std::unique_ptr<const ReloadableOptions> > Snapshots;
 };
 
 PRIVATE_IMPL_DELETER_IMPL(Options)
@@ -392,57 +531,54 @@ Options::Init Options::registerOptions()
    return Options::Init(*this);
 }
 
-Error Options::readOptions(int in_argc, const char* const in_argv[], const system::FilePath& in_location)
+Error Options::Impl::parseOptions(bool in_storeValues, variables_map& out_vm) const
 {
-   // This should be initialized in getInstance.
-   assert(m_impl->IsInitialized);
-
    try
    {
-      variables_map vm;
       std::vector<std::string> unrecognizedFileOpts;
 
       // The configuration file overrides command line options, so parse the config file first.
       try
       {
          std::shared_ptr<std::istream> inputStream;
-         if (!in_location.isEmpty() && in_location.exists())
+         if (!ConfigFile.isEmpty() && ConfigFile.exists())
          {
-            Error error = in_location.openForRead(inputStream);
+            Error error = ConfigFile.openForRead(inputStream);
             if (error)
                return error;
          }
          else
             inputStream.reset(new std::istringstream());
 
-         parsed_options parsed = parse_config_file(*inputStream, m_impl->OptionsDescription, true);
-         store(parsed, vm);
-         notify(vm);
+         parsed_options parsed = parse_config_file(*inputStream, OptionsDescription, true);
+         store(parsed, out_vm);
+         if (in_storeValues)
+            notify(out_vm);
 
-         collectUnrecognizedOptions(vm, parsed, unrecognizedFileOpts);
+         collectUnrecognizedOptions(out_vm, parsed, unrecognizedFileOpts);
       }
       catch (const std::exception& e)
       {
          return optionsError(
             OptionsError::READ_FAILURE,
-            "Error reading " + in_location.getAbsolutePath() + ": " + std::string(e.what()),
+            "Error reading " + ConfigFile.getAbsolutePath() + ": " + std::string(e.what()),
             ERROR_LOCATION);
       }
 
       // Now read the command line arguments.
       std::vector<std::string> unrecognizedCmdOpts;
-      if (in_argc > 0)
       {
          // Set up the parser so that command line options will override code-defaults.
-         command_line_parser parser = command_line_parser(in_argc, const_cast<char**>(in_argv));
-         parser.options(m_impl->OptionsDescription);
+         command_line_parser parser = command_line_parser(CommandLineArgs);
+         parser.options(OptionsDescription);
          parser.allow_unregistered();
 
          // Run the parser.
          parsed_options parsed = parser.run();
-         store(parsed, vm);
-         notify(vm);
-         collectUnrecognizedOptions(vm, parsed, unrecognizedCmdOpts);
+         store(parsed, out_vm);
+         if (in_storeValues)
+            notify(out_vm);
+         collectUnrecognizedOptions(out_vm, parsed, unrecognizedCmdOpts);
       }
 
       // Handle unrecognized options
@@ -450,7 +586,7 @@ Error Options::readOptions(int in_argc, const char* const in_argv[], const syste
       {
          std::string message = "The following options were unrecognized:";
          if (!unrecognizedFileOpts.empty())
-            message += "\n    in config file " + in_location.getAbsolutePath() + ":";
+            message += "\n    in config file " + ConfigFile.getAbsolutePath() + ":";
          for (const std::string& opt: unrecognizedFileOpts)
             message += "\n        " + opt;
 
@@ -463,13 +599,13 @@ Error Options::readOptions(int in_argc, const char* const in_argv[], const syste
       }
 
       // Now validate the provided options.
-      return validateOptions(vm, m_impl->OptionsDescription, in_location.getAbsolutePath());
+      return validateOptions(out_vm, OptionsDescription, ConfigFile.getAbsolutePath());
    }
    catch (boost::program_options::error& e)
    {
       return optionsError(
          OptionsError::PARSE_ERROR,
-         std::string(e.what()) + " in config file " + in_location.getAbsolutePath(),
+         std::string(e.what()) + " in config file " + ConfigFile.getAbsolutePath(),
          ERROR_LOCATION);
    }
    catch (const std::exception& e)
@@ -478,9 +614,71 @@ Error Options::readOptions(int in_argc, const char* const in_argv[], const syste
    }
 }
 
+Error Options::readOptions(int in_argc, const char* const in_argv[], const system::FilePath& in_location)
+{
+   // This should be initialized in getInstance.
+   assert(m_impl->IsInitialized);
+
+   std::lock_guard<std::mutex> lock(m_impl->Mutex);
+   m_impl->ConfigFile = in_location;
+   m_impl->CommandLineArgs.clear();
+   for (int i = 1; i < in_argc; ++i)
+      m_impl->CommandLineArgs.emplace_back(in_argv[i]);
+
+   variables_map vm;
+   Error error = m_impl->parseOptions(true, vm);
+
+   // Publish the values which were stored, even if a later part of the parsing failed.
+   std::unique_ptr<ReloadableOptions> snapshot(new ReloadableOptions());
+   snapshot->EnableDebugLogging = m_impl->EnableDebugLogging;
+   snapshot->JobExpiryHours = m_impl->JobExpiryHours;
+   snapshot->MaxLogLevel = m_impl->MaxLogLevel;
+   snapshot->UserCacheTtlSeconds = m_impl->UserCacheTtlSeconds;
+   m_impl->publish(std::move(snapshot));
+
+   return error;
+}
+
+Error Options::reloadOptions()
+{
+   std::lock_guard<std::mutex> lock(m_impl->Mutex);
+
+   // Parse and validate everything again, but only keep the values of the reloadable options.
+   variables_map vm;
+   Error error = m_impl->parseOptions(false, vm);
+   if (error)
+      return error;
+
+   try
+   {
+      std::unique_ptr<ReloadableOptions> snapshot(new ReloadableOptions());
+      snapshot->EnableDebugLogging = vm["enable-debug-logging"].as<bool>();
+      snapshot->JobExpiryHours = vm["job-expiry-hours"].as<unsigned int>();
+      snapshot->MaxLogLevel = vm["log-level"].as<logging::LogLevel>();
+      snapshot->UserCacheTtlSeconds = vm["user-cache-ttl-seconds"].as<unsigned int>();
+      m_impl->publish(std::move(snapshot));
+   }
+   catch (const std::exception& e)
+   {
+      return unknownError("Unexpected exception: " + std::string(e.what()), ERROR_LOCATION);
+   }
+
+   return Success();
+}
+
+logging::AsyncLogOverflowPolicy Options::getAsyncLogOverflowPolicy() const
+{
+   return m_impl->AsyncLogOverflowPolicy;
+}
+
+size_t Options::getAsyncLogQueueSize() const
+{
+   return m_impl->AsyncLogQueueSize;
+}
+
 system::TimeDuration Options::getJobExpiryHours() const
 {
-   return system::TimeDuration::Hours(m_impl->JobExpiryHours);
+   return system::TimeDuration::Hours(m_impl->getReloadable().JobExpiryHours);
 }
 
 system::TimeDuration Options::getHeartbeatIntervalSeconds() const
@@ -495,8 +693,9 @@ const system::FilePath& Options::getLauncherConfigFile() const
 
 logging::LogLevel Options::getLogLevel() const
 {
-   return (!m_impl->EnableDebugLogging || (m_impl->MaxLogLevel >= logging::LogLevel::DEBUG) ?
-      m_impl->MaxLogLevel :
+   const ReloadableOptions& reloadable = m_impl->getReloadable();
+   return (!reloadable.EnableDebugLogging || (reloadable.MaxLogLevel >= logging::LogLevel::DEBUG) ?
+      reloadable.MaxLogLevel :
       logging::LogLevel::DEBUG);
 }
 
@@ -528,6 +727,26 @@ size_t Options::getThreadPoolSize() const
    return m_impl->ThreadPoolSize;
 }
 
+size_t Options::getTraceBufferSize() const
+{
+   return m_impl->TraceBufferSize;
+}
+
+system::TimeDuration Options::getTraceDumpIntervalSeconds() const
+{
+   return system::TimeDuration::Seconds(m_impl->TraceDumpIntervalSeconds);
+}
+
+system::TimeDuration Options::getUserCacheTtlSeconds() const
+{
+   return system::TimeDuration::Seconds(m_impl->getReloadable().UserCacheTtlSeconds);
+}
+
+bool Options::useIoContextPerThread() const
+{
+   return m_impl->UseIoContextPerThread;
+}
+
 bool Options::useUnprivilegedMode() const
 {
    return m_impl->UseUnprivilegedMode;
@@ -60,6 +60,16 @@ TEST_CASE("basic options")
       REQUIRE_FALSE(error);
       CHECK(serverUser == user3);
    }
+
+   SECTION("reload options")
+   {
+      Options& opts = Options::getInstance();
+      REQUIRE_FALSE(opts.reloadOptions());
+
+      CHECK(opts.getJobExpiryHours() == system::TimeDuration::Hours(11));
+      CHECK(opts.getLogLevel() == logging::LogLevel::ERR);
+      CHECK(opts.getThreadPoolSize() == 6);
+   }
 }
 
 } // namespace options
@@ -23,6 +23,9 @@
 
 #include <TestMain.hpp>
 
+#include <chrono>
+#include <fstream>
+
 #include <boost/algorithm/string.hpp>
 
 #include <Error.hpp>
@@ -50,8 +53,7 @@ class TestUserProfiles: public AbstractUserProfiles
 public:
    explicit TestUserProfiles(const std::string& in_fileName)
    {
-      m_confFile = system::FilePath::safeCurrentPath(
-         system::FilePath()).completeChildPath("profile-files").completeChildPath(in_fileName);
+      setConfigurationFile(in_fileName);
 
       m_validFieldNames.insert("int-field");
       m_validFieldNames.insert("uint-field");
@@ -64,6 +66,12 @@ public:
       m_validFieldNames.insert("custom-type-field");
    }
 
+   void setConfigurationFile(const std::string& in_fileName)
+   {
+      m_confFile = system::FilePath::safeCurrentPath(
+         system::FilePath()).completeChildPath("profile-files").completeChildPath(in_fileName);
+   }
+
    int64_t getIntField(const system::User& in_user) const
    {
       // Default value
@@ -338,6 +346,87 @@ TEST_CASE("Parsing errors")
    CHECK(badGroup.initialize());
 }
 
+TEST_CASE("Reinitializing discards cached values")
+{
+   system::User userOne;
+   REQUIRE_FALSE(system::User::getUserFromIdentifier(USER_ONE, userOne));
+
+   TestUserProfiles userProfiles("simple.profiles.conf");
+   REQUIRE_FALSE(userProfiles.initialize());
+
+   // Repeated lookups are served from the cached values.
+   CHECK(userProfiles.getUIntField(userOne) == 3028);
+   CHECK(userProfiles.getUIntField(userOne) == 3028);
+   CHECK(userProfiles.getStrField(userOne) == "some string value");
+
+   userProfiles.setConfigurationFile("complex.profiles.conf");
+   REQUIRE_FALSE(userProfiles.initialize());
+
+   CHECK(userProfiles.getUIntField(userOne) == 10);
+   CHECK(userProfiles.getStrField(userOne) == "Group One Users");
+}
+
+TEST_CASE("Reinitializing with an invalid file keeps the previous values")
+{
+   system::User userOne;
+   REQUIRE_FALSE(system::User::getUserFromIdentifier(USER_ONE, userOne));
+
+   TestUserProfiles userProfiles("simple.profiles.conf");
+   REQUIRE_FALSE(userProfiles.initialize());
+   CHECK(userProfiles.getUIntField(userOne) == 3028);
+
+   userProfiles.setConfigurationFile("badInt.profiles.conf");
+   CHECK(userProfiles.initialize());
+
+   CHECK(userProfiles.getUIntField(userOne) == 3028);
+   CHECK(userProfiles.getStrField(userOne) == "some string value");
+}
+
+// Run with: rlps-user-profile-tests "[benchmark]"
+TEST_CASE("Parsing a large profiles file", "[.benchmark]")
+{
+   constexpr int USER_COUNT = 5000;
+
+   system::User userOne;
+   REQUIRE_FALSE(system::User::getUserFromIdentifier(USER_ONE, userOne));
+
+   // Generate a profiles file with the sections of complex.profiles.conf and thousands of user sections.
+   const system::FilePath confFile = system::FilePath::safeCurrentPath(
+      system::FilePath()).completeChildPath("profile-files").completeChildPath("benchmark.profiles.conf");
+   {
+      std::ofstream out(confFile.getAbsolutePath());
+      out << "[*]\n"
+          << "str-set-field=value1, value2, value3,   value2   , value with spaces\n"
+          << "float-list-field=25.5, 38.4, 607.25\n"
+          << "str-int-list-map-field=key1\\=1,2,3,4  \\;  key2 \\= 5,4,3\\;key3\\=  10 , 35, 15\n";
+      out << "[@" << GROUP_TWO << "]\nstr-field=Group Two Users\n";
+      out << "[@" << GROUP_ONE << "]\nuint-field=10\nstr-int-list-map-field=key1\\=60,897, 33\n";
+      out << "[@" << GROUP_THREE << "]\nstr-field=Group Three Users\n";
+      for (int i = 0; i < USER_COUNT; ++i)
+      {
+         out << "[benchmarkuser" << i << "]\n"
+             << "uint-field=" << i << "\n"
+             << "str-set-field=value" << i << ", value2 , value" << (i + 1) << ", another value\n"
+             << "float-list-field=" << i << ".5, 38.4,607.25 , 1\n"
+             << "str-int-list-map-field=key1\\=" << i << ",2,3 \\; key2\\=4, 5\\;key" << i << " \\= 6\n";
+      }
+   }
+
+   TestUserProfiles userProfiles("benchmark.profiles.conf");
+
+   const auto start = std::chrono::steady_clock::now();
+   Error error = userProfiles.initialize();
+   const auto elapsed = std::chrono::steady_clock::now() - start;
+
+   REQUIRE_FALSE(confFile.remove());
+   REQUIRE_FALSE(error);
+   CHECK(userProfiles.getUIntField(userOne) == 10);
+   CHECK(userProfiles.getMapField(userOne)["key1"].size() == 3);
+
+   WARN("Parsed and validated " << USER_COUNT << " user sections in " <<
+      std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() << "ms");
+}
+
 TEST_CASE("Complex case")
 {
    system::User userOne;
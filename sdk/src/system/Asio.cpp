@@ -23,9 +23,14 @@
 
 #include <system/Asio.hpp>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <vector>
 
 #include <boost/asio.hpp>
 
@@ -40,10 +45,340 @@ namespace system {
 
 namespace {
 
+// The maximum number of io contexts. Worker threads beyond this many share the primary io context.
+constexpr size_t MAX_IO_CONTEXTS = 256;
+
+/**
+ * @brief The io contexts which run async work.
+ *
+ * The primary io context always exists, and is the only one unless worker threads were started with
+ * AsioThreadModel::CONTEXT_PER_THREAD. Each additional io context is run by exactly one thread. Io contexts are only
+ * ever added, so a reference to one remains valid for the life of the process.
+ */
+struct IoContexts
+{
+   /**
+    * @brief Constructor.
+    */
+   IoContexts() :
+      Count(1)
+   {
+      Contexts[0] = &Primary;
+   }
+
+   /**
+    * @brief Adds an io context which will be run by a single thread. Calls to this method must be serialized.
+    *
+    * @return The new io context, or nullptr if the maximum number of io contexts already exist.
+    */
+   boost::asio::io_service* add()
+   {
+      size_t count = Count.load(std::memory_order_relaxed);
+      if (count == MAX_IO_CONTEXTS)
+         return nullptr;
+
+      // The io context will only be run by one thread, which allows ASIO to skip waking other threads.
+      Owned.emplace_back(new boost::asio::io_service(1));
+      Contexts[count] = Owned.back().get();
+      Count.store(count + 1, std::memory_order_release);
+      return Contexts[count];
+   }
+
+   /**
+    * @brief Gets the io context for the specified key. The same key always maps to the same io context, until more io
+    *        contexts are added.
+    *
+    * @param in_key     The key for which to get the io context.
+    *
+    * @return The io context for the specified key.
+    */
+   boost::asio::io_service& get(size_t in_key)
+   {
+      size_t count = Count.load(std::memory_order_acquire);
+      return (count == 1) ? Primary : *Contexts[in_key % count];
+   }
+
+   /**
+    * @brief Gets the next io context, distributing work between io contexts round-robin.
+    *
+    * Each thread cycles through the io contexts separately, starting at a different io context, so threads never
+    * contend on a shared counter.
+    *
+    * @return The next io context.
+    */
+   boost::asio::io_service& getNext()
+   {
+      if (Count.load(std::memory_order_acquire) == 1)
+         return Primary;
+
+      thread_local size_t next = std::hash<std::thread::id>()(std::this_thread::get_id());
+      return get(next++);
+   }
+
+   /** The io contexts. Only the first Count are valid. */
+   std::array<boost::asio::io_service*, MAX_IO_CONTEXTS> Contexts;
+
+   /** The number of io contexts. */
+   std::atomic<size_t> Count;
+
+   /** The additional io contexts. */
+   std::vector<std::unique_ptr<boost::asio::io_service> > Owned;
+
+   /** The primary io context, which runs signal handling and anything created before the worker threads started. */
+   boost::asio::io_service Primary;
+};
+
+IoContexts& getIoContexts()
+{
+   static IoContexts ioContexts;
+   return ioContexts;
+}
+
 boost::asio::io_service& getIoService()
 {
-   static boost::asio::io_service ioService;
-   return ioService;
+   return getIoContexts().Primary;
+}
+
+typedef std::chrono::steady_clock SteadyClock;
+
+/**
+ * @brief Work which has been scheduled on the timer queue.
+ */
+struct TimerEntry
+{
+   /**
+    * @brief Constructor.
+    *
+    * @param in_work        The work to perform when the timer expires.
+    * @param in_interval    The interval at which to repeat the work, or zero if the work should only be performed once.
+    */
+   TimerEntry(AsioFunction in_work, SteadyClock::duration in_interval) :
+      Canceled(false),
+      Interval(in_interval),
+      Work(std::move(in_work))
+   {
+   }
+
+   /**
+    * @brief Cancels the timer. The work will not be started after this returns, though it may already be running.
+    */
+   void cancel();
+
+   /** Whether the timer has been canceled. */
+   std::atomic<bool> Canceled;
+
+   /** The interval at which to repeat the work, or zero if the work should only be performed once. */
+   const SteadyClock::duration Interval;
+
+   /** The work to perform when the timer expires. */
+   const AsioFunction Work;
+};
+
+typedef std::shared_ptr<TimerEntry> TimerEntryPtr;
+
+/**
+ * @brief Runs every timed event in the process from a single ASIO timer.
+ *
+ * Scheduled timers are kept in a heap ordered by expiry, and the ASIO timer always waits for the earliest one. When
+ * timers expire, their work is posted to the ASIO service, so it runs without any timer lock held. Canceling a timer
+ * only marks it as canceled; canceled timers are dropped when they expire, or when they make up most of the heap.
+ */
+class TimerQueue
+{
+public:
+   /**
+    * @brief Gets the single timer queue for this process.
+    *
+    * @return The single timer queue for this process.
+    */
+   static TimerQueue& getInstance()
+   {
+      static TimerQueue timerQueue;
+      return timerQueue;
+   }
+
+   /**
+    * @brief Schedules a timer.
+    *
+    * @param in_entry     The timer to schedule.
+    * @param in_expiry    The time at which the timer should expire.
+    */
+   void schedule(const TimerEntryPtr& in_entry, SteadyClock::time_point in_expiry)
+   {
+      LOCK_MUTEX(m_mutex)
+      {
+         if ((m_heap.size() >= MIN_COMPACTION_SIZE) && (m_canceledCount.load() > (m_heap.size() / 2)))
+            compact();
+
+         m_heap.push_back(ScheduledTimer{ in_expiry, m_nextSequence++, in_entry });
+         std::push_heap(m_heap.begin(), m_heap.end(), ExpiresLater());
+
+         if (in_expiry < m_armedExpiry)
+            arm(in_expiry);
+      }
+      END_LOCK_MUTEX
+   }
+
+   /**
+    * @brief Records that a timer was canceled.
+    */
+   void onCanceled()
+   {
+      ++m_canceledCount;
+   }
+
+private:
+   /** The minimum number of scheduled timers before canceled timers are compacted out of the heap. */
+   static constexpr size_t MIN_COMPACTION_SIZE = 64;
+
+   /**
+    * @brief A timer in the heap.
+    */
+   struct ScheduledTimer
+   {
+      /** The time at which the timer expires. */
+      SteadyClock::time_point Expiry;
+
+      /** The order in which the timer was scheduled, so timers with the same expiry run in order. */
+      uint64_t Sequence;
+
+      /** The timer. */
+      TimerEntryPtr Entry;
+   };
+
+   /**
+    * @brief Orders the heap so the earliest timer is at the front.
+    */
+   struct ExpiresLater
+   {
+      bool operator()(const ScheduledTimer& in_lhs, const ScheduledTimer& in_rhs) const
+      {
+         return (in_lhs.Expiry > in_rhs.Expiry) ||
+            ((in_lhs.Expiry == in_rhs.Expiry) && (in_lhs.Sequence > in_rhs.Sequence));
+      }
+   };
+
+   /**
+    * @brief Constructor.
+    */
+   TimerQueue() :
+      m_armedExpiry(SteadyClock::time_point::max()),
+      m_canceledCount(0),
+      m_nextSequence(0),
+      m_timer(getIoService())
+   {
+   }
+
+   /**
+    * @brief Makes the ASIO timer wait for the specified time. This cancels any previous wait. The mutex must be held.
+    *
+    * @param in_expiry    The time to wait for.
+    */
+   void arm(SteadyClock::time_point in_expiry)
+   {
+      m_armedExpiry = in_expiry;
+      m_timer.expires_at(in_expiry);
+      m_timer.async_wait(
+         [this](const boost::system::error_code& in_ec)
+         {
+            onTimer(in_ec);
+         });
+   }
+
+   /**
+    * @brief Removes canceled timers from the heap. The mutex must be held.
+    */
+   void compact()
+   {
+      m_heap.erase(
+         std::remove_if(
+            m_heap.begin(),
+            m_heap.end(),
+            [](const ScheduledTimer& in_timer) { return in_timer.Entry->Canceled.load(); }),
+         m_heap.end());
+      std::make_heap(m_heap.begin(), m_heap.end(), ExpiresLater());
+      m_canceledCount = 0;
+   }
+
+   /**
+    * @brief Handles the ASIO timer expiring, by posting the work of each expired timer.
+    *
+    * @param in_ec    The result of the wait.
+    */
+   void onTimer(const boost::system::error_code& in_ec)
+   {
+      // The wait was replaced by a wait for an earlier timer.
+      if (in_ec == boost::asio::error::operation_aborted)
+         return;
+      else if (in_ec)
+         logging::logError(utils::createErrorFromBoostError(in_ec, ERROR_LOCATION));
+
+      std::vector<TimerEntryPtr> expired;
+      LOCK_MUTEX(m_mutex)
+      {
+         SteadyClock::time_point now = SteadyClock::now();
+         while (!m_heap.empty() && (m_heap.front().Expiry <= now))
+         {
+            std::pop_heap(m_heap.begin(), m_heap.end(), ExpiresLater());
+            TimerEntryPtr entry = std::move(m_heap.back().Entry);
+            m_heap.pop_back();
+
+            if (!entry->Canceled.load())
+               expired.push_back(std::move(entry));
+            else if (m_canceledCount.load() > 0)
+               --m_canceledCount;
+         }
+
+         m_armedExpiry = SteadyClock::time_point::max();
+         if (!m_heap.empty())
+            arm(m_heap.front().Expiry);
+      }
+      END_LOCK_MUTEX
+
+      for (TimerEntryPtr& entry: expired)
+         AsioService::post(std::bind(runTimer, std::move(entry)));
+   }
+
+   /**
+    * @brief Performs the work of an expired timer, and schedules it again if it repeats.
+    *
+    * @param in_entry    The expired timer.
+    */
+   static void runTimer(const TimerEntryPtr& in_entry)
+   {
+      if (in_entry->Canceled.load())
+         return;
+
+      in_entry->Work();
+
+      // Repeating work is scheduled again only after it finishes, so it never overlaps with itself.
+      if ((in_entry->Interval != SteadyClock::duration::zero()) && !in_entry->Canceled.load())
+         getInstance().schedule(in_entry, SteadyClock::now() + in_entry->Interval);
+   }
+
+   /** The time the ASIO timer is waiting for, or the maximum time point if it is not waiting. */
+   SteadyClock::time_point m_armedExpiry;
+
+   /** The approximate number of canceled timers in the heap. */
+   std::atomic<size_t> m_canceledCount;
+
+   /** The scheduled timers, ordered by ExpiresLater. */
+   std::vector<ScheduledTimer> m_heap;
+
+   /** The mutex which protects the heap and the ASIO timer. */
+   std::mutex m_mutex;
+
+   /** The sequence number of the next scheduled timer. */
+   uint64_t m_nextSequence;
+
+   /** The ASIO timer which waits for the earliest scheduled timer. */
+   boost::asio::steady_timer m_timer;
+};
+
+void TimerEntry::cancel()
+{
+   if (!Canceled.exchange(true))
+      TimerQueue::getInstance().onCanceled();
 }
 
 }
@@ -58,21 +393,43 @@ struct AsioService::Impl
       IoService(getIoService()),
       IsRunning(true),
       IsSignalSetInit(false),
-      SignalSet(IoService, SIGTERM, SIGINT) // These signals need to be passed in this order or it won't pick up SIGINTs
+      // These signals need to be passed in this order or it won't pick up SIGINTs
+      SignalSet(IoService, SIGTERM, SIGINT, SIGUSR1)
    {
+      // The signal set constructor only accepts three signals.
+      SignalSet.add(SIGHUP);
    }
 
    /**
-    * @brief Callback function which may be used to register a thread with the ASIO service and ensure it is available
+    * @brief Waits for the next signal and invokes the signal handler when it is received.
+    */
+   void waitForSignal()
+   {
+      SignalSet.async_wait(
+         [this](const boost::system::error_code& in_ec, int in_signal)
+         {
+            // The wait is only aborted when the ASIO service is stopped.
+            if (in_ec)
+               return;
+
+            OnSignalFunc(in_signal);
+            waitForSignal();
+         });
+   }
+
+   /**
+    * @brief Callback function which may be used to register a thread with an io context and ensure it is available
     *        for ASIO work.
+    *
+    * @param io_ioContext   The io context to run.
     */
-   void startWorkerThread()
+   static void startWorkerThread(boost::asio::io_service& io_ioContext)
    {
-      boost::asio::io_service::work work(IoService);
-      IoService.run();
+      boost::asio::io_service::work work(io_ioContext);
+      io_ioContext.run();
    }
 
-   /** The underlying async IO service. */
+   /** The primary async IO service. */
    boost::asio::io_service& IoService;
 
    /** Whether the ASIO service is running */
@@ -81,6 +438,9 @@ struct AsioService::Impl
    /** Whether the signal set is initialized or not. */
    bool IsSignalSetInit;
 
+   /** The function to invoke when a signal is received. */
+   OnSignal OnSignalFunc;
+
    /** The worker threads of the ASIO service. */
    std::vector<std::shared_ptr<std::thread> > Threads;
 
@@ -91,9 +451,15 @@ struct AsioService::Impl
    std::mutex Mutex;
 };
 
-void AsioService::post(const AsioFunction& in_work)
+void AsioService::postTask(AsioTask&& in_task)
+{
+   // ASIO recycles the memory for the posted operation on each thread, so this does not allocate in steady state.
+   boost::asio::post(getIoContexts().getNext(), std::move(in_task));
+}
+
+void AsioService::postTask(size_t in_key, AsioTask&& in_task)
 {
-   boost::asio::post(getAsioService().m_impl->IoService, in_work);
+   boost::asio::post(getIoContexts().get(in_key), std::move(in_task));
 }
 
 void AsioService::setSignalHandler(const OnSignal& in_onSignal)
@@ -104,13 +470,14 @@ void AsioService::setSignalHandler(const OnSignal& in_onSignal)
       if (!sharedThis->IsSignalSetInit)
       {
          sharedThis->IsSignalSetInit = true;
-         sharedThis->SignalSet.async_wait(std::bind(in_onSignal, std::placeholders::_2));
+         sharedThis->OnSignalFunc = in_onSignal;
+         sharedThis->waitForSignal();
       }
    }
    END_LOCK_MUTEX
 }
 
-void AsioService::startThreads(size_t in_numThreads)
+void AsioService::startThreads(size_t in_numThreads, AsioThreadModel in_threadModel)
 {
    std::shared_ptr<Impl> sharedThis = getAsioService().m_impl;
 
@@ -118,12 +485,21 @@ void AsioService::startThreads(size_t in_numThreads)
    {
       if (sharedThis->IsRunning)
       {
+         IoContexts& ioContexts = getIoContexts();
          for (size_t i = 0; i < in_numThreads; ++i)
          {
+            // The first thread always runs the primary io context, so signals and anything created before now are
+            // handled.
+            boost::asio::io_service* ioContext = nullptr;
+            if ((in_threadModel == AsioThreadModel::CONTEXT_PER_THREAD) && !sharedThis->Threads.empty())
+               ioContext = ioContexts.add();
+            if (ioContext == nullptr)
+               ioContext = &ioContexts.Primary;
+
             sharedThis->Threads.emplace_back(new std::thread(
-               [sharedThis]()
+               [ioContext]()
                {
-                  sharedThis->startWorkerThread();
+                  Impl::startWorkerThread(*ioContext);
                }));
          }
       }
@@ -139,7 +515,9 @@ void AsioService::stop()
    {
       if (sharedThis->IsRunning)
       {
-         sharedThis->IoService.stop();
+         IoContexts& ioContexts = getIoContexts();
+         for (size_t i = 0, n = ioContexts.Count.load(std::memory_order_acquire); i < n; ++i)
+            ioContexts.Contexts[i]->stop();
          sharedThis->IsRunning = false;
       }
    }
@@ -177,7 +555,7 @@ struct AsioStream::Impl : public std::enable_shared_from_this<AsioStream::Impl>
     * @param in_streamHandle    The handle of the stream to open.
     */
    explicit Impl(boost::asio::posix::stream_descriptor::native_handle_type in_streamHandle) :
-      StreamDescriptor(getIoService())
+      StreamDescriptor(getIoContexts().getNext())
    {
       try
       {
@@ -386,55 +764,28 @@ void AsioStream::writeBytes(
 // AsyncTimedEvent =====================================================================================================
 struct AsyncTimedEvent::Impl
 {
-   typedef std::shared_ptr<AsyncTimedEvent::Impl> SharedImpl;
-   typedef std::weak_ptr<AsyncTimedEvent::Impl> WeakImpl;
-
    Impl() :
-      Running(true)
+      Canceled(false)
    {
    }
 
-   static void runEvent(
-      const WeakImpl& in_weakThis,
-      const boost::posix_time::time_duration& in_intervalSeconds,
-      const AsioFunction& in_event,
-      const boost::system::error_code& in_ec)
+   /**
+    * @brief Destructor. Stops the timed event.
+    */
+   ~Impl()
    {
-      // If the operation was canceled, there's nothing to do.
-      if (in_ec == boost::asio::error::operation_aborted)
-         return;
-      // If another error occurred, log it and exit.
-      else if (in_ec.value() != 0)
-         return logging::logError(utils::createErrorFromBoostError(in_ec, ERROR_LOCATION));
-
-      // If this has been deleted, there's nothing to do.
-      SharedImpl sharedThis = in_weakThis.lock();
-      if (!sharedThis)
-         return;
-
-      UNIQUE_LOCK_MUTEX(sharedThis->Mutex)
-      {
-         // If this is no longer running, there's nothing to do.
-         if (!sharedThis->Running)
-            return;
-
-         // Otherwise, perform the action and restart the timer.
-         in_event();
-         sharedThis->Timer->expires_from_now(in_intervalSeconds);
-         sharedThis->Timer->async_wait(
-            std::bind(runEvent, in_weakThis, in_intervalSeconds, in_event, std::placeholders::_1));
-      }
-      END_LOCK_MUTEX
+      if (Entry)
+         Entry->cancel();
    }
 
-   /** Mutex to protect the running status. */
+   /** Mutex to protect the timer. */
    std::mutex Mutex;
 
-   /** Whether the timed event is currently running. */
-   bool Running;
+   /** Whether the timed event has been canceled. */
+   bool Canceled;
 
    /** The timer that will invoke the callback function. */
-   std::shared_ptr<boost::asio::deadline_timer> Timer;
+   TimerEntryPtr Entry;
 };
 
 AsyncTimedEvent::AsyncTimedEvent() :
@@ -448,26 +799,27 @@ void AsyncTimedEvent::start(const TimeDuration& in_timeDuration, const AsioFunct
    if (in_timeDuration == TimeDuration())
       return;
 
-   boost::posix_time::time_duration timeDuration(
-      in_timeDuration.getHours(),
-      in_timeDuration.getMinutes(),
-      in_timeDuration.getSeconds(),
-      in_timeDuration.getMicroseconds());
+   SteadyClock::duration interval = in_timeDuration.toSteadyDuration();
+   TimerEntryPtr entry = std::make_shared<TimerEntry>(in_event, interval);
+   LOCK_MUTEX(m_impl->Mutex)
+   {
+      if (m_impl->Canceled)
+         return;
 
-   m_impl->Timer.reset(
-      new boost::asio::deadline_timer(getIoService(), timeDuration));
+      m_impl->Entry = entry;
+   }
+   END_LOCK_MUTEX
 
-   Impl::WeakImpl weakImpl = m_impl;
-   m_impl->Timer->async_wait(std::bind(&Impl::runEvent, m_impl, timeDuration, in_event, std::placeholders::_1));
+   TimerQueue::getInstance().schedule(entry, SteadyClock::now() + interval);
 }
 
 void AsyncTimedEvent::cancel()
 {
-   UNIQUE_LOCK_MUTEX(m_impl->Mutex)
+   LOCK_MUTEX(m_impl->Mutex)
    {
-      m_impl->Running = false;
-      if (m_impl->Timer)
-         m_impl->Timer->cancel();
+      m_impl->Canceled = true;
+      if (m_impl->Entry)
+         m_impl->Entry->cancel();
    }
    END_LOCK_MUTEX
 }
@@ -488,8 +840,17 @@ struct AsyncDeadlineEvent::Impl
 
    }
 
+   /**
+    * @brief Destructor. Cancels the event.
+    */
+   ~Impl()
+   {
+      if (Entry)
+         Entry->cancel();
+   }
+
    DateTime Deadline;
-   std::shared_ptr<boost::asio::deadline_timer> Timer;
+   TimerEntryPtr Entry;
    AsioFunction Work;
 };
 
@@ -517,8 +878,8 @@ AsyncDeadlineEvent::~AsyncDeadlineEvent()
 
 void AsyncDeadlineEvent::cancel()
 {
-   if (m_impl->Timer != nullptr)
-      m_impl->Timer->cancel();
+   if (m_impl->Entry != nullptr)
+      m_impl->Entry->cancel();
 }
 
 void AsyncDeadlineEvent::start()
@@ -528,25 +889,10 @@ void AsyncDeadlineEvent::start()
       AsioService::post(m_impl->Work);
    else
    {
-      TimeDuration diff = m_impl->Deadline - now;
-      m_impl->Timer.reset(
-         new boost::asio::deadline_timer(
-            getIoService(),
-            boost::posix_time::time_duration(
-               diff.getHours(),
-               diff.getMinutes(),
-               diff.getSeconds(),
-               diff.getMicroseconds())));
-
-      std::weak_ptr<Impl> weakThis = m_impl;
-      m_impl->Timer->async_wait(
-         [weakThis](boost::system::error_code in_ec)
-         {
-            // Don't do any work if this was canceled or m_impl has been destroyed.
-            std::shared_ptr<Impl> sharedThis = weakThis.lock();
-            if ((in_ec != boost::asio::error::operation_aborted) && sharedThis)
-               sharedThis->Work();
-         });
+      m_impl->Entry = std::make_shared<TimerEntry>(m_impl->Work, SteadyClock::duration::zero());
+      TimerQueue::getInstance().schedule(
+         m_impl->Entry,
+         SteadyClock::now() + (m_impl->Deadline - now).toSteadyDuration());
    }
 }
 
@@ -29,10 +29,9 @@
 
 #include <system/Crypto.hpp>
 
-#include <Noncopyable.hpp>
+#include <array>
+#include <memory>
 
-#include <openssl/bio.h>
-#include <openssl/buffer.h>
 #include <openssl/err.h>
 #include <openssl/evp.h>
 #include <openssl/rand.h>
@@ -51,28 +50,71 @@ namespace {
 constexpr int s_encrypt = 1;
 constexpr int s_decrypt = 0;
 
-class BIOFreeAllScope : Noncopyable
+// The base-64 alphabet.
+constexpr const char* s_base64Alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Marks bytes which are not part of the base-64 alphabet in the decoding table.
+constexpr unsigned char s_invalidBase64 = 0xFF;
+
+/**
+ * @brief Builds the table which maps each byte to its base-64 value.
+ *
+ * @return The base-64 decoding table.
+ */
+std::array<unsigned char, 256> makeBase64DecodeTable()
 {
-public:
-   explicit BIOFreeAllScope(BIO* pMem)
-      : pMem_(pMem)
-   {
-   }
+   std::array<unsigned char, 256> table;
+   table.fill(s_invalidBase64);
+   for (unsigned char i = 0; i < 64; ++i)
+      table[static_cast<unsigned char>(s_base64Alphabet[i])] = i;
+
+   return table;
+}
+
+// The base-64 decoding table.
+const std::array<unsigned char, 256> s_base64DecodeTable = makeBase64DecodeTable();
 
-   ~BIOFreeAllScope()
+/**
+ * @brief Frees an OpenSSL cipher context.
+ */
+struct CipherContextDeleter
+{
+   void operator()(EVP_CIPHER_CTX* in_context) const
    {
-      try
-      {
-         ::BIO_free_all(pMem_);
-      }
-      catch(...)
-      {
-      }
+      ::EVP_CIPHER_CTX_free(in_context);
    }
-private:
-   BIO* pMem_;
 };
 
+/**
+ * @brief Gets the cipher context of the current thread, ready to be initialized for a new operation.
+ *
+ * Each thread allocates its cipher context once and then reuses it for every encryption or decryption it performs.
+ *
+ * @return The cipher context of the current thread, or nullptr if it could not be allocated.
+ */
+EVP_CIPHER_CTX* getThreadCipherContext()
+{
+   static thread_local std::unique_ptr<EVP_CIPHER_CTX, CipherContextDeleter> context;
+   if (context == nullptr)
+      context.reset(::EVP_CIPHER_CTX_new());
+   else
+      ::EVP_CIPHER_CTX_reset(context.get());
+
+   return context.get();
+}
+
+/**
+ * @brief Builds the error for invalid base-64 input.
+ *
+ * @param in_location   The location at which the error occurred.
+ *
+ * @return The invalid base-64 input error.
+ */
+Error invalidBase64Error(const ErrorLocation& in_location)
+{
+   return systemError(EINVAL, "Invalid base-64 encoded data.", in_location);
+}
+
 Error getLastCryptoError(const ErrorLocation& in_location)
 {
    // get the error code
@@ -112,28 +154,20 @@ Error aesDecrypt(
    int outLen = 0;
    int bytesDecrypted = 0;
 
-   EVP_CIPHER_CTX *ctx;
-   ctx = EVP_CIPHER_CTX_new();
-   EVP_CipherInit_ex(ctx, EVP_aes_128_cbc(), nullptr, &in_key[0], &in_iv[0], s_decrypt);
+   EVP_CIPHER_CTX* ctx = getThreadCipherContext();
+   if ((ctx == nullptr) || !EVP_CipherInit_ex(ctx, EVP_aes_128_cbc(), nullptr, &in_key[0], &in_iv[0], s_decrypt))
+      return getLastCryptoError(ERROR_LOCATION);
 
    // perform the decryption
    if(!EVP_CipherUpdate(ctx, &out_decrypted[0], &outLen, &in_data[0], static_cast<int>(in_data.size())))
-   {
-      EVP_CIPHER_CTX_free(ctx);
       return getLastCryptoError(ERROR_LOCATION);
-   }
    bytesDecrypted += outLen;
 
    // perform final flush
    if(!EVP_CipherFinal_ex(ctx, &out_decrypted[outLen], &outLen))
-   {
-      EVP_CIPHER_CTX_free(ctx);
       return getLastCryptoError(ERROR_LOCATION);
-   }
    bytesDecrypted += outLen;
 
-   EVP_CIPHER_CTX_free(ctx);
-
    // resize the container to the amount of actual bytes decrypted (padding is removed)
    out_decrypted.resize(bytesDecrypted);
 
@@ -159,28 +193,21 @@ Error aesEncrypt(
    int outlen = 0;
    int bytesEncrypted = 0;
 
-   EVP_CIPHER_CTX *ctx;
-   ctx = EVP_CIPHER_CTX_new();
-   EVP_CipherInit_ex(ctx, EVP_aes_128_cbc(), nullptr, &key[0], iv.empty() ? nullptr : &iv[0], s_encrypt);
+   EVP_CIPHER_CTX* ctx = getThreadCipherContext();
+   if ((ctx == nullptr) ||
+      !EVP_CipherInit_ex(ctx, EVP_aes_128_cbc(), nullptr, &key[0], iv.empty() ? nullptr : &iv[0], s_encrypt))
+      return getLastCryptoError(ERROR_LOCATION);
 
    // perform the encryption
    if(!EVP_CipherUpdate(ctx, &out_encrypted[0], &outlen, &data[0], static_cast<int>(data.size())))
-   {
-      EVP_CIPHER_CTX_free(ctx);
       return getLastCryptoError(ERROR_LOCATION);
-   }
    bytesEncrypted += outlen;
 
    // perform final flush including left-over padding
    if(!EVP_CipherFinal_ex(ctx, &out_encrypted[outlen], &outlen))
-   {
-      EVP_CIPHER_CTX_free(ctx);
       return getLastCryptoError(ERROR_LOCATION);
-   }
    bytesEncrypted += outlen;
 
-   EVP_CIPHER_CTX_free(ctx);
-
    // resize the container to the amount of actual bytes encrypted (including padding)
    out_encrypted.resize(bytesEncrypted);
 
@@ -189,93 +216,94 @@ Error aesEncrypt(
 
 Error base64Encode(const std::vector<unsigned char>& in_data, std::string& out_encoded)
 {
-   return base64Encode(&in_data[0], static_cast<int>(in_data.size()), out_encoded);
+   return base64Encode(in_data.data(), static_cast<int>(in_data.size()), out_encoded);
 }
 
 Error base64Encode(const unsigned char* in_data, int in_length, std::string& out_encoded)
 {
-   // allocate BIO
-   BIO* pB64 = ::BIO_new(BIO_f_base64());
-   if (pB64 == nullptr)
-      return getLastCryptoError(ERROR_LOCATION);
-
-   // no newlines
-   BIO_set_flags(pB64, BIO_FLAGS_BASE64_NO_NL);
-
-   // make sure it is freed prior to exit from the function
-   BIOFreeAllScope freeB64Scope(pB64);
-
-   // allocate memory stream
-   BIO* pMem = ::BIO_new(BIO_s_mem());
-   if (pMem == nullptr)
-      return getLastCryptoError(ERROR_LOCATION);
+   if (in_length < 0)
+      return systemError(EINVAL, ERROR_LOCATION);
 
-   // tie the stream to the b64 stream
-   pB64 = ::BIO_push(pB64, pMem);
+   size_t length = static_cast<size_t>(in_length);
+   out_encoded.resize(((length + 2) / 3) * 4);
 
-   // perform the encoding
-   int written = ::BIO_write(pB64, in_data, in_length);
-   if (written != in_length)
-      return getLastCryptoError(ERROR_LOCATION);
-
-   // flush all writes
-   int result = BIO_flush(pB64);
-   if (result <= 0)
-      return getLastCryptoError(ERROR_LOCATION);
-
-   // seek to beginning of memory stream
-   result = BIO_seek(pMem, 0);
-   if (result == -1)
-      return getLastCryptoError(ERROR_LOCATION);
-
-   // read the memory stream
-   std::vector<char> buffer(in_length * 2); // plenty more than len * 1.37 + padding
-   int bytesRead = ::BIO_read(pMem, &buffer[0], static_cast<int>(buffer.capacity()));
-   if (bytesRead < 0 && ::ERR_get_error() != 0)
-      return getLastCryptoError(ERROR_LOCATION);
+   // Encode each full group of three bytes as four characters.
+   char* out = &out_encoded[0];
+   size_t i = 0;
+   for (; (i + 2) < length; i += 3)
+   {
+      uint32_t group = (static_cast<uint32_t>(in_data[i]) << 16) |
+                       (static_cast<uint32_t>(in_data[i + 1]) << 8) |
+                       static_cast<uint32_t>(in_data[i + 2]);
+      *out++ = s_base64Alphabet[(group >> 18) & 0x3F];
+      *out++ = s_base64Alphabet[(group >> 12) & 0x3F];
+      *out++ = s_base64Alphabet[(group >> 6) & 0x3F];
+      *out++ = s_base64Alphabet[group & 0x3F];
+   }
 
-   // copy to out param
-   buffer.resize(bytesRead);
-   out_encoded.assign(buffer.begin(), buffer.end());
+   // Encode the remaining one or two bytes, with padding.
+   if (i < length)
+   {
+      uint32_t group = static_cast<uint32_t>(in_data[i]) << 16;
+      if ((i + 1) < length)
+         group |= static_cast<uint32_t>(in_data[i + 1]) << 8;
+
+      *out++ = s_base64Alphabet[(group >> 18) & 0x3F];
+      *out++ = s_base64Alphabet[(group >> 12) & 0x3F];
+      *out++ = ((i + 1) < length) ? s_base64Alphabet[(group >> 6) & 0x3F] : '=';
+      *out++ = '=';
+   }
 
-   // return success
    return Success();
 }
 
 Error base64Decode(const std::string& in_data, std::vector<unsigned char>& out_decoded)
 {
-   // allocate b64 BIO
-   BIO* pB64 = ::BIO_new(BIO_f_base64());
-   if (pB64 == nullptr)
-      return getLastCryptoError(ERROR_LOCATION);
-
-   // no newlines
-   BIO_set_flags(pB64, BIO_FLAGS_BASE64_NO_NL);
+   // Ignore padding at the end of the input.
+   size_t length = in_data.size();
+   size_t padding = 0;
+   while ((length > 0) && (padding < 2) && (in_data[length - 1] == '='))
+   {
+      --length;
+      ++padding;
+   }
 
-   // make sure it is freed prior to exit from the function
-   BIOFreeAllScope freeB64Scope(pB64);
+   // A single trailing character can't encode a whole byte.
+   if ((length % 4) == 1)
+      return invalidBase64Error(ERROR_LOCATION);
 
-   // allocate buffer
-   BIO* pMem = BIO_new_mem_buf((void*)in_data.data(), static_cast<int>(in_data.length()));
-   if (pMem == nullptr)
-      return getLastCryptoError(ERROR_LOCATION);
+   out_decoded.resize((length / 4) * 3 + (((length % 4) == 0) ? 0 : (length % 4) - 1));
 
-   // tie the stream to the b64 stream
-   pB64 = ::BIO_push(pB64, pMem);
+   const unsigned char* in = reinterpret_cast<const unsigned char*>(in_data.data());
+   unsigned char* out = out_decoded.data();
+   uint32_t group = 0;
+   size_t groupSize = 0;
+   for (size_t i = 0; i < length; ++i)
+   {
+      unsigned char value = s_base64DecodeTable[in[i]];
+      if (value == s_invalidBase64)
+         return invalidBase64Error(ERROR_LOCATION);
 
-   // reserve adequate memory in the decoded buffer and read into it
-   out_decoded.clear();
-   out_decoded.resize(in_data.length());
-   int bytesRead = ::BIO_read(pB64,
-                              &(out_decoded[0]),
-                              static_cast<int>(out_decoded.size()));
-   if (bytesRead < 0)
-      return getLastCryptoError(ERROR_LOCATION);
+      group = (group << 6) | value;
+      if (++groupSize == 4)
+      {
+         *out++ = static_cast<unsigned char>(group >> 16);
+         *out++ = static_cast<unsigned char>(group >> 8);
+         *out++ = static_cast<unsigned char>(group);
+         group = 0;
+         groupSize = 0;
+      }
+   }
 
-   // resize the out buffer to the number of bytes actually read
-   out_decoded.resize(bytesRead);
+   // Decode the final partial group, if any.
+   if (groupSize == 3)
+   {
+      *out++ = static_cast<unsigned char>(group >> 10);
+      *out++ = static_cast<unsigned char>(group >> 2);
+   }
+   else if (groupSize == 2)
+      *out++ = static_cast<unsigned char>(group >> 4);
 
-   // return success
    return Success();
 }
 
@@ -286,8 +314,7 @@ Error base64Decode(const std::string& in_data, std::string& out_decoded)
    if (error)
       return error;
 
-   out_decoded.reserve(decoded.size());
-   std::copy(decoded.begin(), decoded.end(), std::back_inserter(out_decoded));
+   out_decoded.assign(decoded.begin(), decoded.end());
    return Success();
 }
 
@@ -298,8 +325,7 @@ Error decryptAndBase64Decode(
    std::string& out_decrypted)
 {
    // copy key into vector
-   std::vector<unsigned char> key;
-   std::copy(keyStr.begin(), keyStr.end(), std::back_inserter(key));
+   std::vector<unsigned char> key(keyStr.begin(), keyStr.end());
 
    // decode initialization vector
    std::vector<unsigned char> iv;
@@ -320,8 +346,7 @@ Error decryptAndBase64Decode(
       return error;
 
    // convert the decrypted bytes into the original string
-   out_decrypted.reserve(decrypted.size());
-   std::copy(decrypted.begin(), decrypted.end(), std::back_inserter(out_decrypted));
+   out_decrypted.assign(decrypted.begin(), decrypted.end());
 
    return Success();
 }
@@ -364,8 +389,12 @@ Error encryptAndBase64Encode(
 Error random(uint32_t in_length, std::vector<unsigned char>& out_randomData)
 {
    out_randomData.resize(in_length);
+   return random(in_length, out_randomData.data());
+}
 
-   if (!RAND_bytes(&out_randomData[0], in_length))
+Error random(uint32_t in_length, unsigned char* out_randomData)
+{
+   if (!RAND_bytes(out_randomData, static_cast<int>(in_length)))
       return getLastCryptoError(ERROR_LOCATION);
 
    return Success();
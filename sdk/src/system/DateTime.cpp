@@ -36,6 +36,88 @@ namespace system {
 namespace {
 constexpr char const* ISO_8601_OUTPUT_FORMAT = "%Y-%m-%dT%H:%M:%S%FZ";
 constexpr char const* ISO_8601_INPUT_FORMAT  = "%Y-%m-%dT%H:%M:%S%F%ZP";
+
+bool readDigits(const std::string& in_str, size_t in_pos, size_t in_count, int& out_value)
+{
+   out_value = 0;
+   for (size_t i = in_pos; i < in_pos + in_count; ++i)
+   {
+      if ((in_str[i] < '0') || (in_str[i] > '9'))
+         return false;
+
+      out_value = (out_value * 10) + (in_str[i] - '0');
+   }
+
+   return true;
+}
+
+/**
+ * @brief Parses a UTC time in the format written by DateTime::toString (e.g. 2020-01-31T13:05:00.123456Z) without
+ *        constructing a stream and locale, which is far more expensive than the parsing itself.
+ *
+ * @param in_timeStr     The string to parse.
+ * @param out_time       The parsed time, if the string was in the expected format.
+ *
+ * @return True if the string was in the expected format; false if it needs to be parsed by the general parser.
+ */
+bool parseUtcTime(const std::string& in_timeStr, boost::posix_time::ptime& out_time)
+{
+   // YYYY-MM-DDTHH:MM:SS, an optional fraction of a second, and Z.
+   const size_t length = in_timeStr.size();
+   if ((length < 20) ||
+      (in_timeStr[4] != '-') ||
+      (in_timeStr[7] != '-') ||
+      (in_timeStr[10] != 'T') ||
+      (in_timeStr[13] != ':') ||
+      (in_timeStr[16] != ':') ||
+      (in_timeStr[length - 1] != 'Z'))
+      return false;
+
+   int year, month, day, hours, minutes, seconds;
+   if (!readDigits(in_timeStr, 0, 4, year) ||
+      !readDigits(in_timeStr, 5, 2, month) ||
+      !readDigits(in_timeStr, 8, 2, day) ||
+      !readDigits(in_timeStr, 11, 2, hours) ||
+      !readDigits(in_timeStr, 14, 2, minutes) ||
+      !readDigits(in_timeStr, 17, 2, seconds))
+      return false;
+
+   if ((hours > 23) || (minutes > 59) || (seconds > 59))
+      return false;
+
+   int64_t fractionalTicks = 0;
+   if (length > 20)
+   {
+      const size_t digits = length - 21;
+      const size_t maxDigits = boost::posix_time::time_duration::num_fractional_digits();
+      int fraction = 0;
+      if ((in_timeStr[19] != '.') || (digits == 0) || (digits > maxDigits) ||
+         !readDigits(in_timeStr, 20, digits, fraction))
+         return false;
+
+      fractionalTicks = fraction;
+      for (size_t i = digits; i < maxDigits; ++i)
+         fractionalTicks *= 10;
+   }
+
+   try
+   {
+      out_time = boost::posix_time::ptime(
+         boost::gregorian::date(
+            static_cast<unsigned short>(year),
+            static_cast<unsigned short>(month),
+            static_cast<unsigned short>(day)),
+         boost::posix_time::time_duration(hours, minutes, seconds, fractionalTicks));
+   }
+   catch (const std::exception&)
+   {
+      // Invalid dates, such as February 30th, are reported by the general parser.
+      return false;
+   }
+
+   return true;
+}
+
 } // anonymous namespace
 
 // TimeDuration ========================================================================================================
@@ -213,6 +295,15 @@ int64_t TimeDuration::getMicroseconds() const
    return m_impl->Time.fractional_seconds();
 }
 
+std::chrono::steady_clock::duration TimeDuration::toSteadyDuration() const
+{
+   return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::hours(getHours()) +
+      std::chrono::minutes(getMinutes()) +
+      std::chrono::seconds(getSeconds()) +
+      std::chrono::microseconds(getMicroseconds()));
+}
+
 // DateTime ============================================================================================================
 struct DateTime::Impl
 {
@@ -252,6 +343,14 @@ DateTime::DateTime(DateTime&& in_other) noexcept :
 
 Error DateTime::fromString(const std::string& in_timeStr, DateTime& out_dateTime)
 {
+   // Most times were written by this class, so try the fast path first.
+   boost::posix_time::ptime time;
+   if (parseUtcTime(in_timeStr, time))
+   {
+      out_dateTime.m_impl->Time = time;
+      return Success();
+   }
+
    return fromString(in_timeStr, ISO_8601_INPUT_FORMAT, out_dateTime);
 }
 
@@ -23,11 +23,14 @@
 
 #include <system/Process.hpp>
 
+#include <algorithm>
 #include <condition_variable>
 #include <cstring>
 #include <dirent.h>
 #include <fcntl.h>
+#include <grp.h>
 #include <sys/resource.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
 #include <unordered_set>
@@ -38,6 +41,7 @@
 
 #include <SafeConvert.hpp>
 #include <json/Json.hpp>
+#include <logging/Trace.hpp>
 #include <options/Options.hpp>
 #include <system/Asio.hpp>
 #include <system/PosixSystem.hpp>
@@ -220,12 +224,14 @@ int getExitCodeFromStatus(int in_status);
 /**
  * @brief Changes the user after fork.
  * 
- * @param in_uid     The ID of the user to which to change.
- * @param in_gid     The group ID of the user to which to change.
+ * @param in_uid            The ID of the user to which to change.
+ * @param in_gid            The group ID of the user to which to change.
+ * @param in_groups         The supplementary group IDs of the user, or nullptr to leave them unchanged.
+ * @param in_groupCount     The number of supplementary group IDs in in_groups.
  * 
  * @return 0 on success; the error code that occurred otherwise.
  */
-int changeUser(uid_t in_uid, gid_t in_gid)
+int changeUser(uid_t in_uid, gid_t in_gid, const gid_t* in_groups = nullptr, size_t in_groupCount = 0)
 {
    // If it's possible to escalate to the root user before attempting to change users, do so.
    if (system::posix::realUserIsRoot() && (geteuid() != 0))
@@ -237,6 +243,8 @@ int changeUser(uid_t in_uid, gid_t in_gid)
 
    if (in_uid != 0)
    {
+      if ((in_groups != nullptr) && (::setgroups(in_groupCount, in_groups) == -1))
+         return s_threadSafeExitError;
       if (::setgid(in_gid) == -1)
          return s_threadSafeExitError;
       if (::setuid(in_uid) == -1)
@@ -261,6 +269,33 @@ int changeUser(const system::User& in_user)
    return changeUser(in_user.getUserId(), in_user.getGroupId());
 }
 
+/**
+ * @brief Gets the supplementary group IDs of a user.
+ *
+ * @param in_user        The user.
+ * @param out_groups     The group IDs of the user, including the user's primary group.
+ *
+ * @return Success if the groups could be retrieved; Error otherwise.
+ */
+Error getGroupIds(const system::User& in_user, std::vector<gid_t>& out_groups)
+{
+   // getgrouplist reports the required size when the buffer is too small, so at most one retry should be needed.
+   int groupCount = 16;
+   for (int attempt = 0; attempt < 3; ++attempt)
+   {
+      out_groups.resize(static_cast<size_t>(groupCount));
+      if (::getgrouplist(in_user.getUsername().c_str(), in_user.getGroupId(), out_groups.data(), &groupCount) >= 0)
+      {
+         out_groups.resize(static_cast<size_t>(groupCount));
+         return Success();
+      }
+
+      groupCount = std::max(groupCount, static_cast<int>(out_groups.size()) * 2);
+   }
+
+   return systemError(EINVAL, "Unable to get the groups of user " + in_user.getUsername(), ERROR_LOCATION);
+}
+
 /**
  * @brief Clears the signal mask of the current process.
  *
@@ -974,10 +1009,10 @@ struct AbstractChildProcess::Impl
       // Set up the parent group id to ensure all children of this child process will belong to its process group, and
       // as such can be cleaned up by the parent.
       if (::setpgid(0, 0) == -1)
-         ::exit(s_threadSafeExitError);
+         ::_exit(s_threadSafeExitError);
 
       if (clearSignalMask() != 0)
-         ::exit(s_threadSafeExitError);
+         ::_exit(s_threadSafeExitError);
 
       // Close the side of the pipe that won't be used in the child.
       ::close(in_fds.Input[s_writePipe]);
@@ -1009,7 +1044,7 @@ struct AbstractChildProcess::Impl
       {
          result = changeUser(NewUser.Uid, NewUser.Gid);
          if (result != 0)
-            ::exit(result);
+            ::_exit(result);
       }
 
       if (in_environment.isEmpty())
@@ -1030,7 +1065,7 @@ struct AbstractChildProcess::Impl
       {
          // If SafeStdin is empty, that means there was no sensitive data to sterilize, so just log the regular
          // rdrStandardInput.
-         logging::logDebugMessage(
+         LOG_DEBUG_MESSAGE(
             "Launching rsandbox. \nArgs " +
             boost::algorithm::join(Arguments, " ") +
             "\nLaunch Profile: " +
@@ -1040,7 +1075,7 @@ struct AbstractChildProcess::Impl
       else
       {
          // Don't log Env or stdin since those are more likely to contain sensitive info.
-         logging::logDebugMessage(
+         LOG_DEBUG_MESSAGE(
             "Launching process " + Executable + ".\nArgs "+
                boost::algorithm::join(Arguments, " "),
             ERROR_LOCATION);
@@ -1554,20 +1589,14 @@ void AsyncChildProcess::checkExited(
    }
    END_LOCK_MUTEX
 
-   // Here we make explicit copies of the bound functions to ensure they won't be cleaned up off the stack if this
-   // object is destroyed before the function is allocated a thread to run on.
+   // Here we bind copies of the callbacks to ensure they won't be cleaned up if this object is destroyed before the
+   // function is allocated a thread to run on.
    if (m_hasExited && m_callbacks.OnExit)
-   {
-      AsioFunction onExitHandler = std::bind(m_callbacks.OnExit, exitCode);
-      AsioService::post(onExitHandler);
-   }
+      AsioService::post(std::bind(m_callbacks.OnExit, exitCode));
    else if (in_error)
    {
       if (m_callbacks.OnError)
-      {
-         AsioFunction onErrorHandler = std::bind(m_callbacks.OnError, in_error);
-         AsioService::post(onErrorHandler);
-      }
+         AsioService::post(std::bind(m_callbacks.OnError, in_error));
       else
          logging::logError(in_error, ERROR_LOCATION);
 
@@ -1727,6 +1756,7 @@ Error ProcessSupervisor::runAsyncProcess(
    const AsyncProcessCallbacks& in_callbacks,
    std::shared_ptr<AbstractChildProcess>* out_childProcess)
 {
+   logging::TraceSpan span("process.runAsync");
    ProcessSupervisor& instance = getInstance();
 
    // Wrap the exit call back so we can keep track of when a child exits.
@@ -1825,35 +1855,23 @@ Error getChildProcesses(pid_t in_parentPid, std::vector<ProcessInfo>& out_proces
    // All process mapped by their PIDs.
    typedef std::map<pid_t, std::shared_ptr<Node> > Tree;
 
-   DIR* dirPtr = nullptr;
+   std::set<pid_t> pids;
+   Error error = getProcessIds(pids);
+   if (error)
+      return error;
 
    // Step 1: Collect all the process info, making a node for each process.
    Tree allProcs;
-   try
+   for (pid_t pid: pids)
    {
-      dirPtr = ::opendir("/proc");
-      if (dirPtr == nullptr)
-         return systemError(errno, "Unable to open /proc to get process information", ERROR_LOCATION);
-
-      struct dirent* direntPtr;
-      while ((direntPtr = ::readdir(dirPtr)) != nullptr)
-      {
-         pid_t pid = safe_convert::stringTo(direntPtr->d_name, -1);
-
-         // Skip directories that aren't process directories.
-         if (pid == -1)
-            continue;
-
-         // If we can't get the information for the given PID, just skip it.
-         ProcessInfo info;
-         Error error = ProcessInfo::getProcessInfo(pid, info);
-         if (error)
-            continue;
+      // If we can't get the information for the given PID, just skip it.
+      ProcessInfo info;
+      error = ProcessInfo::getProcessInfo(pid, info);
+      if (error)
+         continue;
 
-         allProcs[pid] = std::make_shared<Node>(std::move(info));
-      }
+      allProcs[pid] = std::make_shared<Node>(std::move(info));
    }
-   CATCH_UNEXPECTED_EXCEPTION
 
    // Find the requested PID's node now, since we can short circuit if it doesn't exist and if it does exist the pointer
    // will still be valid after it's children are added to it.
@@ -1896,6 +1914,164 @@ Error getChildProcesses(pid_t in_parentPid, std::vector<ProcessInfo>& out_proces
    return Success();
 }
 
+Error getProcessIds(std::set<pid_t>& out_pids)
+{
+   DIR* dirPtr = ::opendir("/proc");
+   if (dirPtr == nullptr)
+      return systemError(errno, "Unable to open /proc to get process information", ERROR_LOCATION);
+
+   struct dirent* direntPtr;
+   while ((direntPtr = ::readdir(dirPtr)) != nullptr)
+   {
+      pid_t pid = safe_convert::stringTo(direntPtr->d_name, -1);
+
+      // Skip directories that aren't process directories.
+      if (pid != -1)
+         out_pids.insert(pid);
+   }
+
+   ::closedir(dirPtr);
+   return Success();
+}
+
+Error openFileForAppendAsUser(const FilePath& in_file, const User& in_user, int& out_fd)
+{
+   const int flags = O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | O_NOCTTY;
+   const std::string path = in_file.getAbsolutePath();
+
+   // If no user change is needed, open the file directly.
+   if (in_user.isEmpty() || in_user.isAllUsers() || (in_user.getUserId() == ::geteuid()))
+   {
+      int fd = ::open(path.c_str(), flags, 0666);
+      if (fd < 0)
+      {
+         Error error = systemError(errno, ERROR_LOCATION);
+         error.addProperty("path", path);
+         return error;
+      }
+
+      out_fd = fd;
+      return Success();
+   }
+
+   // The child must not keep this process's supplementary groups, which may grant access that the user doesn't have.
+   // Look the user's groups up now, since doing so isn't async-signal-safe.
+   std::vector<gid_t> groups;
+   Error error = getGroupIds(in_user, groups);
+   if (error)
+      return error;
+
+   int sockets[2];
+   if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) < 0)
+      return systemError(errno, ERROR_LOCATION);
+
+   uid_t uid = in_user.getUserId();
+   gid_t gid = in_user.getGroupId();
+   const gid_t* groupIds = groups.data();
+   size_t groupCount = groups.size();
+
+   pid_t pid = ::fork();
+   if (pid < 0)
+   {
+      error = systemError(errno, ERROR_LOCATION);
+      ::close(sockets[0]);
+      ::close(sockets[1]);
+      return error;
+   }
+
+   // The child may only call async-signal-safe functions, since the parent may have other threads.
+   if (pid == 0)
+   {
+      ::close(sockets[0]);
+      if (changeUser(uid, gid, groupIds, groupCount) != 0)
+         ::_exit(EPERM);
+
+      int fd = ::open(path.c_str(), flags, 0666);
+      if (fd < 0)
+         ::_exit(errno);
+
+      char data = 0;
+      struct iovec ioVec;
+      ioVec.iov_base = &data;
+      ioVec.iov_len = 1;
+
+      union
+      {
+         struct cmsghdr Header;
+         char Buffer[CMSG_SPACE(sizeof(int))];
+      } control;
+      std::memset(&control, 0, sizeof(control));
+
+      struct msghdr message;
+      std::memset(&message, 0, sizeof(message));
+      message.msg_iov = &ioVec;
+      message.msg_iovlen = 1;
+      message.msg_control = control.Buffer;
+      message.msg_controllen = sizeof(control.Buffer);
+
+      struct cmsghdr* controlHeader = CMSG_FIRSTHDR(&message);
+      controlHeader->cmsg_level = SOL_SOCKET;
+      controlHeader->cmsg_type = SCM_RIGHTS;
+      controlHeader->cmsg_len = CMSG_LEN(sizeof(int));
+      std::memcpy(CMSG_DATA(controlHeader), &fd, sizeof(int));
+
+      if (::sendmsg(sockets[1], &message, 0) < 0)
+         ::_exit(errno);
+
+      ::_exit(0);
+   }
+
+   ::close(sockets[1]);
+
+   // Receive the file descriptor. If the child failed, the socket will be closed without any data.
+   char data = 0;
+   struct iovec ioVec;
+   ioVec.iov_base = &data;
+   ioVec.iov_len = 1;
+
+   union
+   {
+      struct cmsghdr Header;
+      char Buffer[CMSG_SPACE(sizeof(int))];
+   } control;
+   std::memset(&control, 0, sizeof(control));
+
+   struct msghdr message;
+   std::memset(&message, 0, sizeof(message));
+   message.msg_iov = &ioVec;
+   message.msg_iovlen = 1;
+   message.msg_control = control.Buffer;
+   message.msg_controllen = sizeof(control.Buffer);
+
+   int fd = -1;
+   ssize_t received = posix::posixCall<ssize_t>(std::bind(::recvmsg, sockets[0], &message, MSG_CMSG_CLOEXEC));
+   if (received > 0)
+   {
+      struct cmsghdr* controlHeader = CMSG_FIRSTHDR(&message);
+      if ((controlHeader != nullptr) &&
+         (controlHeader->cmsg_level == SOL_SOCKET) &&
+         (controlHeader->cmsg_type == SCM_RIGHTS))
+         std::memcpy(&fd, CMSG_DATA(controlHeader), sizeof(int));
+   }
+
+   ::close(sockets[0]);
+
+   int status = 0;
+   posix::posixCall<pid_t>(std::bind(::waitpid, pid, &status, 0));
+
+   if (fd < 0)
+   {
+      int exitCode = getExitCodeFromStatus(status);
+      error = systemError((exitCode != 0) ? exitCode : EIO, ERROR_LOCATION);
+      error.addProperty("path", path);
+      error.addProperty("user", in_user.getUsername());
+      return error;
+   }
+
+   out_fd = fd;
+   return Success();
+}
+
 Error signalProcess(pid_t in_pid, int in_signal, bool in_processGroupOnly)
 {
    std::function<int()> signalFunction;
@@ -25,12 +25,19 @@
 
 #include <pwd.h>
 
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
 #include <boost/algorithm/string.hpp>
 
 #include <Error.hpp>
+#include <system/DateTime.hpp>
 #include <system/FilePath.hpp>
 #include "SafeConvert.hpp"
 #include <system/PosixSystem.hpp>
+#include <utils/MutexUtils.hpp>
 
 namespace rstudio {
 namespace launcher_plugins {
@@ -114,6 +121,256 @@ struct User::Impl
 
 PRIVATE_IMPL_DELETER_IMPL(User)
 
+namespace {
+
+typedef std::chrono::steady_clock SteadyClock;
+
+// The maximum number of users to cache for each kind of key.
+constexpr size_t MAX_CACHED_USERS = 4096;
+
+// The longest time to remember that a user does not exist, so new users are found quickly.
+constexpr std::chrono::seconds MAX_NOT_FOUND_TIME_TO_LIVE(5);
+
+/**
+ * @brief The cached result of a user lookup.
+ */
+struct CachedUser
+{
+   /** The time after which the result must be looked up again. */
+   SteadyClock::time_point Expiry;
+
+   /** The user, if the user was found. */
+   User FoundUser;
+
+   /** The error, if the user was not found. */
+   Error NotFoundError;
+};
+
+/**
+ * @brief A thread-safe, bounded cache of user lookups, keyed by username and by user ID.
+ *
+ * Found users are cached for the configured time to live. Users which do not exist are cached for a shorter time.
+ * Other lookup failures, which may be transient, are not cached.
+ */
+class UserCache
+{
+public:
+   /**
+    * @brief Gets the single user cache for this process.
+    *
+    * @return The single user cache for this process.
+    */
+   static UserCache& getInstance()
+   {
+      static UserCache userCache;
+      return userCache;
+   }
+
+   /**
+    * @brief Looks up a user through the cache.
+    *
+    * @param in_key         The username or user ID of the user.
+    * @param in_lookUp      The function which looks up the user in the system user database, if it is not cached.
+    * @param out_user       The user, if it could be found.
+    *
+    * @return Success if the user could be found; Error otherwise.
+    */
+   template <typename K>
+   Error getUser(const K& in_key, const std::function<Error(User&)>& in_lookUp, User& out_user)
+   {
+      User user;
+      Error error;
+      if (find(getMap(in_key), in_key, user, error))
+      {
+         if (!error)
+            out_user = user;
+         return error;
+      }
+
+      error = in_lookUp(user);
+      if (!error)
+      {
+         add(in_key, user);
+         out_user = user;
+      }
+      else if (isNotFoundError(error))
+         addNotFound(in_key, error);
+
+      return error;
+   }
+
+   /**
+    * @brief Removes all users from the cache.
+    */
+   void clear()
+   {
+      LOCK_MUTEX(m_mutex)
+      {
+         m_byName.clear();
+         m_byUid.clear();
+      }
+      END_LOCK_MUTEX
+   }
+
+   /**
+    * @brief Sets how long users are cached.
+    *
+    * @param in_timeToLive      How long users are cached. Zero disables the cache.
+    */
+   void setTimeToLive(SteadyClock::duration in_timeToLive)
+   {
+      LOCK_MUTEX(m_mutex)
+      {
+         m_timeToLive = in_timeToLive;
+         m_byName.clear();
+         m_byUid.clear();
+      }
+      END_LOCK_MUTEX
+   }
+
+private:
+   template <typename K>
+   using CacheMap = std::unordered_map<K, CachedUser>;
+
+   /**
+    * @brief Constructor.
+    */
+   UserCache() :
+      m_timeToLive(std::chrono::seconds(60))
+   {
+   }
+
+   CacheMap<std::string>& getMap(const std::string&)
+   {
+      return m_byName;
+   }
+
+   CacheMap<UidType>& getMap(UidType)
+   {
+      return m_byUid;
+   }
+
+   /**
+    * @brief Finds an unexpired result in the cache.
+    *
+    * @param in_map         The map to search.
+    * @param in_key         The key of the user.
+    * @param out_user       The user, if it was found.
+    * @param out_error      The error, if the user was cached as not found.
+    *
+    * @return True if an unexpired result was found; false otherwise.
+    */
+   template <typename K>
+   bool find(CacheMap<K>& in_map, const K& in_key, User& out_user, Error& out_error)
+   {
+      LOCK_MUTEX(m_mutex)
+      {
+         auto itr = in_map.find(in_key);
+         if (itr == in_map.end())
+            return false;
+
+         if (itr->second.Expiry <= SteadyClock::now())
+         {
+            in_map.erase(itr);
+            return false;
+         }
+
+         out_user = itr->second.FoundUser;
+         out_error = itr->second.NotFoundError;
+         return true;
+      }
+      END_LOCK_MUTEX
+
+      return false;
+   }
+
+   /**
+    * @brief Caches a found user under the key it was looked up by, and under both its username and its user ID.
+    *
+    * @param in_key     The key the user was looked up by.
+    * @param in_user    The user.
+    */
+   template <typename K>
+   void add(const K& in_key, const User& in_user)
+   {
+      LOCK_MUTEX(m_mutex)
+      {
+         if (m_timeToLive == SteadyClock::duration::zero())
+            return;
+
+         SteadyClock::time_point expiry = SteadyClock::now() + m_timeToLive;
+         insert(m_byName, in_user.getUsername(), CachedUser{ expiry, in_user, Success() });
+         insert(m_byUid, in_user.getUserId(), CachedUser{ expiry, in_user, Success() });
+         insert(getMap(in_key), in_key, CachedUser{ expiry, in_user, Success() });
+      }
+      END_LOCK_MUTEX
+   }
+
+   /**
+    * @brief Caches that a user does not exist.
+    *
+    * @param in_key         The key of the user.
+    * @param in_error       The error which was returned by the lookup.
+    */
+   template <typename K>
+   void addNotFound(const K& in_key, const Error& in_error)
+   {
+      LOCK_MUTEX(m_mutex)
+      {
+         if (m_timeToLive == SteadyClock::duration::zero())
+            return;
+
+         SteadyClock::time_point expiry =
+            SteadyClock::now() + std::min<SteadyClock::duration>(m_timeToLive, MAX_NOT_FOUND_TIME_TO_LIVE);
+         insert(getMap(in_key), in_key, CachedUser{ expiry, User(true), in_error });
+      }
+      END_LOCK_MUTEX
+   }
+
+   /**
+    * @brief Inserts or replaces a result. If the map is full, expired results are removed first, and then an arbitrary
+    *        result if it is still full. The mutex must be held.
+    *
+    * @param io_map         The map to insert into.
+    * @param in_key         The key of the user.
+    * @param in_cachedUser  The result to insert.
+    */
+   template <typename K>
+   static void insert(CacheMap<K>& io_map, const K& in_key, CachedUser in_cachedUser)
+   {
+      if ((io_map.size() >= MAX_CACHED_USERS) && (io_map.find(in_key) == io_map.end()))
+      {
+         SteadyClock::time_point now = SteadyClock::now();
+         for (auto itr = io_map.begin(); itr != io_map.end();)
+         {
+            if (itr->second.Expiry <= now)
+               itr = io_map.erase(itr);
+            else
+               ++itr;
+         }
+
+         if (io_map.size() >= MAX_CACHED_USERS)
+            io_map.erase(io_map.begin());
+      }
+
+      io_map[in_key] = std::move(in_cachedUser);
+   }
+
+   /** The cached users, by username. */
+   CacheMap<std::string> m_byName;
+
+   /** The cached users, by user ID. */
+   CacheMap<UidType> m_byUid;
+
+   /** The mutex which protects the cache. */
+   std::mutex m_mutex;
+
+   /** How long found users are cached. */
+   SteadyClock::duration m_timeToLive;
+};
+
+} // anonymous namespace
+
 User::User(bool in_isEmpty) :
    m_impl(new Impl())
 {
@@ -132,23 +389,34 @@ Error User::getCurrentUser(User& out_currentUser)
 
 Error User::getUserFromIdentifier(const std::string& in_username, User& out_user)
 {
-   User user;
-
-   Error error = user.m_impl->populateUser<const char*>(::getpwnam_r, in_username.c_str());
-   if (!error)
-      out_user = user;
-
-   return error;
+   return UserCache::getInstance().getUser(
+      in_username,
+      [&in_username](User& out_lookedUpUser)
+      {
+         return out_lookedUpUser.m_impl->populateUser<const char*>(::getpwnam_r, in_username.c_str());
+      },
+      out_user);
 }
 
 Error User::getUserFromIdentifier(UidType in_userId, User& out_user)
 {
-   User user;
-   Error error = user.m_impl->populateUser<UidType>(::getpwuid_r, in_userId);
-   if (!error)
-      out_user = user;
+   return UserCache::getInstance().getUser(
+      in_userId,
+      [in_userId](User& out_lookedUpUser)
+      {
+         return out_lookedUpUser.m_impl->populateUser<UidType>(::getpwuid_r, in_userId);
+      },
+      out_user);
+}
 
-   return error;
+void User::clearCache()
+{
+   UserCache::getInstance().clear();
+}
+
+void User::setCacheTimeToLive(const TimeDuration& in_timeToLive)
+{
+   UserCache::getInstance().setTimeToLive(in_timeToLive.toSteadyDuration());
 }
 
 FilePath User::getUserHomePath(const std::string& in_envOverride)
@@ -0,0 +1,186 @@
+/*
+ * AsioServiceTests.cpp
+ *
+ * Copyright (C) 2020 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <TestMain.hpp>
+
+#include <array>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <system/Asio.hpp>
+#include <system/DateTime.hpp>
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace system {
+
+namespace {
+
+/**
+ * @brief Counts down completed jobs and lets the test wait for all of them.
+ */
+struct JobLatch
+{
+   explicit JobLatch(size_t in_count) :
+      Remaining(in_count)
+   {
+   }
+
+   void countDown()
+   {
+      std::lock_guard<std::mutex> lock(Mutex);
+      if (--Remaining == 0)
+         Condition.notify_all();
+   }
+
+   bool wait()
+   {
+      std::unique_lock<std::mutex> lock(Mutex);
+      return Condition.wait_for(lock, std::chrono::seconds(10), [this]() { return Remaining == 0; });
+   }
+
+   std::condition_variable Condition;
+   std::mutex Mutex;
+   size_t Remaining;
+};
+
+} // anonymous namespace
+
+TEST_CASE("AsioTask")
+{
+   SECTION("Small callables are stored inline")
+   {
+      std::shared_ptr<int> value(new int(0));
+      auto increment = [value]() { ++*value; };
+      CHECK(AsioTask::fitsInline<decltype(increment)>());
+
+      AsioTask task(increment);
+      AsioTask moved(std::move(task));
+      moved();
+      CHECK(*value == 1);
+   }
+
+   SECTION("Large callables are stored on the heap")
+   {
+      std::shared_ptr<int> value(new int(0));
+      std::array<char, 256> padding{};
+      auto increment = [value, padding]() { *value += 1 + padding[0]; };
+      CHECK_FALSE(AsioTask::fitsInline<decltype(increment)>());
+
+      AsioTask task(increment);
+      AsioTask moved(std::move(task));
+      moved();
+      CHECK(*value == 1);
+   }
+
+   SECTION("The callable is destroyed with the task")
+   {
+      std::shared_ptr<int> value(new int(0));
+      {
+         AsioTask task([value]() { ++*value; });
+         AsioTask moved(std::move(task));
+         CHECK(value.use_count() == 2);
+      }
+      CHECK(value.use_count() == 1);
+   }
+}
+
+// The ASIO service can only be started once per process, so everything is checked in a single test case.
+TEST_CASE("Context per thread")
+{
+   AsioService::startThreads(4, AsioThreadModel::CONTEXT_PER_THREAD);
+
+   // Posted jobs are distributed between the threads.
+   {
+      constexpr size_t jobCount = 1000;
+      JobLatch latch(jobCount);
+      std::mutex mutex;
+      std::set<std::thread::id> threadIds;
+      for (size_t i = 0; i < jobCount; ++i)
+         AsioService::post(
+            [&]()
+            {
+               {
+                  std::lock_guard<std::mutex> lock(mutex);
+                  threadIds.insert(std::this_thread::get_id());
+               }
+               latch.countDown();
+            });
+
+      REQUIRE(latch.wait());
+      CHECK(threadIds.size() == 4);
+   }
+
+   // Jobs posted with the same key run on the same thread, in order.
+   {
+      constexpr size_t jobCount = 1000;
+      constexpr size_t keyCount = 3;
+      JobLatch latch(jobCount * keyCount);
+      std::mutex mutex;
+      std::vector<std::vector<size_t> > jobOrder(keyCount);
+      std::vector<std::set<std::thread::id> > threadIds(keyCount);
+      for (size_t i = 0; i < jobCount; ++i)
+      {
+         for (size_t key = 0; key < keyCount; ++key)
+            AsioService::post(
+               key,
+               [&, i, key]()
+               {
+                  {
+                     std::lock_guard<std::mutex> lock(mutex);
+                     jobOrder[key].push_back(i);
+                     threadIds[key].insert(std::this_thread::get_id());
+                  }
+                  latch.countDown();
+               });
+      }
+
+      REQUIRE(latch.wait());
+      for (size_t key = 0; key < keyCount; ++key)
+      {
+         CHECK(threadIds[key].size() == 1);
+         REQUIRE(jobOrder[key].size() == jobCount);
+         for (size_t i = 0; i < jobCount; ++i)
+            CHECK(jobOrder[key][i] == i);
+      }
+   }
+
+   // Timers still work.
+   {
+      JobLatch latch(1);
+      AsyncDeadlineEvent event([&latch]() { latch.countDown(); }, TimeDuration::Microseconds(1000));
+      event.start();
+      CHECK(latch.wait());
+   }
+
+   AsioService::stop();
+   AsioService::waitForExit();
+}
+
+} // namespace system
+} // namespace launcher_plugins
+} // namespace rstudio
@@ -50,6 +50,20 @@ TEST_CASE("Timer is invoked")
    sleep(6);
    timer.cancel();
    CHECK(count == 4);
+
+   // The event may stop its own timer.
+   AsyncTimedEvent selfCanceling;
+   int selfCancelingCount = 0;
+   selfCanceling.start(
+      TimeDuration::Seconds(1),
+      [&selfCanceling, &selfCancelingCount]()
+      {
+         ++selfCancelingCount;
+         selfCanceling.reportError(Error("TimerError", 1, "Stop the timer.", ERROR_LOCATION));
+      });
+
+   sleep(3);
+   CHECK(selfCancelingCount == 1);
 }
 
 } // namespace system
@@ -0,0 +1,148 @@
+/*
+ * CryptoTests.cpp
+ *
+ * Copyright (C) 2020 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <TestMain.hpp>
+
+#include <thread>
+
+#include <Error.hpp>
+#include <system/Crypto.hpp>
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace system {
+namespace crypto {
+
+TEST_CASE("Base-64 encoding")
+{
+   SECTION("RFC 4648 test vectors")
+   {
+      const std::vector<std::pair<std::string, std::string> > vectors = {
+         { "", "" },
+         { "f", "Zg==" },
+         { "fo", "Zm8=" },
+         { "foo", "Zm9v" },
+         { "foob", "Zm9vYg==" },
+         { "fooba", "Zm9vYmE=" },
+         { "foobar", "Zm9vYmFy" } };
+
+      for (const auto& vector: vectors)
+      {
+         std::string encoded, decoded;
+         std::vector<unsigned char> data(vector.first.begin(), vector.first.end());
+         REQUIRE_FALSE(base64Encode(data, encoded));
+         CHECK(encoded == vector.second);
+
+         REQUIRE_FALSE(base64Decode(encoded, decoded));
+         CHECK(decoded == vector.first);
+      }
+   }
+
+   SECTION("Round trip all byte values")
+   {
+      std::vector<unsigned char> data;
+      for (int i = 0; i < 256; ++i)
+         data.push_back(static_cast<unsigned char>(i));
+
+      std::string encoded;
+      REQUIRE_FALSE(base64Encode(data, encoded));
+      CHECK(encoded.find_first_not_of(
+         "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/=") == std::string::npos);
+
+      std::vector<unsigned char> decoded;
+      REQUIRE_FALSE(base64Decode(encoded, decoded));
+      CHECK(decoded == data);
+   }
+
+   SECTION("Invalid input")
+   {
+      std::vector<unsigned char> decoded;
+      CHECK(base64Decode("Zm9v!mFy", decoded));
+      CHECK(base64Decode("Zm9vY", decoded));
+      CHECK(base64Decode("Zm=9v", decoded));
+   }
+
+   SECTION("Decoding replaces the output")
+   {
+      std::string decoded = "previous";
+      REQUIRE_FALSE(base64Decode("Zm9v", decoded));
+      CHECK(decoded == "foo");
+   }
+}
+
+TEST_CASE("AES encryption")
+{
+   const std::string key = "0123456789abcdef";
+
+   SECTION("Round trip")
+   {
+      std::string iv, encrypted, decrypted;
+      REQUIRE_FALSE(encryptAndBase64Encode("my secret password", key, iv, encrypted));
+      REQUIRE_FALSE(decryptAndBase64Decode(encrypted, key, iv, decrypted));
+      CHECK(decrypted == "my secret password");
+   }
+
+   SECTION("Failure does not affect later operations")
+   {
+      std::string iv, encrypted, decrypted;
+      REQUIRE_FALSE(encryptAndBase64Encode("first", key, iv, encrypted));
+      CHECK(decryptAndBase64Decode(encrypted, "fedcba9876543210", iv, decrypted));
+
+      decrypted.clear();
+      REQUIRE_FALSE(decryptAndBase64Decode(encrypted, key, iv, decrypted));
+      CHECK(decrypted == "first");
+   }
+
+   SECTION("Multiple threads")
+   {
+      bool failed[4] = { false, false, false, false };
+      std::vector<std::thread> threads;
+      for (int t = 0; t < 4; ++t)
+      {
+         threads.emplace_back(
+            [&key, &failed, t]()
+            {
+               for (int i = 0; i < 200; ++i)
+               {
+                  std::string input = "thread " + std::to_string(t) + " message " + std::to_string(i);
+                  std::string iv, encrypted, decrypted;
+                  if (encryptAndBase64Encode(input, key, iv, encrypted) ||
+                     decryptAndBase64Decode(encrypted, key, iv, decrypted) ||
+                     (decrypted != input))
+                     failed[t] = true;
+               }
+            });
+      }
+
+      for (std::thread& thread: threads)
+         thread.join();
+
+      for (bool threadFailed: failed)
+         CHECK_FALSE(threadFailed);
+   }
+}
+
+} // namespace crypto
+} // namespace system
+} // namespace launcher_plugins
+} // namespace rstudio
@@ -170,6 +170,18 @@ TEST_CASE("TimeDuration Construction")
       CHECK(i6 == i6);
       CHECK(i6 == TimeDuration::Infinity());
    }
+
+   SECTION("Steady clock durations")
+   {
+      CHECK(TimeDuration(5, 24, 57, 109827).toSteadyDuration() ==
+         std::chrono::hours(5) +
+            std::chrono::minutes(24) +
+            std::chrono::seconds(57) +
+            std::chrono::microseconds(109827));
+      CHECK(TimeDuration::Seconds(-30).toSteadyDuration() == std::chrono::seconds(-30));
+      CHECK(TimeDuration().toSteadyDuration() == std::chrono::steady_clock::duration::zero());
+      CHECK(TimeDuration::Infinity().toSteadyDuration() == std::chrono::steady_clock::duration::zero());
+   }
 }
 
 TEST_CASE("Construction and simple toString")
@@ -190,6 +202,29 @@ TEST_CASE("Construction and simple toString")
       CHECK(d.toString() == timeStr);
    }
 
+   SECTION("From ISO 8601 str (UTC, matches general parser)")
+   {
+      for (const std::string timeStr: {
+         "2019-02-15T11:23:44Z",
+         "2019-02-15T11:23:44.5Z",
+         "2019-02-15T11:23:44.000123Z",
+         "2020-02-29T23:59:59.999999Z" })
+      {
+         DateTime fast, general;
+         REQUIRE_FALSE(DateTime::fromString(timeStr, fast));
+         REQUIRE_FALSE(DateTime::fromString(timeStr, "%Y-%m-%dT%H:%M:%S%F%ZP", general));
+         CHECK(fast == general);
+         CHECK(fast.toString() == general.toString());
+      }
+   }
+
+   SECTION("From ISO 8601 str (UTC, invalid date)")
+   {
+      DateTime d;
+      CHECK(DateTime::fromString("2019-02-30T11:23:44.039876Z", d));
+      CHECK(DateTime::fromString("2019-13-15T11:23:44.039876Z", d));
+   }
+
    SECTION("From ISO 8601 str (+5:30)")
    {
       std::string expectedTime = "2019-02-15T05:53:44.039876Z";
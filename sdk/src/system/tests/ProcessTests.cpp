@@ -26,11 +26,15 @@
 #include <TestMain.hpp>
 
 #include <csignal>
+#include <grp.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <AsioRaii.hpp>
 
 #include <system/PosixSystem.hpp>
 #include <system/Process.hpp>
+#include <utils/FileUtils.hpp>
 
 #include "ProcessTestHelpers.hpp"
 
@@ -225,6 +229,81 @@ TEST_CASE("General tests")
       CHECK(stdOut == "Success\n");
       CHECK(stdErr == "");
    }
+
+   SECTION("Open file for append as another user")
+   {
+      User user;
+      REQUIRE_FALSE(User::getUserFromIdentifier(USER_FOUR, user));
+
+      FilePath file("/tmp/rlps-process-tests-append-" + std::to_string(::getpid()));
+      REQUIRE_FALSE(file.removeIfExists());
+
+      int fd = -1;
+      REQUIRE_FALSE(openFileForAppendAsUser(file, user, fd));
+      REQUIRE(fd >= 0);
+      CHECK(::write(fd, "first\n", 6) == 6);
+      ::close(fd);
+
+      // Opening again must append rather than truncate.
+      fd = -1;
+      REQUIRE_FALSE(openFileForAppendAsUser(file, user, fd));
+      CHECK(::write(fd, "second\n", 7) == 7);
+      ::close(fd);
+
+      struct stat st;
+      REQUIRE(::stat(file.getAbsolutePath().c_str(), &st) == 0);
+      CHECK(st.st_uid == user.getUserId());
+
+      std::string contents;
+      REQUIRE_FALSE(utils::readFileIntoString(file, contents));
+      CHECK(contents == "first\nsecond\n");
+
+      CHECK_FALSE(file.remove());
+   }
+
+   SECTION("Open file for append as another user without permission")
+   {
+      User user;
+      REQUIRE_FALSE(User::getUserFromIdentifier(USER_FOUR, user));
+
+      int fd = -1;
+      CHECK(openFileForAppendAsUser(FilePath("/root/rlps-process-tests-denied"), user, fd));
+      CHECK(fd == -1);
+   }
+
+   SECTION("Open file for append as another user without this process's groups")
+   {
+      User user;
+      REQUIRE_FALSE(User::getUserFromIdentifier(USER_FOUR, user));
+
+      // Only members of a group which the user doesn't belong to may write in the directory.
+      struct group* groupPtr = ::getgrnam(GROUP_ONE);
+      REQUIRE(groupPtr != nullptr);
+      gid_t groupId = groupPtr->gr_gid;
+
+      FilePath dir("/tmp/rlps-process-tests-group-" + std::to_string(::getpid()));
+      REQUIRE_FALSE(dir.ensureDirectory());
+      REQUIRE(::chown(dir.getAbsolutePath().c_str(), 0, groupId) == 0);
+      REQUIRE(::chmod(dir.getAbsolutePath().c_str(), 0770) == 0);
+
+      // Give this process the group, as the server user's groups would be.
+      int oldGroupCount = ::getgroups(0, nullptr);
+      REQUIRE(oldGroupCount >= 0);
+      std::vector<gid_t> oldGroups(static_cast<size_t>(oldGroupCount) + 1);
+      oldGroupCount = ::getgroups(oldGroupCount, oldGroups.data());
+      REQUIRE(oldGroupCount >= 0);
+      REQUIRE(::setgroups(1, &groupId) == 0);
+
+      int fd = -1;
+      Error error = openFileForAppendAsUser(dir.completeChildPath("file"), user, fd);
+
+      CHECK(::setgroups(static_cast<size_t>(oldGroupCount), oldGroups.data()) == 0);
+
+      CHECK(error);
+      CHECK(fd == -1);
+      CHECK_FALSE(dir.completeChildPath("file").exists());
+      CHECK_FALSE(dir.removeIfExists());
+   }
 }
 
 
@@ -0,0 +1,77 @@
+/*
+ * UserTests.cpp
+ *
+ * Copyright (C) 2020 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <TestMain.hpp>
+
+#include <Error.hpp>
+#include <system/DateTime.hpp>
+#include <system/FilePath.hpp>
+#include <system/User.hpp>
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace system {
+
+TEST_CASE("Cached user lookups")
+{
+   User::clearCache();
+
+   SECTION("Lookups by name and ID find the same user")
+   {
+      User byName, byId, byNameAgain;
+      REQUIRE_FALSE(User::getUserFromIdentifier("root", byName));
+      REQUIRE_FALSE(User::getUserFromIdentifier(0, byId));
+      REQUIRE_FALSE(User::getUserFromIdentifier("root", byNameAgain));
+
+      CHECK(byName == byId);
+      CHECK(byNameAgain == byName);
+      CHECK(byNameAgain.getUsername() == "root");
+      CHECK(byNameAgain.getHomePath() == byName.getHomePath());
+   }
+
+   SECTION("Missing users are reported every time")
+   {
+      User user(true);
+      Error error = User::getUserFromIdentifier("rlps-no-such-user", user);
+      CHECK(isNotFoundError(error));
+
+      Error cachedError = User::getUserFromIdentifier("rlps-no-such-user", user);
+      CHECK(isNotFoundError(cachedError));
+      CHECK(user.isEmpty());
+   }
+
+   SECTION("Lookups work with the cache disabled")
+   {
+      User::setCacheTimeToLive(TimeDuration());
+
+      User user;
+      REQUIRE_FALSE(User::getUserFromIdentifier("root", user));
+      CHECK(user.getUserId() == 0);
+
+      User::setCacheTimeToLive(TimeDuration::Seconds(60));
+   }
+}
+
+} // namespace system
+} // namespace launcher_plugins
+} // namespace rstudio
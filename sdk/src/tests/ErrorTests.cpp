@@ -0,0 +1,96 @@
+/*
+ * ErrorTests.cpp
+ *
+ * Copyright (C) 2020 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "TestMain.hpp"
+
+#include <Error.hpp>
+
+namespace rstudio {
+namespace launcher_plugins {
+
+TEST_CASE("Success is not an error")
+{
+   Error success = Success();
+
+   CHECK(!success);
+   CHECK(success.getCode() == 0);
+   CHECK(success.getName().empty());
+   CHECK(success.getMessage().empty());
+   CHECK(success.getProperties().empty());
+   CHECK(!success.hasCause());
+   CHECK(!success.isExpected());
+   CHECK(!success.getLocation().hasLocation());
+   CHECK(success == Success());
+}
+
+TEST_CASE("Setting a property on a success does not change its copies")
+{
+   Error success = Success();
+   Error copy = success;
+
+   success.addProperty("name", "value");
+   success.setExpected();
+
+   REQUIRE(success.getProperties().size() == 1);
+   CHECK(success.getProperties()[0].second == "value");
+   CHECK(success.isExpected());
+   CHECK(copy.getProperties().empty());
+   CHECK(!copy.isExpected());
+   CHECK(!success);
+}
+
+TEST_CASE("Error copies and moves")
+{
+   Error error("TestError", 5, "Test message", ERROR_LOCATION);
+   Error copy = error;
+   Error moved = std::move(copy);
+
+   CHECK(moved);
+   CHECK(moved == error);
+   CHECK(moved.getMessage() == "Test message");
+
+   moved.addProperty("name", "value");
+   CHECK(error.getProperties().empty());
+
+   Error assigned;
+   assigned = error;
+   CHECK(assigned == error);
+}
+
+TEST_CASE("Error location")
+{
+   ErrorLocation location("function", "file.cpp", 12);
+   ErrorLocation copy = location;
+
+   CHECK(location.hasLocation());
+   CHECK(location.getFunction() == "function");
+   CHECK(location.getFile() == "file.cpp");
+   CHECK(location.getLine() == 12);
+   CHECK(copy == location);
+   CHECK(!(ErrorLocation() == location));
+   CHECK(!ErrorLocation().hasLocation());
+   CHECK(ErrorLocation(nullptr, nullptr, 0).getFile().empty());
+}
+
+} // namespace launcher_plugins
+} // namespace rstudio
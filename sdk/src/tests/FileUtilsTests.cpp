@@ -0,0 +1,125 @@
+/*
+ * FileUtilsTests.cpp
+ *
+ * Copyright (C) 2020 by RStudio, PBC
+ *
+ * Unless you have received this program directly from RStudio pursuant to the terms of a commercial license agreement
+ * with RStudio, then this program is licensed to you under the following terms:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "TestMain.hpp"
+
+#include <Error.hpp>
+#include <system/FilePath.hpp>
+#include <utils/FileUtils.hpp>
+
+namespace rstudio {
+namespace launcher_plugins {
+namespace utils {
+
+TEST_CASE("Write string to file")
+{
+   system::FilePath file;
+   REQUIRE_FALSE(system::FilePath::tempFilePath(file));
+
+   SECTION("Overwrite")
+   {
+      REQUIRE_FALSE(writeStringToFile("first line\n", file));
+      REQUIRE_FALSE(writeStringToFile("second line\n", file));
+
+      std::string contents;
+      REQUIRE_FALSE(readFileIntoString(file, contents));
+      CHECK(contents == "second line\n");
+   }
+
+   SECTION("Append")
+   {
+      REQUIRE_FALSE(writeStringToFile("first line\n", file));
+      REQUIRE_FALSE(writeStringToFile("second line\n", file, false));
+
+      std::string contents;
+      REQUIRE_FALSE(readFileIntoString(file, contents));
+      CHECK(contents == "first line\nsecond line\n");
+   }
+
+   SECTION("Line endings are normalized")
+   {
+      REQUIRE_FALSE(writeStringToFile("one\r\ntwo\rthree\xE2\x80\xA8" "four\n", file));
+
+      std::string contents;
+      REQUIRE_FALSE(readFileIntoString(file, contents));
+      CHECK(contents == "one\ntwo\nthree\nfour\n");
+   }
+
+   REQUIRE_FALSE(file.removeIfExists());
+}
+
+TEST_CASE("Write string to file atomically")
+{
+   system::FilePath file;
+   REQUIRE_FALSE(system::FilePath::tempFilePath(file));
+
+   SECTION("New file")
+   {
+      REQUIRE_FALSE(writeStringToFileAtomically("some data\n", file));
+
+      std::string contents;
+      REQUIRE_FALSE(readFileIntoString(file, contents));
+      CHECK(contents == "some data\n");
+   }
+
+   SECTION("Replace file, no sync")
+   {
+      REQUIRE_FALSE(writeStringToFileAtomically("some data\n", file, FileSyncMode::NONE));
+      REQUIRE_FALSE(writeStringToFileAtomically("other data", file, FileSyncMode::FILE));
+
+      std::string contents;
+      REQUIRE_FALSE(readFileIntoString(file, contents));
+      CHECK(contents == "other data");
+   }
+
+   SECTION("Line endings are preserved")
+   {
+      REQUIRE_FALSE(writeStringToFileAtomically("one\r\ntwo\r", file));
+
+      std::string contents;
+      REQUIRE_FALSE(readFileIntoString(file, contents));
+      CHECK(contents == "one\r\ntwo\r");
+   }
+
+   SECTION("No temporary files are left behind")
+   {
+      REQUIRE_FALSE(writeStringToFileAtomically("some data\n", file));
+
+      std::vector<system::FilePath> children;
+      REQUIRE_FALSE(file.getParent().getChildren(children));
+      for (const system::FilePath& child: children)
+         CHECK(child.getFilename().find(file.getFilename() + ".tmp.") == std::string::npos);
+   }
+
+   SECTION("Missing directory")
+   {
+      system::FilePath missingFile = file.completeChildPath("missing");
+      CHECK(writeStringToFileAtomically("some data\n", missingFile));
+   }
+
+   REQUIRE_FALSE(file.removeIfExists());
+}
+
+} // namespace utils
+} // namespace launcher_plugins
+} // namespace rstudio
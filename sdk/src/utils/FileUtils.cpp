@@ -24,11 +24,14 @@
 
 #include <utils/FileUtils.hpp>
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
 #include <iostream>
-#include <sstream>
 
 #include <boost/regex.hpp>
-#include <boost/iostreams/copy.hpp>
 
 #include <Error.hpp>
 #include <system/FilePath.hpp>
@@ -41,29 +44,86 @@ namespace utils {
 
 Error readFileIntoString(const system::FilePath& in_file, std::string& out_fileContents)
 {
-   std::shared_ptr<std::istream> inputStream;
-   Error error = in_file.openForRead(inputStream);
-   if (error)
+   int fd = ::open(in_file.getAbsolutePath().c_str(), O_RDONLY | O_CLOEXEC);
+   if (fd < 0)
+   {
+      Error error = systemError(errno, ERROR_LOCATION);
+      error.addProperty("path", in_file.getAbsolutePath());
       return error;
+   }
 
-   // Read the whole file into a string stream.
-   std::ostringstream oStrStream;
-   try
+   // Size the buffer from the file so that most files are read with a single read. Some files, such as those in /proc,
+   // report a size of 0, so keep reading until the end of the file regardless.
+   struct stat st;
+   size_t capacity = 4096;
+   if ((::fstat(fd, &st) == 0) && (st.st_size > 0))
+      capacity = static_cast<size_t>(st.st_size) + 1;
+
+   std::string contents(capacity, '\0');
+   size_t length = 0;
+   Error error;
+   while (true)
    {
-      // Ensure an exception will be thrown if the failbit or badbit is set.
-      inputStream->exceptions(std::istream::failbit | std::istream::badbit);
+      if (length == contents.size())
+         contents.resize(contents.size() * 2);
 
-      boost::iostreams::copy(*inputStream, oStrStream);
+      ssize_t result = ::read(fd, &contents[length], contents.size() - length);
+      if (result < 0)
+      {
+         if (errno == EINTR)
+            continue;
+
+         error = systemError(errno, ERROR_LOCATION);
+         error.addProperty("path", in_file.getAbsolutePath());
+         break;
+      }
+
+      if (result == 0)
+         break;
+
+      length += static_cast<size_t>(result);
    }
-   catch (std::exception& e)
-   {
-      // TODO: good error code for this?
-      error = systemError(1, "Failed to read file: " + std::string(e.what()), ERROR_LOCATION);
-      error.addProperty("file", in_file.getAbsolutePath());
+
+   ::close(fd);
+   if (error)
       return error;
-   }
 
-   out_fileContents = oStrStream.str();
+   contents.resize(length);
+   out_fileContents = std::move(contents);
+
+   return Success();
+}
+
+Error syncDirectory(const system::FilePath& in_directory)
+{
+   int fd = ::open(in_directory.getAbsolutePath().c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+   if (fd < 0)
+      return systemError(errno, ERROR_LOCATION);
+
+   Error error;
+   if (::fsync(fd) != 0)
+      error = systemError(errno, ERROR_LOCATION);
+
+   ::close(fd);
+   return error;
+}
+
+Error writeAll(int in_fd, const std::string& in_contents)
+{
+   size_t written = 0;
+   while (written < in_contents.size())
+   {
+      ssize_t result = ::write(in_fd, in_contents.data() + written, in_contents.size() - written);
+      if (result < 0)
+      {
+         if (errno == EINTR)
+            continue;
+
+         return systemError(errno, ERROR_LOCATION);
+      }
+
+      written += static_cast<size_t>(result);
+   }
 
    return Success();
 }
@@ -79,13 +139,20 @@ Error writeStringToFile(const std::string& in_contents, const system::FilePath&
    {
       ofs->exceptions(std::ostream::failbit | std::ostream::badbit);
 
-      // Normalize the line endings to posix line endings, just in case.
-      std::string normalizedContents = in_contents;
-      boost::regex_replace(normalizedContents, boost::regex("\\r?\\n|\\r|\\xE2\\x80[\\xA8\\xA9]"), "\n");
-
-      // Then write the normalized data to the file.
-      std::istringstream ss(normalizedContents);
-      boost::iostreams::copy(ss, *ofs);
+      // Normalize the line endings to posix line endings, just in case. Most content is already normalized, so only
+      // pay for the regex if there's a character that could start a non-posix line ending.
+      if (in_contents.find_first_of("\r\xE2") == std::string::npos)
+         ofs->write(in_contents.data(), static_cast<std::streamsize>(in_contents.size()));
+      else
+      {
+         const std::string normalizedContents = boost::regex_replace(
+            in_contents,
+            boost::regex("\\r?\\n|\\r|\\xE2\\x80[\\xA8\\xA9]"),
+            "\n");
+         ofs->write(normalizedContents.data(), static_cast<std::streamsize>(normalizedContents.size()));
+      }
+
+      ofs->flush();
    }
    catch (const std::exception& e)
    {
@@ -98,6 +165,51 @@ Error writeStringToFile(const std::string& in_contents, const system::FilePath&
    return Success();
 }
 
+Error writeStringToFileAtomically(
+   const std::string& in_contents,
+   const system::FilePath& in_file,
+   FileSyncMode in_syncMode)
+{
+   // The temporary file must be in the same directory as the target for the rename to be atomic. Make the name unique
+   // so concurrent writers of the same file can't interleave their data.
+   static std::atomic_uint_fast64_t tempFileCounter(0);
+   const std::string tempPath = in_file.getAbsolutePath() +
+      ".tmp." +
+      std::to_string(::getpid()) +
+      "." +
+      std::to_string(tempFileCounter++);
+
+   int fd = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+   if (fd < 0)
+   {
+      Error error = systemError(errno, ERROR_LOCATION);
+      error.addProperty("path", tempPath);
+      return error;
+   }
+
+   Error error = writeAll(fd, in_contents);
+   if (!error && (in_syncMode != FileSyncMode::NONE) && (::fsync(fd) != 0))
+      error = systemError(errno, ERROR_LOCATION);
+
+   if ((::close(fd) != 0) && !error)
+      error = systemError(errno, ERROR_LOCATION);
+
+   if (!error && (::rename(tempPath.c_str(), in_file.getAbsolutePath().c_str()) != 0))
+      error = systemError(errno, ERROR_LOCATION);
+
+   if (error)
+   {
+      ::unlink(tempPath.c_str());
+      error.addProperty("path", in_file.getAbsolutePath());
+      return error;
+   }
+
+   if (in_syncMode == FileSyncMode::FILE_AND_DIRECTORY)
+      return syncDirectory(in_file.getParent());
+
+   return Success();
+}
+
 } // namespace utils
 } // namespace launcher_plugins
 } // namespace rstudio